@@ -0,0 +1,394 @@
+/**
+ * 文件名: battle_engine.h
+ * 描述: 对战引擎 - 把一局 9 回合比赛的全部规则从 MainWindow 中剥离出来。
+ * 注意: 与 game_data.h 一样是纯逻辑头文件，不依赖 Qt，界面、模拟器都基于它运行。
+ */
+#ifndef BATTLE_ENGINE_H
+#define BATTLE_ENGINE_H
+
+#include "game_data.h"
+#include "hero_state.h"
+#include "game_solver.h"
+#include "hero_stats.h"
+#include "move_model.h"
+#include "rng.h"
+
+// 单回合的结算结果，界面用它来写战斗日志
+struct RoundResult {
+    int round;          // 第几回合 (1-9)；0 表示出招无效，本回合没有结算
+    int myHero;         // 我方出战英雄在英雄总表中的索引
+    int cpuHero;        // 电脑出战英雄在英雄总表中的索引
+    MoveType myMove;
+    MoveType cpuMove;
+    int outcome;        // 结算结果 (rules.h 的 OUTCOME_WIN / OUTCOME_LOSS / OUTCOME_DRAW，我方视角)
+    int thinkMs = 0;        // 玩家思考用时 (毫秒，由界面填写)
+    bool timedOut = false;  // 是否超时由系统代为出招 (由界面填写)
+};
+
+// ==========================================
+// 类: BattleEngine (对战引擎)
+// 描述: 保存一局比赛的运行时状态，并负责电脑出招与回合结算
+// ==========================================
+class BattleEngine {
+public:
+    vector<Hero>& heroes;       // 英雄总表 (回合统计数据回写到这里，用于排行榜)
+    vector<int> myHeroIndices;  // 我方 3 个英雄在总表中的索引
+    vector<int> cpuHeroIndices; // 电脑 3 个英雄在总表中的索引
+    // 双方英雄的运行时库存，每个英雄打包成 2 字节 (双方选了同一英雄时库存互不影响)
+    // 与名字、统计数据分开存放，回合循环只读写这几个字节
+    PackedMoves myMoves[TEAM_SIZE];
+    PackedMoves cpuMoves[TEAM_SIZE];
+
+    int currentRound = 1;          // 当前回合数 (1-9)
+    int myScore = 0, cpuScore = 0; // 双方得分
+    int currentCpuHeroIndex = -1;  // 电脑当前派出的是第几个英雄 (0-2)
+    MoveType cpuNextMove = NONE;   // 电脑本回合预先决定出的招 (先算好，后展示)
+    vector<RoundResult> rounds;    // 本局已结算的回合 (用于写对战记录)
+
+    // 每个引擎独占一个随机数引擎，多个引擎可以放心地并行运行
+    // 一局中的所有随机性 (电脑选人、电脑出招、超时代出招) 都只来自它，
+    // 每局开始时用本局种子重新播种，所以“种子 + 玩家输入”就能完整重现一局。
+    // 用 16 字节状态的 GameRng (rng.h)，引擎本身很小，线程里开多少个都不占地方
+    GameRng rng;
+    uint32_t matchSeed = 0; // 本局种子
+
+    // 电脑的出招策略：为空时按原来的加权随机出招；
+    // 设置后按博弈求解器算出的均衡混合策略出招 (求解器可以被多局复用，但不能跨线程共享)
+    GameSolver* solver = nullptr;
+
+    // 英雄胜率榜：设置后每回合结算时同步更新出场的两个英雄
+    HeroLeaderboard* heroBoard = nullptr;
+
+    // 回合统计分片：设置后回合统计写到这里，不再累加到 heroes 上，
+    // 这样多个线程的引擎可以共用同一份英雄表 (每个线程一个分片，见 hero_stats.h)
+    HeroStats::Shard* stats = nullptr;
+
+    // 玩家出招模型：设置后电脑预测玩家下一招并针对性出招 (模型由调用方更新，引擎只读)。
+    // 这样的对局取决于玩家以往的全部对局，种子重现不了，所以电脑出招另用 cpuRng，
+    // 回放时照录下的电脑出招 (cpuScript) 执行；引擎的 rng 仍只用于电脑选人和超时代出，回放与实战一致
+    const MoveModel* model = nullptr;
+    const uint8_t* cpuScript = nullptr; // 回放用：每回合电脑的 (英雄位置 << 2 | 招)
+    GameRng cpuRng;
+
+    // 本回合电脑按模型出招时 (prepareAdaptiveMove)，adaptiveRound 为 true，adaptiveMix 是这一招的抽取分布；
+    // 否则电脑按均衡策略或加权随机出招。出招胜率 (win_odds.h) 经 revealedCpuMix 用它代替本回合的均衡策略
+    bool adaptiveRound = false;
+    double adaptiveMix[3] = {};
+
+    // 模型记录的回合数不到这个数时，电脑还按原来的策略出招
+    static const int MODEL_MIN_OBSERVED = MAX_ROUNDS;
+    // 按期望得分加权抽招的强度：越大越贪心 (期望得分在 -1 到 1 之间)
+    static constexpr double MODEL_GREED = 8.0;
+
+    // 一局内的两条随机数流：同一个本局种子，不同的流编号
+    static const uint64_t STREAM_MATCH = 0;
+    static const uint64_t STREAM_CPU = 1;
+
+    // seed / stream 决定引擎自己抽取各局种子的那条流：多个线程的引擎用同一个主种子、不同的流编号，
+    // 互不相关又都能重现；不指定种子时每个引擎取一个新种子。
+    // 引擎 stream 的两条流编号是 stream * 2 + STREAM_MATCH / STREAM_CPU，不同引擎的流永远不会重合
+    // (用 stream ^ STREAM_CPU 的话，1 号引擎的 rng 就是 0 号引擎的 cpuRng)
+    BattleEngine(vector<Hero>& h, uint64_t seed = GameRng::freshSeed(), uint64_t stream = 0)
+        : heroes(h), rng(seed, stream * 2 + STREAM_MATCH), cpuRng(seed, stream * 2 + STREAM_CPU) {}
+
+    // 开始新的一局：我方阵容由玩家指定，电脑随机选 3 个不同的英雄 (本局种子从引擎的随机数流中抽取)
+    void startNewGame(const vector<int>& mine) {
+        startNewGame(mine, (uint32_t)rng());
+    }
+
+    // 开始新的一局：用指定种子重新播种，再由种子决定电脑阵容 (回放时用记录的种子)
+    void startNewGame(const vector<int>& mine, uint32_t seed) {
+        rng.seed(seed, STREAM_MATCH);
+        cpuRng.seed(seed, STREAM_CPU);
+        int n = heroes.size();
+        vector<int> pool(n);
+        for(int i=0; i<n; ++i) pool[i] = i;
+        // 手写洗牌而不用 std::shuffle：标准库的分布算法各家实现不同，回放文件要能跨平台重现
+        // 只洗出前 3 个位置就够了，名单有上千个英雄时也只取 3 次随机数
+        for(int i=0; i<TEAM_SIZE; ++i) swap(pool[i], pool[i + rng.below(n - i)]);
+        startNewGame(mine, vector<int>(pool.begin(), pool.begin() + TEAM_SIZE));
+        matchSeed = seed;
+    }
+
+    // 开始新的一局：双方阵容都已确定
+    void startNewGame(const vector<int>& mine, const vector<int>& cpu) {
+        myHeroIndices = mine;
+        cpuHeroIndices = cpu;
+        for(int i=0; i<TEAM_SIZE; ++i) {
+            myMoves[i] = packMoves(heroes[mine[i]]);
+            cpuMoves[i] = packMoves(heroes[cpu[i]]);
+        }
+        currentRound = 1;
+        myScore = 0; cpuScore = 0;
+        currentCpuHeroIndex = -1;
+        cpuNextMove = NONE;
+        adaptiveRound = false;
+        rounds.clear();
+    }
+
+    // 9 回合是否已经打完
+    bool isOver() const { return currentRound > MAX_ROUNDS; }
+
+    // 回合开始：电脑选人并预先出招。返回 false 表示电脑无牌可出
+    bool prepareRound() {
+        adaptiveRound = false;
+        if(cpuScript) return prepareScriptedMove();
+        if(model && prepareAdaptiveMove()) return true;
+        GameRng& g = model ? cpuRng : rng;
+        currentCpuHeroIndex = pickRandomHero(cpuMoves, g);
+        if(currentCpuHeroIndex < 0) return false;
+        if(solver && prepareOptimalMove(g)) return true;
+        cpuNextMove = drawMove(cpuMoves[currentCpuHeroIndex], g);
+        return true;
+    }
+
+    // 当前局面 (供博弈求解器使用)
+    MatchState matchState() const {
+        MatchState s = {};
+        for(int i=0; i<TEAM_SIZE; ++i) {
+            for(int m=SCISSORS; m<=PAPER; ++m) {
+                s.my[m] += movesCount(myMoves[i], (MoveType)m);
+                s.cpu[m] += movesCount(cpuMoves[i], (MoveType)m);
+            }
+        }
+        s.round = currentRound;
+        s.scoreDiff = myScore - cpuScore;
+        return s;
+    }
+
+    // 玩家眼中的局面：电脑本回合预先出的招还没亮出来，算回它的库存里 (用于出招胜率)
+    MatchState publicState() const {
+        MatchState s = matchState();
+        if(cpuNextMove != NONE) s.cpu[cpuNextMove]++;
+        return s;
+    }
+
+    // 玩家看到电脑派出的英雄 (currentCpuHeroIndex) 之后，电脑本回合各招的概率。
+    // 按模型或均衡策略出招时电脑先按分布 mix 抽招，再在有这一招的英雄中均匀选人，所以出战的英雄也透露了招：
+    //   P(c | 英雄 h) ∝ mix[c] × [h 有 c] / 有 c 的英雄数
+    // 加权随机时先选人再按这个英雄的库存抽招，就是 h 库存的比例。库存按抽招之前算 (本回合的招已扣掉时加回)；
+    // 服务器对局的镜像里库存本来就没扣，cpuNextMove 为 NONE，同样适用。还没派出英雄或已打完时返回 false
+    bool revealedCpuMix(double out[3]) const {
+        int h = currentCpuHeroIndex;
+        if(h < 0 || h >= TEAM_SIZE || isOver()) return false;
+        int count[TEAM_SIZE][3], holders[3] = {};
+        for(int i=0; i<TEAM_SIZE; ++i) {
+            for(int c=SCISSORS; c<=PAPER; ++c) {
+                count[i][c] = movesCount(cpuMoves[i], (MoveType)c) + (i == h && c == cpuNextMove);
+                holders[c] += count[i][c] > 0;
+            }
+        }
+        double eq[3] = {};
+        if(!adaptiveRound && solver) {
+            SolveResult r = solver->solve(publicState());
+            for(int c=SCISSORS; c<=PAPER; ++c) eq[c] = r.cpuStrategy[c];
+        }
+        double sum = 0;
+        for(int c=SCISSORS; c<=PAPER; ++c) {
+            if(count[h][c] == 0) out[c] = 0;
+            else if(adaptiveRound) out[c] = adaptiveMix[c] / holders[c];
+            else if(solver) out[c] = eq[c] / holders[c];
+            else out[c] = count[h][c];
+            sum += out[c];
+        }
+        if(sum <= 0) return false; // 终局没有均衡策略 (电脑退回了加权随机)
+        for(int c=SCISSORS; c<=PAPER; ++c) out[c] /= sum;
+        return true;
+    }
+
+    // 我方 3 个英雄中是否有人还能出这一招 (用于 UI 按钮变灰逻辑)
+    bool canUse(MoveType m) const {
+        return findHeroWithMove(myMoves, m) >= 0;
+    }
+
+    // 我方是否还有任何招可出
+    bool hasMoves() const {
+        for(int i=0; i<TEAM_SIZE; ++i) if(movesTotal(myMoves[i]) > 0) return true;
+        return false;
+    }
+
+    // 超时时替玩家随机出一招：把每个英雄能用的招都收集起来再随机取一个
+    MoveType randomAvailableMove() {
+        return randomMoveOf(myMoves, rng);
+    }
+
+    // 在 team 的 (英雄, 招) 中均匀随机取一招 (不扣库存)，没有招可出返回 NONE
+    static MoveType randomMoveOf(const PackedMoves* team, GameRng& g) {
+        MoveType validMoves[TEAM_SIZE * 3];
+        int n = 0;
+        for(int i=0; i<TEAM_SIZE; ++i) {
+            for(int m=SCISSORS; m<=PAPER; ++m) {
+                if(movesCount(team[i], (MoveType)m) > 0) validMoves[n++] = (MoveType)m;
+            }
+        }
+        if(n == 0) return NONE;
+        return validMoves[g.below(n)];
+    }
+
+    // team 中第一个还能出 m 的英雄的位置，没有返回 -1
+    static int findHeroWithMove(const PackedMoves* team, MoveType m) {
+        for(int i=0; i<TEAM_SIZE; ++i) if(movesCount(team[i], m) > 0) return i;
+        return -1;
+    }
+
+    // 玩家出招：自动寻找我方第一个拥有该招数的英雄 (简化逻辑)
+    // 没有英雄还能出这一招时不结算，返回 round = 0 的结果 (调用前应先用 canUse 检查)
+    RoundResult playRound(MoveType myMove) {
+        return playRound(myMove < SCISSORS || myMove > PAPER ? -1 : findHeroWithMove(myMoves, myMove), myMove);
+    }
+
+    // 指定由我方第 slot 个英雄出 myMove，结算本回合并进入下一回合
+    // slot 越界、该英雄没有这一招、本局已打完或电脑本回合还没出招 (prepareRound) 时不结算，返回 round = 0 的结果
+    RoundResult playRound(int slot, MoveType myMove) {
+        if(isOver() || cpuNextMove == NONE || currentCpuHeroIndex < 0
+           || slot < 0 || slot >= TEAM_SIZE || myMove < SCISSORS || myMove > PAPER || movesCount(myMoves[slot], myMove) == 0) {
+            return { 0, -1, -1, myMove, NONE, OUTCOME_DRAW };
+        }
+        int myId = myHeroIndices[slot];
+        int cpuId = cpuHeroIndices[currentCpuHeroIndex];
+        myMoves[slot] = removeMove(myMoves[slot], myMove); // 扣除库存
+
+        // 胜负判定：查编译期生成的胜负表 (rules.h)，与原来的 (myMove - cpuNextMove + 3) % 3 逐项相同
+        int res = ClassicRules::outcome(myMove, cpuNextMove);
+        if(res == OUTCOME_WIN) myScore++;
+        else if(res == OUTCOME_LOSS) cpuScore++;
+
+        // 更新全局榜单数据
+        if(stats) {
+            stats->recordRound(myId, cpuId, myMove, cpuNextMove, res);
+        } else {
+            Hero& myHero = heroes[myId];
+            Hero& cpuHero = heroes[cpuId];
+            myHero.totalMatches++;
+            cpuHero.totalMatches++;
+            if(res == OUTCOME_WIN) myHero.winMatches++;
+            else if(res == OUTCOME_LOSS) cpuHero.winMatches++;
+            if(heroBoard) {
+                heroBoard->update(myId, myHero.getWinRate());
+                heroBoard->update(cpuId, cpuHero.getWinRate());
+            }
+        }
+
+        RoundResult r = { currentRound, myId, cpuId, myMove, cpuNextMove, res };
+        rounds.push_back(r);
+        currentRound++;
+        cpuNextMove = NONE; // 电脑这一招已经用掉，下一回合要先 prepareRound
+        return r;
+    }
+
+    // 电脑对电脑打完一整局 (双方都用电脑的出招策略)
+    // 返回值：1 = 我方(阵容 mine)胜, -1 = 电脑(阵容 cpu)胜, 0 = 平
+    int playAutoGame(const vector<int>& mine, const vector<int>& cpu) {
+        startNewGame(mine, cpu);
+        while(!isOver()) {
+            if(!prepareRound()) break; // 电脑无牌可出，提前认输
+            int slot = pickRandomHero(myMoves, rng);
+            if(slot < 0) break;
+            playRound(slot, sampleMove(myMoves[slot], (uint32_t)rng())); // 只抽招，库存由 playRound 扣除
+        }
+        return (myScore > cpuScore) - (myScore < cpuScore);
+    }
+
+private:
+    // 按模型预测的玩家出招，给电脑每种还能出的招算期望得分 (赢 +1，输 -1)，
+    // 再按 exp(MODEL_GREED * 得分) 加权抽一招：明显占优的招几乎必出，但不会每次都一样，免得被玩家反过来利用。
+    // 玩家没有库存的招不会出现；超时时系统在玩家能出的 (英雄, 招) 中均匀代出，超时概率按这个规则分摊。
+    // 模型样本太少时返回 false，退回原来的策略
+    bool prepareAdaptiveMove() {
+        if(model->observed() < MODEL_MIN_OBSERVED) return false;
+        double p[MoveModel::OUTCOMES];
+        model->predict(p);
+
+        int holders[3] = {}, slots = 0; // 我方有这一招的英雄数
+        for(int i=0; i<TEAM_SIZE; ++i) {
+            for(int m=SCISSORS; m<=PAPER; ++m) if(movesCount(myMoves[i], (MoveType)m) > 0) { holders[m]++; slots++; }
+        }
+        if(slots == 0) return false;
+        double q[3], chosen = 0;
+        for(int m=SCISSORS; m<=PAPER; ++m) chosen += holders[m] ? p[m] : 0;
+        for(int m=SCISSORS; m<=PAPER; ++m) {
+            double own = holders[m] && chosen > 0 ? p[m] / chosen : (double)holders[m] / slots;
+            q[m] = (1 - p[MoveModel::TIMEOUT]) * own + p[MoveModel::TIMEOUT] * holders[m] / slots;
+        }
+
+        double w[3], sum = 0;
+        for(int c=SCISSORS; c<=PAPER; ++c) {
+            bool has = findHeroWithMove(cpuMoves, (MoveType)c) >= 0;
+            double score = 0;
+            for(int m=SCISSORS; m<=PAPER; ++m) { // 结算结果是玩家视角：玩家负 = 电脑胜
+                int r = ClassicRules::outcome(m, c);
+                score += q[m] * ((r == OUTCOME_LOSS) - (r == OUTCOME_WIN));
+            }
+            w[c] = has ? exp(MODEL_GREED * score) : 0;
+            sum += w[c];
+        }
+        if(sum <= 0) return false;
+        for(int c=SCISSORS; c<=PAPER; ++c) adaptiveMix[c] = w[c] / sum;
+        adaptiveRound = true;
+        double u = cpuRng() * (1.0 / 4294967296.0) * sum;
+        int m = PAPER;
+        for(int c=SCISSORS; c<=PAPER; ++c) {
+            if(w[c] <= 0) continue;
+            m = c;
+            u -= w[c];
+            if(u < 0) break;
+        }
+        pickHeroFor((MoveType)m, cpuRng);
+        return true;
+    }
+
+    // 回放：按记录执行本回合电脑的出招，记录与库存不符时返回 false
+    bool prepareScriptedMove() {
+        uint8_t code = cpuScript[currentRound - 1];
+        int slot = code >> 2;
+        MoveType m = (MoveType)(code & 3);
+        if(slot >= TEAM_SIZE || m > PAPER || movesCount(cpuMoves[slot], m) == 0) return false;
+        currentCpuHeroIndex = slot;
+        cpuNextMove = m;
+        cpuMoves[slot] = removeMove(cpuMoves[slot], m);
+        return true;
+    }
+
+    // 从电脑有 m 这一招的英雄中随机选一个出战并扣除库存 (调用方保证有)
+    void pickHeroFor(MoveType m, GameRng& g) {
+        int valid[TEAM_SIZE], n = 0;
+        for(int i=0; i<TEAM_SIZE; ++i) if(movesCount(cpuMoves[i], m) > 0) valid[n++] = i;
+        currentCpuHeroIndex = valid[g.below(n)];
+        cpuNextMove = m;
+        cpuMoves[currentCpuHeroIndex] = removeMove(cpuMoves[currentCpuHeroIndex], m);
+    }
+
+    // 按均衡混合策略抽一招，再从有这一招的英雄中随机选一个出战
+    bool prepareOptimalMove(GameRng& g) {
+        SolveResult r = solver->solve(matchState());
+        double u = g() * (1.0 / 4294967296.0); // [0, 1)，不用 uniform_real_distribution，理由同上
+        int m = -1;
+        for(int i=SCISSORS; i<=PAPER; ++i) {
+            if(r.cpuStrategy[i] <= 0) continue;
+            m = i;
+            u -= r.cpuStrategy[i];
+            if(u < 0) break;
+        }
+        if(m < 0) return false; // 终局没有策略，退回加权随机
+
+        pickHeroFor((MoveType)m, g);
+        return true;
+    }
+
+    // 随机选一个还有招可用的英雄，返回其在队伍中的位置，没有则返回 -1
+    static int pickRandomHero(const PackedMoves* team, GameRng& g) {
+        int valid[TEAM_SIZE], n = 0;
+        for(int i=0; i<TEAM_SIZE; ++i) if(movesTotal(team[i]) > 0) valid[n++] = i;
+        if(n == 0) return -1;
+        return valid[g.below(n)];
+    }
+
+    // 加权随机出一招并扣除库存
+    static MoveType drawMove(PackedMoves& inv, GameRng& g) {
+        MoveType m = sampleMove(inv, (uint32_t)g());
+        if(m != NONE) inv = removeMove(inv, m);
+        return m;
+    }
+};
+
+#endif
@@ -0,0 +1,638 @@
+/**
+ * 文件名: bench_suite.cpp
+ * 描述: 游戏核心基准套件 - 无界面地测量出招 (含旧的 vector 池实现作对照)、回合结算、出招时限 (10 万局)、
+ *       多线程回合统计 (分片 vs 共用原子计数器)、出招模型的更新与决策、玩家注册/登录 (10^3 到 10^6 人)、
+ *       玩家数据的载入/保存与文件大小、排行榜建立与排序，用于发版前发现性能退化。
+ *       每项重复若干遍取中位数；所有指标都是越小越好。
+ * 用法: bench_suite [--filter 子串] [--reps 遍数=5] [--max-users 人数=1000000] [--json]
+ *                   [--save-baseline 文件] [--baseline 文件] [--tolerance 比例=0.10]
+ *       --json            输出 JSON (每项一行)，可以直接存成基准线
+ *       --save-baseline   把本次结果存为基准线文件 (格式与 --json 相同，记录运行的机器)
+ *       --baseline        与基准线比较：有指标比基准线差超过 tolerance 时返回 1；
+ *                         基准线不是在本机记录的时候会提示，仓库里的 bench_baseline.json 见文件里的 machine
+ * 注意: 玩家数据的测试在系统临时目录下的独立目录中进行，结束后删除，不会碰到当前目录的存档。
+ */
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <functional>
+#include <filesystem>
+#include <map>
+#include <thread>
+#include "battle_engine.h"
+#include "timer_wheel.h"
+
+namespace fs = std::filesystem;
+
+struct BenchResult {
+    string name;
+    double value;
+    string unit;
+};
+
+// 一项基准：run 执行一遍并返回一个或多个指标 (同一遍里顺带测出的指标一起返回，例如注册后紧接着测登录)
+struct Bench {
+    string name;
+    function<vector<BenchResult>()> run;
+};
+
+static double nsSince(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count();
+}
+
+static volatile long long sink; // 防止编译器把被测循环优化掉
+
+// ---------- 出招与回合结算 ----------
+
+// 旧实现：每次调用都构造一个 vector 池 (保留在这里作为对照)
+static MoveType legacyMakeRandomMove(Hero& h, mt19937& rng) {
+    vector<MoveType> pool;
+    for(int i=0; i<h.currentS; ++i) pool.push_back(SCISSORS);
+    for(int i=0; i<h.currentR; ++i) pool.push_back(ROCK);
+    for(int i=0; i<h.currentP; ++i) pool.push_back(PAPER);
+    if(pool.empty()) return NONE;
+    uniform_int_distribution<int> dist(0, pool.size()-1);
+    MoveType m = pool[dist(rng)];
+    h.useMove(m);
+    return m;
+}
+
+static vector<BenchResult> benchLegacyMakeRandomMove() {
+    vector<Hero> heroes = DataManager::defaultHeroes();
+    // 正确性检查：同一种子下新旧实现必须给出完全相同的出招序列
+    mt19937 a(42), b(42);
+    vector<Hero> h1 = heroes, h2 = heroes;
+    for(int round=0; round<1000; ++round) {
+        for(size_t i=0; i<heroes.size(); ++i) {
+            h1[i].reset(); h2[i].reset();
+            while(h1[i].hasMoves()) {
+                if(legacyMakeRandomMove(h1[i], a) != h2[i].makeRandomMove(b)) {
+                    cerr << "错误: 新旧 makeRandomMove 出招序列不一致" << endl;
+                    exit(1);
+                }
+            }
+        }
+    }
+
+    mt19937 rng(1);
+    long long draws = 0, sum = 0;
+    auto t0 = chrono::steady_clock::now();
+    for(int it=0; it<200000; ++it) {
+        for(Hero& h : heroes) {
+            h.reset();
+            while(h.hasMoves()) { sum += legacyMakeRandomMove(h, rng); draws++; }
+        }
+    }
+    double ns = nsSince(t0) / draws;
+    sink = sum;
+    return { { "hero/legacyVectorPool", ns, "ns/op" } };
+}
+
+static vector<BenchResult> benchMakeRandomMove() {
+    vector<Hero> heroes = DataManager::defaultHeroes();
+    mt19937 rng(1);
+    long long draws = 0, sum = 0;
+    auto t0 = chrono::steady_clock::now();
+    for(int it=0; it<200000; ++it) {
+        for(Hero& h : heroes) {
+            h.reset();
+            while(h.hasMoves()) { sum += h.makeRandomMove(rng); draws++; }
+        }
+    }
+    double ns = nsSince(t0) / draws;
+    sink = sum;
+    return { { "hero/makeRandomMove", ns, "ns/op" } };
+}
+
+static vector<BenchResult> benchSampleMove() {
+    vector<Hero> heroes = DataManager::defaultHeroes();
+    mt19937 rng(1);
+    long long draws = 0, sum = 0;
+    auto t0 = chrono::steady_clock::now();
+    for(int it=0; it<200000; ++it) {
+        for(const Hero& h : heroes) {
+            PackedMoves inv = packMoves(h);
+            while(movesTotal(inv) > 0) {
+                MoveType m = sampleMove(inv, (uint32_t)rng());
+                inv = removeMove(inv, m);
+                sum += m;
+                draws++;
+            }
+        }
+    }
+    double ns = nsSince(t0) / draws;
+    sink = sum;
+    return { { "hero/sampleMove", ns, "ns/op" } };
+}
+
+// endRound 里原来的胜负判定公式与现在引擎用的编译期胜负表 (rules.h) 各测一遍，再测一整局电脑对电脑平均每回合的耗时
+static vector<BenchResult> benchRoundResolution() {
+    const int N = 1 << 16;
+    vector<uint8_t> a(N), b(N);
+    mt19937 rng(2);
+    for(int i=0; i<N; ++i) { a[i] = rng() % 3; b[i] = rng() % 3; }
+    long long wins[3] = {};
+    auto t0 = chrono::steady_clock::now();
+    for(int rep=0; rep<300; ++rep) {
+        for(int i=0; i<N; ++i) wins[(a[i] - b[i] + 3) % 3]++;
+    }
+    double formula = nsSince(t0) / (300.0 * N);
+    sink = wins[1];
+
+    t0 = chrono::steady_clock::now();
+    for(int rep=0; rep<300; ++rep) {
+        for(int i=0; i<N; ++i) wins[ClassicRules::outcome(a[i], b[i])]++;
+    }
+    double table = nsSince(t0) / (300.0 * N);
+    sink = wins[1];
+
+    vector<Hero> heroes = DataManager::defaultHeroes();
+    BattleEngine e(heroes, 3);
+    long long rounds = 0;
+    t0 = chrono::steady_clock::now();
+    for(int g=0; g<100000; ++g) {
+        e.playAutoGame({ 0, 1, 2 }, { 3, 4, 5 });
+        rounds += e.rounds.size();
+    }
+    double round = nsSince(t0) / rounds;
+    return { { "round/resolveFormula", formula, "ns/op" }, { "round/resolveTable", table, "ns/op" },
+             { "round/playRound", round, "ns/round" } };
+}
+
+// ---------- 回合统计 (分片统计 vs 共用原子计数器) ----------
+
+// 对照组：所有线程共用一组原子计数器，每次加一都是一条加锁的读改写指令，计数器所在的缓存行在各核之间来回搬运
+class AtomicHeroStats {
+public:
+    explicit AtomicHeroStats(int heroCount) : heroRounds(heroCount), heroWins(heroCount) {
+        for(int i=0; i<heroCount; ++i) { heroRounds[i] = 0; heroWins[i] = 0; }
+    }
+
+    void recordRound(int myHero, int cpuHero, MoveType myMove, MoveType cpuMove, int outcome) {
+        rounds.fetch_add(1, memory_order_relaxed);
+        moveUsed[myMove].fetch_add(1, memory_order_relaxed);
+        moveUsed[cpuMove].fetch_add(1, memory_order_relaxed);
+        heroRounds[myHero].fetch_add(1, memory_order_relaxed);
+        heroRounds[cpuHero].fetch_add(1, memory_order_relaxed);
+        if(outcome == OUTCOME_WIN) {
+            moveWon[myMove].fetch_add(1, memory_order_relaxed);
+            heroWins[myHero].fetch_add(1, memory_order_relaxed);
+        } else if(outcome == OUTCOME_LOSS) {
+            moveWon[cpuMove].fetch_add(1, memory_order_relaxed);
+            heroWins[cpuHero].fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    uint64_t totalRounds() const { return rounds.load(); }
+
+private:
+    atomic<uint64_t> rounds{0};
+    atomic<uint64_t> moveUsed[3] = {}, moveWon[3] = {};
+    vector<atomic<uint64_t>> heroRounds, heroWins;
+};
+
+struct RoundInput { int myHero, cpuHero; MoveType myMove, cpuMove; int outcome; };
+
+// threads 个线程各记录 perThread 个回合 (预先生成的随机回合循环使用，不让随机数的开销混进测量)，
+// 返回平均每回合的纳秒数 (墙钟时间 / 总回合数)；record(t, input) 由线程 t 调用
+template <class Record>
+static double recordRounds(int threads, long long perThread, int heroCount, Record record) {
+    vector<vector<RoundInput>> inputs(threads, vector<RoundInput>(4096));
+    for(int t=0; t<threads; ++t) {
+        mt19937 rng(12345 + t);
+        for(RoundInput& r : inputs[t]) {
+            r.myHero = rng() % heroCount;
+            r.cpuHero = rng() % heroCount;
+            r.myMove = (MoveType)(rng() % 3);
+            r.cpuMove = (MoveType)(rng() % 3);
+            r.outcome = ClassicRules::outcome(r.myMove, r.cpuMove);
+        }
+    }
+    atomic<int> ready{0};
+    atomic<bool> go{false};
+    vector<thread> ws;
+    for(int t=0; t<threads; ++t) {
+        ws.emplace_back([&, t] {
+            ready++;
+            while(!go) this_thread::yield();
+            const vector<RoundInput>& in = inputs[t];
+            for(long long i=0; i<perThread; ++i) record(t, in[i & 4095]);
+        });
+    }
+    while(ready < threads) this_thread::yield();
+    auto t0 = chrono::steady_clock::now();
+    go = true;
+    for(thread& w : ws) w.join();
+    return nsSince(t0) / (threads * perThread);
+}
+
+// 1 个线程和 CPU 核心数个线程各测一遍；写完后的快照必须恰好等于写入的回合数
+static vector<BenchResult> benchStats() {
+    const long long PER_THREAD = 2000000;
+    const int heroCount = DataManager::defaultHeroes().size();
+    vector<int> counts = { 1 };
+    int hw = (int)thread::hardware_concurrency();
+    if(hw > 1) counts.push_back(hw);
+
+    vector<BenchResult> out;
+    for(int threads : counts) {
+        string tag = "/" + to_string(threads) + "t";
+        AtomicHeroStats shared(heroCount);
+        double a = recordRounds(threads, PER_THREAD, heroCount,
+                                [&](int, const RoundInput& r) { shared.recordRound(r.myHero, r.cpuHero, r.myMove, r.cpuMove, r.outcome); });
+
+        HeroStats sharded(heroCount);
+        vector<HeroStats::Shard*> shards;
+        for(int t=0; t<threads; ++t) shards.push_back(sharded.addShard());
+        double s = recordRounds(threads, PER_THREAD, heroCount,
+                                [&](int t, const RoundInput& r) { shards[t]->recordRound(r.myHero, r.cpuHero, r.myMove, r.cpuMove, r.outcome); });
+
+        auto t0 = chrono::steady_clock::now();
+        StatsSnapshot snap;
+        for(int i=0; i<1000; ++i) snap = sharded.snapshot();
+        double snapUs = nsSince(t0) / 1000 / 1e3;
+
+        if(snap.rounds != (uint64_t)threads * PER_THREAD || shared.totalRounds() != (uint64_t)threads * PER_THREAD) {
+            cerr << "错误: 回合统计结果不正确" << endl;
+            exit(1);
+        }
+        out.push_back({ "stats/atomic" + tag, a, "ns/round" });
+        out.push_back({ "stats/sharded" + tag, s, "ns/round" });
+        out.push_back({ "stats/snapshot" + tag, snapUs, "us/op" });
+    }
+    return out;
+}
+
+// ---------- 出招模型 ----------
+
+// 模拟玩家：一半的回合重复上一招，其余随机，约一成回合超时
+struct HabitPlayer {
+    mt19937 rng;
+    MoveType last = NONE;
+    explicit HabitPlayer(unsigned seed) : rng(seed) {}
+
+    MoveType next(BattleEngine& e, bool& timedOut) {
+        timedOut = rng() % 10 == 0;
+        if(timedOut) return e.randomAvailableMove();
+        MoveType m = NONE;
+        if(last != NONE && e.canUse(last) && rng() % 2 == 0) m = last;
+        while(m == NONE || !e.canUse(m)) m = (MoveType)(rng() % 3);
+        return m;
+    }
+};
+
+// 用模拟玩家打 decisions 个回合，只给 prepareRound (电脑决策) 计时
+// 返回每次决策的平均微秒数；playerWinPct 为模拟玩家赢下的回合比例 (%)
+static double runHabitGames(vector<Hero>& heroes, MoveModel* model, long long decisions, double& playerWinPct) {
+    BattleEngine e(heroes, 2024);
+    e.model = model;
+    HabitPlayer player(7);
+    long long wins = 0, rounds = 0;
+    vector<int> pool(heroes.size());
+    for(size_t i=0; i<pool.size(); ++i) pool[i] = i;
+    chrono::steady_clock::duration spent{};
+    while(rounds < decisions) {
+        shuffle(pool.begin(), pool.end(), player.rng);
+        e.startNewGame(vector<int>(pool.begin(), pool.begin() + TEAM_SIZE));
+        if(model) model->startGame();
+        player.last = NONE;
+        while(!e.isOver()) {
+            auto t0 = chrono::steady_clock::now();
+            bool ready = e.prepareRound();
+            spent += chrono::steady_clock::now() - t0;
+            if(!ready) break;
+            bool timedOut;
+            MoveType m = player.next(e, timedOut);
+            RoundResult r = e.playRound(m);
+            if(model) model->record(m, timedOut);
+            player.last = m;
+            wins += r.outcome == OUTCOME_WIN;
+            rounds++;
+        }
+    }
+    playerWinPct = 100.0 * wins / rounds;
+    return chrono::duration<double, micro>(spent).count() / rounds;
+}
+
+// 先让模型学 10^3 和 10^6 回合的历史，再测电脑按模型做一次决策 (预测 + 选招 + 选人) 的耗时，
+// 决策时间应与历史长度无关；同时给出每回合更新模型的耗时，以及有固定习惯的模拟玩家面对
+// 按模型出招的电脑与加权随机出招的电脑时的回合胜率 (越低说明模型越能抓住习惯)
+static vector<BenchResult> benchModel() {
+    const long long DECISIONS = 200000;
+    vector<Hero> heroes = DataManager::defaultHeroes();
+    vector<BenchResult> out;
+    for(long long history : { 1000LL, 1000000LL }) {
+        string tag = "/" + to_string(history);
+        MoveModel model;
+        mt19937 rng(1);
+        auto t0 = chrono::steady_clock::now();
+        for(long long i=0; i<history; ++i) {
+            if(i % MAX_ROUNDS == 0) model.startGame();
+            model.record((MoveType)(rng() % 3), rng() % 10 == 0);
+        }
+        double updateNs = nsSince(t0) / history;
+        double winPct;
+        double us = runHabitGames(heroes, &model, DECISIONS, winPct);
+        out.push_back({ "model/update" + tag, updateNs, "ns/round" });
+        out.push_back({ "model/decide" + tag, us, "us/op" });
+        out.push_back({ "model/habitPlayerWins" + tag, winPct, "%" });
+    }
+    double winPct;
+    double us = runHabitGames(heroes, nullptr, DECISIONS, winPct);
+    out.push_back({ "model/decideWeightedRandom", us, "us/op" });
+    out.push_back({ "model/habitPlayerWinsVsRandom", winPct, "%" });
+    return out;
+}
+
+// ---------- 玩家数据 ----------
+
+// 在独立的临时目录里运行 (DataManager 的文件名都相对当前目录)
+class ScratchDir {
+public:
+    ScratchDir() {
+        old = fs::current_path();
+        dir = fs::temp_directory_path() / ("kop_bench_" + to_string(chrono::steady_clock::now().time_since_epoch().count()));
+        fs::create_directories(dir);
+        fs::current_path(dir);
+    }
+    ~ScratchDir() {
+        fs::current_path(old);
+        error_code ec;
+        fs::remove_all(dir, ec);
+    }
+
+private:
+    fs::path old, dir;
+};
+
+// n 个玩家：注册、登录、退出时保存 (最后一次压缩)、重新载入，以及快照文件大小
+static vector<BenchResult> benchPlayers(int n) {
+    ScratchDir scratch;
+    string tag = "/" + to_string(n);
+    vector<BenchResult> out;
+    vector<string> names(n);
+    for(int i=0; i<n; ++i) names[i] = "player" + to_string(i);
+
+    unique_ptr<DataManager> dm(new DataManager);
+    auto t0 = chrono::steady_clock::now();
+    for(int i=0; i<n; ++i) dm->registerUser(names[i], "pw");
+    out.push_back({ "players/registerUser" + tag, nsSince(t0) / n, "ns/op" });
+
+    mt19937 rng(4);
+    const int LOGINS = 100000;
+    t0 = chrono::steady_clock::now();
+    int ok = 0;
+    for(int i=0; i<LOGINS; ++i) ok += dm->login(names[rng() % n], "pw");
+    out.push_back({ "players/login" + tag, nsSince(t0) / LOGINS, "ns/op" });
+    sink = ok;
+
+    dm->flush();
+    t0 = chrono::steady_clock::now();
+    dm.reset(); // 析构时写完日志并压缩成快照 (savePlayers)
+    out.push_back({ "players/savePlayers" + tag, nsSince(t0) / 1e6, "ms" });
+
+    t0 = chrono::steady_clock::now();
+    dm.reset(new DataManager); // loadPlayers：映射快照 + 重放日志
+    out.push_back({ "players/loadPlayers" + tag, nsSince(t0) / 1e6, "ms" });
+    sink = dm->playerCount();
+    dm.reset();
+    out.push_back({ "players/snapshotBytes" + tag, (double)fs::file_size("users.dat"), "bytes" });
+    return out;
+}
+
+// ---------- 排行榜 ----------
+
+static vector<BenchResult> benchLeaderboard(int n) {
+    string tag = "/" + to_string(n);
+    mt19937 rng(5);
+    vector<int> scores(n);
+    for(int& s : scores) s = rng() % 1000;
+
+    PlayerLeaderboard board;
+    auto t0 = chrono::steady_clock::now();
+    board.assign(scores);
+    double assignMs = nsSince(t0) / 1e6;
+
+    const int UPDATES = 100000;
+    t0 = chrono::steady_clock::now();
+    for(int i=0; i<UPDATES; ++i) board.update(rng() % n, rng() % 1000);
+    double updateNs = nsSince(t0) / UPDATES;
+
+    t0 = chrono::steady_clock::now();
+    long long sum = 0;
+    for(int i=0; i<1000; ++i) sum += board.top(100).size() + board.rankOf(rng() % n);
+    double topUs = nsSince(t0) / 1000 / 1e3;
+    sink = sum;
+
+    // 按用户名排序 (排行榜搜索框用的名字索引就是这样建的)
+    vector<string> names(n);
+    for(int i=0; i<n; ++i) names[i] = "player" + to_string(rng());
+    vector<int> order(n);
+    for(int i=0; i<n; ++i) order[i] = i;
+    t0 = chrono::steady_clock::now();
+    sort(order.begin(), order.end(), [&](int a, int b) { return names[a] < names[b]; });
+    double nameMs = nsSince(t0) / 1e6;
+
+    return { { "leaderboard/assign" + tag, assignMs, "ms" },
+             { "leaderboard/update" + tag, updateNs, "ns/op" },
+             { "leaderboard/top100+rankOf" + tag, topUs, "us/op" },
+             { "leaderboard/sortByName" + tag, nameMs, "ms" } };
+}
+
+// ---------- 出招时限 (时间轮) ----------
+
+// 10 万局的出招时限放在一个时间轮里：按模拟时钟测设置、取消、到期触发的平均耗时；
+// 再按真实的单调时钟睡到下一个截止时刻就推进，测触发比截止时刻晚了多少 (p99)
+static vector<BenchResult> benchDeadlines() {
+    const int N = 100000;
+    mt19937 rng(6);
+    TimerWheel wheel(0);
+    vector<TimerWheel::Id> ids(N);
+    auto t0 = chrono::steady_clock::now();
+    for(int i=0; i<N; ++i) ids[i] = wheel.arm(1 + rng() % 10000, i); // 10 秒之内
+    double armNs = nsSince(t0) / N;
+
+    t0 = chrono::steady_clock::now();
+    for(int i=0; i<N; i+=2) wheel.cancel(ids[i]); // 一半的玩家按时出了招
+    double cancelNs = nsSince(t0) / (N / 2);
+
+    long long sum = 0;
+    t0 = chrono::steady_clock::now();
+    size_t fired = wheel.advance(10000, [&](uint64_t p) { sum += p; });
+    double fireNs = nsSince(t0) / fired;
+    sink = sum;
+
+    TimerWheel live;
+    uint64_t start = live.now();
+    vector<uint64_t> due(N);
+    for(int i=0; i<N; ++i) live.arm(due[i] = start + 10 + rng() % 1000, i);
+    vector<double> lateMs;
+    lateMs.reserve(N);
+    while(live.size() > 0) {
+        this_thread::sleep_until(chrono::steady_clock::time_point(chrono::milliseconds(live.now() + live.nextTimeoutMs())));
+        double nowMs = chrono::duration<double, milli>(chrono::steady_clock::now().time_since_epoch()).count();
+        live.advance(TimerWheel::clockMs(), [&](uint64_t p) { lateMs.push_back(nowMs - due[p]); });
+    }
+    sort(lateMs.begin(), lateMs.end());
+
+    return { { "deadlines/arm", armNs, "ns/op" }, { "deadlines/cancel", cancelNs, "ns/op" },
+             { "deadlines/fire", fireNs, "ns/op" }, { "deadlines/lateness p99", lateMs[lateMs.size() * 99 / 100], "ms" } };
+}
+
+// ---------- 结果输出与基准线 ----------
+
+// 运行的机器：CPU 型号 (Linux 下读 /proc/cpuinfo)、逻辑核心数和编译器，写进基准线，换了机器的比较结果没有意义
+static string machineInfo() {
+    string cpu = "unknown cpu";
+    ifstream in("/proc/cpuinfo");
+    string line;
+    while(getline(in, line)) {
+        if(line.compare(0, 10, "model name") != 0) continue;
+        size_t colon = line.find(':');
+        if(colon != string::npos) cpu = line.substr(line.find_first_not_of(" \t", colon + 1));
+        break;
+    }
+    ostringstream out;
+    out << cpu << ", " << thread::hardware_concurrency() << " 个逻辑核心, ";
+#if defined(__clang__)
+    out << "clang " << __clang_version__;
+#elif defined(__GNUC__)
+    out << "gcc " << __VERSION__;
+#elif defined(_MSC_VER)
+    out << "MSVC " << _MSC_VER;
+#endif
+    string s = out.str();
+    s.erase(remove(s.begin(), s.end(), '"'), s.end());
+    return s;
+}
+
+static string toJson(const vector<BenchResult>& results) {
+    ostringstream out;
+    out << "{\"machine\":\"" << machineInfo() << "\",\n\"benchmarks\":[\n";
+    for(size_t i=0; i<results.size(); ++i) {
+        out << "{\"name\":\"" << results[i].name << "\",\"value\":" << setprecision(6) << results[i].value
+            << ",\"unit\":\"" << results[i].unit << "\"}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]}\n";
+    return out.str();
+}
+
+// 读基准线 (--json 的输出，每项一行)：只认 name 和 value 两个字段，machine 存进 machine
+static map<string, double> loadBaseline(const string& path, string& machine) {
+    map<string, double> base;
+    ifstream in(path);
+    string line;
+    while(getline(in, line)) {
+        size_t m = line.find("\"machine\":\"");
+        if(m != string::npos) {
+            m += 11;
+            machine = line.substr(m, line.find('"', m) - m);
+            continue;
+        }
+        size_t n = line.find("\"name\":\""), v = line.find("\"value\":");
+        if(n == string::npos || v == string::npos) continue;
+        n += 8;
+        size_t end = line.find('"', n);
+        if(end == string::npos) continue;
+        base[line.substr(n, end - n)] = atof(line.c_str() + v + 8);
+    }
+    return base;
+}
+
+int main(int argc, char* argv[]) {
+    string filter, savePath, basePath;
+    int reps = 5, maxUsers = 1000000;
+    double tolerance = 0.10;
+    bool json = false;
+    for(int i=1; i<argc; ++i) {
+        string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(a == "--filter" && hasValue) filter = argv[++i];
+        else if(a == "--reps" && hasValue) reps = max(1, atoi(argv[++i]));
+        else if(a == "--max-users" && hasValue) maxUsers = atoi(argv[++i]);
+        else if(a == "--save-baseline" && hasValue) savePath = argv[++i];
+        else if(a == "--baseline" && hasValue) basePath = argv[++i];
+        else if(a == "--tolerance" && hasValue) tolerance = atof(argv[++i]);
+        else if(a == "--json") json = true;
+        else { cerr << "未知参数 " << a << endl; return 2; }
+    }
+
+    vector<Bench> benches = {
+        { "hero/legacyVectorPool", benchLegacyMakeRandomMove },
+        { "hero/makeRandomMove", benchMakeRandomMove },
+        { "hero/sampleMove", benchSampleMove },
+        { "round", benchRoundResolution },
+        { "deadlines", benchDeadlines },
+        { "stats", benchStats },
+        { "model", benchModel },
+    };
+    for(int n=1000; n<=maxUsers; n*=10) {
+        benches.push_back({ "players/" + to_string(n), [n] { return benchPlayers(n); } });
+        benches.push_back({ "leaderboard/" + to_string(n), [n] { return benchLeaderboard(n); } });
+    }
+
+    // 每项跑 reps 遍，每个指标取中位数
+    vector<BenchResult> results;
+    for(const Bench& b : benches) {
+        if(!filter.empty() && b.name.find(filter) == string::npos) continue;
+        if(!json) cerr << "运行 " << b.name << " ..." << endl;
+        map<string, vector<double>> samples;
+        vector<BenchResult> first;
+        for(int r=0; r<reps; ++r) {
+            vector<BenchResult> got = b.run();
+            if(r == 0) first = got;
+            for(const BenchResult& g : got) samples[g.name].push_back(g.value);
+        }
+        for(BenchResult res : first) {
+            vector<double>& v = samples[res.name];
+            sort(v.begin(), v.end());
+            res.value = v[v.size() / 2];
+            results.push_back(res);
+        }
+    }
+
+    if(!savePath.empty()) {
+        ofstream(savePath) << toJson(results);
+        if(!json) cerr << "基准线已保存到 " << savePath << endl;
+    }
+    if(json) {
+        cout << toJson(results);
+    }
+
+    map<string, double> base;
+    if(!basePath.empty()) {
+        string machine;
+        base = loadBaseline(basePath, machine);
+        if(base.empty()) { cerr << "无法读取基准线 " << basePath << endl; return 2; }
+        if(machine != machineInfo()) {
+            cerr << "注意: 基准线记录于 " << (machine.empty() ? "未知机器" : machine) << "，本机是 " << machineInfo()
+                 << "，比较结果仅供参考" << endl;
+        }
+    }
+    // 表格 (--json 时表格不输出，只往 cerr 报告退化的指标)
+    int regressions = 0;
+    for(const BenchResult& r : results) {
+        ostringstream note;
+        bool worse = false;
+        auto it = base.find(r.name);
+        if(it != base.end() && it->second > 0) {
+            double change = r.value / it->second - 1;
+            worse = change > tolerance;
+            regressions += worse;
+            note << fixed << setprecision(2) << "  基准 " << it->second << " (" << showpos << setprecision(1)
+                 << change * 100 << "%)" << (worse ? "  <-- 退化" : "");
+        }
+        if(!json) {
+            cout << left << setw(36) << r.name << right << setw(14) << fixed << setprecision(2) << r.value
+                 << " " << left << setw(6) << r.unit << note.str() << endl;
+        } else if(worse) {
+            cerr << r.name << note.str() << endl;
+        }
+    }
+    if(!basePath.empty()) {
+        cerr << (regressions ? to_string(regressions) + " 项比基准线差超过 " : "没有指标比基准线差超过 ")
+             << fixed << setprecision(0) << tolerance * 100 << "%" << endl;
+    }
+    return regressions ? 1 : 0;
+}
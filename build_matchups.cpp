@@ -0,0 +1,56 @@
+/**
+ * 文件名: build_matchups.cpp
+ * 描述: 离线构建阵容对阵表 matchups.bin (英雄名单取自 heroes.txt，没有时用内置名单)。英雄名单没有变化时直接跳过，
+ *       所以可以放心地挂在每次编译之后运行。
+ * 用法: build_matchups [输出文件=matchups.bin] [线程数=CPU核心数] [--force]
+ */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include "matchup_table.h"
+
+int main(int argc, char* argv[]) {
+    string path = "matchups.bin";
+    int threads = (int)thread::hardware_concurrency();
+    bool force = false;
+    int pos = 0;
+    for(int i=1; i<argc; ++i) {
+        string arg = argv[i];
+        if(arg == "--force") force = true;
+        else if(pos++ == 0) path = arg;
+        else threads = atoi(argv[i]);
+    }
+
+    vector<Hero> heroes = DataManager::loadHeroRoster();
+    if(!MatchupTable::supports(heroes.size())) {
+        cout << "英雄名单有 " << heroes.size() << " 个英雄，对阵表过大，跳过构建" << endl;
+        return 0;
+    }
+    if(!force && MatchupTable::isUpToDate(path, heroes)) {
+        cout << path << " 已是最新 (英雄名单未变化)" << endl;
+        return 0;
+    }
+
+    cout << "构建 " << path << ": " << heroes.size() << " 个英雄, "
+         << MatchupTable::lineupCount(heroes.size()) << " 套阵容, " << threads << " 个线程" << endl;
+    auto t0 = chrono::steady_clock::now();
+    if(!MatchupTable::build(heroes, path, threads)) {
+        cout << "写入失败: " << path << endl;
+        return 1;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    cout << fixed << setprecision(2) << "完成, 耗时 " << secs << " 秒" << endl;
+
+    // 读回验证，顺便列出英雄选取评分
+    MatchupTable table;
+    if(!table.open(path, heroes)) {
+        cout << "读回校验失败" << endl;
+        return 1;
+    }
+    vector<int> order(heroes.size());
+    for(size_t i=0; i<order.size(); ++i) order[i] = i;
+    sort(order.begin(), order.end(), [&](int a, int b){ return table.heroRating(a) > table.heroRating(b); });
+    cout << setprecision(4) << "\n英雄\t选取评分" << endl;
+    for(int i : order) cout << heroes[i].name << "\t" << table.heroRating(i) << endl;
+    return 0;
+}
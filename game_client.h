@@ -0,0 +1,99 @@
+/**
+ * 文件名: game_client.h
+ * 描述: 对战服务器的同步客户端 - 界面连接服务器时作为瘦客户端使用：规则全部在服务器上执行，
+ *       每次应答都把服务器上的对局状态写进本地 BattleEngine 的公开字段 (镜像)，
+ *       界面原有的显示代码照常读取这个镜像，不需要知道对局跑在哪里。
+ * 注意: 请求是阻塞发送的；本机或局域网内一次往返远小于 1 毫秒，不影响界面响应。
+ */
+#ifndef GAME_CLIENT_H
+#define GAME_CLIENT_H
+
+#include <string>
+#include <vector>
+#include "net.h"
+#include "protocol.h"
+
+class GameClient {
+public:
+    ~GameClient() { close(); }
+
+    bool connect(const string& host, int port) {
+        close();
+        netInit();
+        fd = netConnect(host, port);
+        return fd != INVALID_SOCK;
+    }
+
+    bool isConnected() const { return fd != INVALID_SOCK; }
+
+    void close() {
+        if(fd != INVALID_SOCK) netClose(fd);
+        fd = INVALID_SOCK;
+    }
+
+    // 发送一个请求并等待应答；连接断开时自动关闭并返回 false
+    bool call(Request q, Reply& r) {
+        q.tag = nextTag++;
+        if(!isConnected() || !netSendAll(fd, &q, sizeof(q)) || !netRecvAll(fd, &r, sizeof(r))) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // 在服务器上开一局，并把初始状态写进镜像
+    bool startMatch(BattleEngine& mirror, const vector<int>& mine, bool solver) {
+        Request q = {};
+        q.type = REQ_NEW_MATCH;
+        q.flags = solver ? REQ_FLAG_SOLVER : 0;
+        for(int i=0; i<TEAM_SIZE; ++i) q.heroes[i] = (uint16_t)mine[i];
+        Reply r;
+        if(!call(q, r) || r.status != REPLY_OK) return false;
+        matchId = r.matchId;
+        mirror.myHeroIndices = mine;
+        mirror.rounds.clear();
+        applyReply(mirror, r);
+        for(int i=0; i<TEAM_SIZE; ++i) mirror.cpuMoves[i] = packMoves(mirror.heroes[mirror.cpuHeroIndices[i]]);
+        return true;
+    }
+
+    // 出招 (timedOut 时由服务器随机代出)，结算结果写进镜像并通过 out 返回
+    // 这一回合已经被服务器按出招时限代出时，out 是代出的结果 (out.timedOut 为 true)
+    bool playRound(BattleEngine& mirror, MoveType m, bool timedOut, RoundResult& out) {
+        Request q = {};
+        q.type = REQ_MOVE;
+        q.move = (uint8_t)m;
+        q.flags = timedOut ? REQ_FLAG_TIMEOUT : 0;
+        q.round = (uint8_t)mirror.currentRound;
+        q.matchId = matchId;
+        Reply r;
+        if(!call(q, r) || (r.status != REPLY_OK && r.status != REPLY_ROUND_EXPIRED)) return false;
+        out = { r.round - 1, r.myHero, r.cpuHero, (MoveType)r.myMove, (MoveType)r.cpuMove, r.outcome };
+        out.timedOut = timedOut || r.status == REPLY_ROUND_EXPIRED; // 服务器已经按时限代出了这一回合
+        mirror.rounds.push_back(out);
+        int cpuSlot = mirror.currentCpuHeroIndex;
+        applyReply(mirror, r);
+        if(cpuSlot >= 0 && r.cpuMove <= PAPER) mirror.cpuMoves[cpuSlot] = removeMove(mirror.cpuMoves[cpuSlot], (MoveType)r.cpuMove);
+        return true;
+    }
+
+private:
+    socket_t fd = INVALID_SOCK;
+    uint32_t matchId = 0;
+    uint32_t nextTag = 1;
+
+    // 镜像只覆盖界面会读的字段；电脑预先出的招在服务器上保密，镜像里始终为 NONE
+    // 电脑的库存由客户端自己按开局阵容和每回合亮出的招推算 (出招胜率要用)
+    static void applyReply(BattleEngine& e, const Reply& r) {
+        e.matchSeed = r.seed;
+        e.currentRound = r.round;
+        e.myScore = r.myScore;
+        e.cpuScore = r.cpuScore;
+        e.currentCpuHeroIndex = r.cpuSlot;
+        e.cpuNextMove = NONE;
+        e.cpuHeroIndices.assign(r.cpuLineup, r.cpuLineup + TEAM_SIZE);
+        for(int i=0; i<TEAM_SIZE; ++i) e.myMoves[i] = r.myMoves[i];
+    }
+};
+
+#endif
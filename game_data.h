@@ -1,6 +1,6 @@
 /**
  * 文件名: game_data.h
- * 描述: 核心逻辑模块 - 包含英雄(Hero)、玩家(Player)定义以及数据管理(DataManager)。
+ * 描述: 核心逻辑模块 - 包含英雄(Hero)定义以及数据管理(DataManager)；玩家(Player)及其存储见 player_store.h。
  * 注意: 这是一个纯逻辑头文件，不包含任何 Qt 界面代码，符合 MVC 设计模式中的 Model 层。
  */
 #ifndef GAME_DATA_H
@@ -13,20 +13,34 @@
 #include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "leaderboard.h"
+#include "player_store.h"
+#include "matchmaking.h"
+#include "move_model.h"
+#include "trace.h"
+#include "rules.h"
+#include "hero_ledger.h"
 
 using namespace std;
 
 // 招数枚举：使用枚举比使用 0,1,2 魔法数字更易读、更易维护
+// 取值与 rules.h 中经典规则 (ClassicRules) 的招数编号一致
 enum MoveType { SCISSORS = 0, ROCK = 1, PAPER = 2, NONE = -1 };
 
+const int MAX_ROUNDS = 9; // 每局固定 9 回合
+const int TEAM_SIZE = 3;  // 每方 3 个英雄
+const int TURN_TIME_LIMIT = 10; // 每回合的思考时限 (秒)，超时由系统随机代出
+
 // 辅助函数：将枚举转换为中文，用于日志显示
 static string moveToString(MoveType m) {
-    switch (m) {
-        case SCISSORS: return "剪刀";
-        case ROCK:     return "石头";
-        case PAPER:    return "布";
-        default:       return "未知";
-    }
+    return m >= 0 && m < ClassicRules::MOVES ? ClassicRules::name(m) : "未知";
 }
 
 // ==========================================
@@ -65,20 +79,18 @@ public:
 
     // 核心算法：随机出招（并自动扣除库存）
     // 算法亮点：使用“加权随机”逻辑，而非简单的 rand()%3
-    MoveType makeRandomMove() {
-        vector<MoveType> pool;
-        // 将剩余招数展开到 pool 中。例如：剩2剪刀1石头 -> {剪, 剪, 石}
-        // 这样随机取一个元素，自然符合概率分布
-        for(int i=0; i<currentS; ++i) pool.push_back(SCISSORS);
-        for(int i=0; i<currentR; ++i) pool.push_back(ROCK);
-        for(int i=0; i<currentP; ++i) pool.push_back(PAPER);
-        
-        if(pool.empty()) return NONE;
+    // 随机数引擎由调用方提供 (对局中统一用对战引擎的 rng，保证一局可以按种子重现)
+    template <class RNG>
+    MoveType makeRandomMove(RNG& rng) {
+        int total = currentS + currentR + currentP;
+        if(total <= 0) return NONE;
 
-        // 使用 C++11 标准的随机数生成器 (比 C 语言的 rand() 更均匀)
-        static mt19937 rng(time(0));
-        uniform_int_distribution<int> dist(0, pool.size()-1);
-        MoveType m = pool[dist(rng)];
+        // 想象把剩余招数展开成一排。例如：剩2剪刀1石头 -> {剪, 剪, 石}
+        // 随机取第 x 个，x < 剪刀数 为剪刀，其次是石头，最后是布，自然符合概率分布
+        // 两次比较相加即得招数，不需要真的构造这个数组
+        uniform_int_distribution<int> dist(0, total-1);
+        int x = dist(rng);
+        MoveType m = (MoveType)((x >= currentS) + (x >= currentS + currentR));
         
         useMove(m); // 扣除库存
         return m;
@@ -98,41 +110,151 @@ public:
     }
 };
 
-// ==========================================
-// 类: Player (玩家)
-// 描述: 简单的用户账户结构
-// ==========================================
-class Player {
-public:
-    string username;
-    string password;
-    int totalWins; // 累计胜场
-    Player(string u, string p, int w) : username(u), password(p), totalWins(w) {}
-};
-
 // ==========================================
 // 类: DataManager (数据管理器)
 // 描述: 负责全局数据的加载、保存和查找
+// 持久化: users.dat 是二进制快照，启动时直接内存映射，不随玩家数量变慢；
+//        之后的每次注册/胜场变化只在 users.journal 末尾追加一行，
+//        后台线程定期把“快照 + 日志”压缩成新的快照，所以注册或记一场胜利的开销与玩家总数无关。
+//        文本文件 users.txt 只作为导入/导出格式，第一次运行时自动迁移。
+// 写盘: 所有磁盘操作都在后台写线程中进行。注册、记胜只把日志行放进内存缓冲就返回，
+//        写线程醒来后把攒下的所有行一次写出，连续多次修改合并成一次写；
+//        快照先写临时文件并 fsync，再原子地改名替换，任何时刻被 kill -9 都不会留下残缺的快照。
+//        需要确认数据已经落盘时 (例如退出前) 调用 flush()。
+//        玩家出招模型 (move_model.h) 按玩家编号存放在 models.dat 的定长记录里，同样由写线程写出。
+//        英雄战绩 (hero_ledger.h) 同样是“快照 herostats.dat + 日志 herostats.journal”：每回合追加一行日志，
+//        写线程定期压缩；启动时读快照、重放日志，再用累计战绩恢复各英雄的胜率 (Hero::winMatches / totalMatches)。
+// 线程: 玩家数据由 mtx 保护，界面只通过下面的成员函数访问
 // ==========================================
 class DataManager {
 public:
     vector<Hero> heroes;    // 所有可选英雄
-    vector<Player> players; // 所有注册玩家
-    Player* currentUser = nullptr; // 当前登录玩家的指针
+    Player* currentUser = nullptr; // 当前登录玩家的指针 (指向覆盖层，地址稳定)
+
+    // 英雄胜率榜：回合结算时增量更新
+    HeroLeaderboard heroBoard;
+
+    string heroCatalogError; // 最近一次读取英雄名单文件的错误 (为空表示没有错误)
+
+    static const int COMPACT_THRESHOLD = 1000;  // 日志累计这么多条就触发一次压缩
+    static constexpr int COMPACT_INTERVAL_SEC = 30; // 日志不满也会定期压缩
+
+    // 英雄名单文件：每行 "名字 剪刀 石头 布"，可以直接用文本编辑器增删英雄，界面运行中修改也会自动重新载入
+    static constexpr const char* HERO_CATALOG_FILE = "heroes.txt";
+    static const int HERO_MAX_MOVES = 15;    // 每种招最多 15 个 (打包库存每种招只占 4 位，见 hero_state.h)
+    static const int HERO_MIN_MOVES = MAX_ROUNDS / TEAM_SIZE; // 每个英雄至少 3 招，任意三人合计都够打满 9 回合
+    static const int HERO_MAX_COUNT = 65535; // 回放文件和网络协议中英雄下标是 16 位
 
     DataManager() {
         initHeroes();
+        loadHeroLedger();
         loadPlayers();
+        writer = thread(&DataManager::writerLoop, this);
     }
     
-    // 析构函数：程序退出时自动保存数据
+    // 析构函数：写线程写完剩余的日志、做最后一次压缩后退出
     ~DataManager() {
-        savePlayers();
+        {
+            lock_guard<mutex> lk(mtx);
+            stopping = true;
+        }
+        cv.notify_one();
+        writer.join();
+    }
+
+    // 等到调用之前的所有修改都写进日志并落盘 (fsync) 后返回
+    void flush() {
+        unique_lock<mutex> lk(mtx);
+        uint64_t target = appendedSeq;
+        if(syncedSeq >= target) return;
+        syncWanted = max(syncWanted, target);
+        cv.notify_one();
+        synced.wait(lk, [&]{ return syncedSeq >= target; });
     }
 
-    // 初始化题目指定的 15 位英雄数据
+    // 初始化英雄名单：读取 heroes.txt；文件不存在时写出题目指定的 15 位英雄，方便在此基础上修改
+    // 文件有错误时使用内置名单，错误原因记在 heroCatalogError 中
     void initHeroes() {
-        heroes = {
+        if(!loadHeroCatalog(HERO_CATALOG_FILE, heroes, &heroCatalogError)) {
+            heroes = defaultHeroes();
+            if(!ifstream(HERO_CATALOG_FILE).is_open()) {
+                saveHeroCatalog(HERO_CATALOG_FILE, heroes);
+                heroCatalogError.clear();
+            }
+        }
+        rebuildHeroBoard();
+    }
+
+    // 名单文件被修改后重新载入。对战引擎按下标引用英雄，所以不能在对局进行中调用
+    // 同名英雄保留已有的胜率统计；文件有错误时保留原名单并返回 false
+    bool reloadHeroes() {
+        vector<Hero> loaded;
+        if(!loadHeroCatalog(HERO_CATALOG_FILE, loaded, &heroCatalogError)) return false;
+        unordered_map<string, int> before;
+        for(int i=0; i<(int)heroes.size(); ++i) before[heroes[i].name] = i;
+        for(Hero& h : loaded) {
+            auto it = before.find(h.name);
+            if(it == before.end()) continue;
+            h.winMatches = heroes[it->second].winMatches;
+            h.totalMatches = heroes[it->second].totalMatches;
+        }
+        heroes = move(loaded); // 仍是同一个 vector 对象，对战引擎持有的引用不失效
+        {
+            lock_guard<mutex> lk(mtx);
+            heroLedger.rename(heroNames()); // 日志里记的是名字，改编号不用压缩
+        }
+        rebuildHeroBoard();
+        return true;
+    }
+
+    // 读取英雄名单文件：每行 "名字 剪刀 石头 布"，空行和 # 开头的行忽略
+    // 名字不能重复，每种招 0~15 个且合计至少 3 招，至少要有 3 个英雄；出错时 out 不变，error 中写明第几行
+    static bool loadHeroCatalog(const string& path, vector<Hero>& out, string* error = nullptr) {
+        auto fail = [error](const string& msg) { if(error) *error = msg; return false; };
+        ifstream file(path);
+        if(!file.is_open()) return fail("无法打开 " + path);
+        vector<Hero> list;
+        unordered_map<string, int> lineOf;
+        string line;
+        for(int n = 1; getline(file, line); ++n) {
+            if(n == 1 && line.compare(0, 3, "\xEF\xBB\xBF") == 0) line.erase(0, 3); // 记事本保存的 UTF-8 BOM
+            istringstream in(line);
+            string name, rest;
+            int s, r, p;
+            if(!(in >> name) || name[0] == '#') continue;
+            string where = path + " 第 " + to_string(n) + " 行: ";
+            if(!(in >> s >> r >> p) || (in >> rest && rest[0] != '#')) return fail(where + "格式应为 \"名字 剪刀 石头 布\"");
+            if(min({ s, r, p }) < 0 || max({ s, r, p }) > HERO_MAX_MOVES || s + r + p < HERO_MIN_MOVES) {
+                return fail(where + "每种招应为 0~" + to_string(HERO_MAX_MOVES) + " 个，合计至少 " + to_string(HERO_MIN_MOVES) + " 招");
+            }
+            if(!lineOf.emplace(name, n).second) return fail(where + name + " 与第 " + to_string(lineOf[name]) + " 行重名");
+            list.emplace_back(name, s, r, p);
+        }
+        if((int)list.size() < TEAM_SIZE) return fail(path + ": 至少需要 " + to_string(TEAM_SIZE) + " 个英雄");
+        if((int)list.size() > HERO_MAX_COUNT) return fail(path + ": 英雄不能超过 " + to_string(HERO_MAX_COUNT) + " 个");
+        out = move(list);
+        if(error) error->clear();
+        return true;
+    }
+
+    static bool saveHeroCatalog(const string& path, const vector<Hero>& list) {
+        ofstream file(path);
+        file << "# 英雄名单: 名字 剪刀 石头 布 (每种招 0~" << HERO_MAX_MOVES << " 个，合计至少 " << HERO_MIN_MOVES
+             << " 招)，保存后游戏会自动重新载入\n";
+        for(const Hero& h : list) file << h.name << " " << h.s << " " << h.r << " " << h.p << "\n";
+        return (bool)file.flush();
+    }
+
+    // 无界面工具 (模拟器、服务器、回放等) 用的英雄名单：与界面读同一个 heroes.txt，没有时用内置名单
+    static vector<Hero> loadHeroRoster() {
+        vector<Hero> list;
+        if(!loadHeroCatalog(HERO_CATALOG_FILE, list)) list = defaultHeroes();
+        return list;
+    }
+
+    // 内置的题目指定 15 位英雄：heroes.txt 不存在或有错误时使用
+    static vector<Hero> defaultHeroes() {
+        return {
             {"赵云", 2, 2, 2}, {"宫本武藏", 4, 1, 1}, {"凯", 2, 3, 1},
             {"白起", 5, 0, 1}, {"韩信", 1, 2, 3}, {"诸葛亮", 2, 1, 3},
             {"刘邦", 2, 0, 4}, {"后羿", 0, 3, 3}, {"王昭君", 1, 1, 4},
@@ -141,37 +263,603 @@ public:
         };
     }
 
-    // 从文件读取玩家数据
+    // 读取玩家数据：映射快照 (常数时间)，再按顺序重放日志 (日志长度有上限)
     void loadPlayers() {
-        ifstream file("users.txt");
-        if(!file.is_open()) return; // 文件不存在可能是第一次运行，直接忽略
-        string u, p; int w;
-        while(file >> u >> p >> w) players.emplace_back(u, p, w);
+        bool migrate = !players.open(SNAPSHOT_FILE) && importPlayers(TEXT_FILE) > 0;
+
+        // 上次压缩中途退出时，被轮换出去的旧日志还在，要先于当前日志重放
+        bool interrupted = replayJournal(ROTATED_JOURNAL_FILE);
+        replayJournal(JOURNAL_FILE);
+        if(migrate || interrupted) savePlayers(); // 立即生成快照 / 补做那次压缩
     }
 
-    // 保存玩家数据到文件
+    // 压缩：把当前全部玩家写成新快照，并清空日志 (由写线程调用；启动时补做压缩则在写线程启动之前)
+    // 只在持锁期间复制覆盖层并轮换日志，写文件时不阻塞注册和记胜
     void savePlayers() {
-        ofstream file("users.txt");
-        for(const auto& p : players) file << p.username << " " << p.password << " " << p.totalWins << endl;
+        TRACE_SCOPE("DataManager::savePlayers");
+        lock_guard<mutex> saveLock(saveMtx);
+        unordered_map<int, Player> changed;
+        int total;
+        {
+            lock_guard<mutex> lk(mtx);
+            changed = players.overlaySnapshot();
+            total = players.size();
+            rotateJournal();
+        }
+        // 写失败或换不上时，旧快照和轮换出去的旧日志都留着 (下次压缩把新日志接在旧日志后面)，
+        // 重放旧快照 + 旧日志 + 新日志即可恢复；只有新快照换上并重新映射成功后才删旧日志
+        string tmp = string(SNAPSHOT_FILE) + ".tmp";
+        if(!players.writeSnapshot(tmp, total, changed)) return;
+        {
+            PlayerStore check; // 先确认新快照能映射，免得换上一个打不开的文件
+            if(!check.open(tmp)) { remove(tmp.c_str()); return; }
+        }
+        bool replaced;
+        {
+            // 换上新快照 (Windows 下必须先解除映射才能替换文件)
+            lock_guard<mutex> lk(mtx);
+            players.close();
+            replaced = replaceFile(tmp, SNAPSHOT_FILE);
+            if(!replaced) remove(tmp.c_str());
+            if(!players.open(SNAPSHOT_FILE)) {
+                // 快照映射不回来，快照里的玩家都无法访问了；磁盘上的快照和日志完整，立即退出，下次启动重放恢复
+                fprintf(stderr, "无法重新映射玩家快照 %s，为避免数据损坏立即退出\n", SNAPSHOT_FILE);
+                abort();
+            }
+        }
+        if(replaced) remove(ROTATED_JOURNAL_FILE);
     }
 
-    // 注册逻辑：查重 -> 添加 -> 保存
+    // 从文本文件 (每行: 用户名 密码 胜场) 导入玩家，已存在的用户名跳过，返回导入人数
+    int importPlayers(const string& path) {
+        ifstream file(path);
+        string u, p; int w, n = 0;
+        lock_guard<mutex> lk(mtx);
+        while(file >> u >> p >> w) {
+            if(players.find(u) >= 0) continue;
+            int id = addPlayer(u, p, w);
+            appendJournal('R', players.at(id));
+            n++;
+        }
+        return n;
+    }
+
+    // 导出全部玩家为文本文件，返回是否成功
+    bool exportPlayers(const string& path) {
+        ofstream file(path);
+        lock_guard<mutex> lk(mtx);
+        for(int id=0; id<players.size(); ++id) {
+            Player p = players.get(id);
+            file << p.username << " " << p.password << " " << p.totalWins << "\n";
+        }
+        return (bool)file.flush();
+    }
+
+    // 注册逻辑：查重 -> 添加 -> 追加一条日志
     bool registerUser(string u, string p) {
-        for(auto& user : players) if(user.username == u) return false; // 用户名已存在
-        players.emplace_back(u, p, 0);
-        savePlayers();
+        lock_guard<mutex> lk(mtx);
+        if(players.find(u) >= 0) return false; // 用户名已存在
+        int id = addPlayer(u, p, 0);
+        appendJournal('R', players.at(id));
         return true;
     }
 
-    // 登录逻辑：遍历查找匹配
+    // 登录逻辑：哈希索引直接定位
     bool login(string u, string p) {
-        for(auto& user : players) {
-            if(user.username == u && user.password == p) {
-                currentUser = &user; // 记录当前登录状态
-                return true;
+        lock_guard<mutex> lk(mtx);
+        int id = players.find(u);
+        if(id < 0 || players.at(id).password != p) return false;
+        currentUser = &players.at(id); // 记录当前登录状态
+        currentId = id;
+        return true;
+    }
+
+    // 当前玩家胜场 +1，并追加一条日志
+    void recordWin() {
+        lock_guard<mutex> lk(mtx);
+        currentUser->totalWins++;
+        if(boardReady) board.update(currentId, currentUser->totalWins);
+        appendJournal('W', *currentUser);
+    }
+
+    // 结算一场玩家对战的积分 (Elo)：scoreA 为 a 的得分 (胜 1，平 0.5，负 0)，双方各追加一条日志
+    void recordRatedMatch(int a, int b, double scoreA) {
+        lock_guard<mutex> lk(mtx);
+        Player& pa = players.at(a);
+        Player& pb = players.at(b);
+        eloApply(pa, pb, scoreA);
+        if(ratingReady) { ratings.update(a, pa.rating); ratings.update(b, pb.rating); }
+        appendJournal('E', pa);
+        appendJournal('E', pb);
+    }
+
+    int ratingOf(int id) {
+        lock_guard<mutex> lk(mtx);
+        return players.rating(id);
+    }
+
+    // 用户名对应的玩家编号 (积分赛请求用它)，没有这个用户返回 -1
+    int playerId(const string& u) {
+        lock_guard<mutex> lk(mtx);
+        return players.find(u);
+    }
+
+    // 当前登录玩家的编号
+    int currentUserId() const { return currentId; }
+
+    // 当前玩家的出招模型；没有记录 (或记录写到一半损坏) 时返回空模型
+    MoveModel loadMoveModel() {
+        int id;
+        {
+            lock_guard<mutex> lk(mtx);
+            id = currentId;
+            if(id < 0) return MoveModel();
+            auto it = models.find(id);
+            if(it != models.end()) return it->second;
+        }
+        MoveModel m;
+        {
+            lock_guard<mutex> lk(modelMtx);
+            if(openModelFile() && fseek(modelFile, modelOffset(id), SEEK_SET) == 0
+               && fread(&m, sizeof(m), 1, modelFile) == 1 && m.valid()) {
+                m.startGame();
+            } else {
+                m.clear();
             }
         }
-        return false;
+        lock_guard<mutex> lk(mtx);
+        return models.emplace(id, m).first->second; // 期间已经保存过新模型时以新的为准
+    }
+
+    // 保存当前玩家的出招模型 (每局结束时调用)：只放进内存，由写线程写盘
+    void saveMoveModel(const MoveModel& m) {
+        lock_guard<mutex> lk(mtx);
+        if(currentId < 0) return;
+        models[currentId] = m;
+        dirtyModels.push_back(currentId);
+        appendedSeq++;
+        cv.notify_one();
+    }
+
+    // 记一个回合的英雄战绩 (每回合结算后调用)：更新账本并追加一条日志，由写线程写盘
+    void recordHeroRound(int myHero, int cpuHero, MoveType myMove, MoveType cpuMove, int outcome) {
+        long long now = HeroLedger::nowMs();
+        lock_guard<mutex> lk(mtx);
+        heroLedger.recordRound(now, myHero, cpuHero, myMove, cpuMove, outcome);
+        heroLedger.appendJournal(heroJournalBuf, now, myHero, cpuHero, myMove, cpuMove, outcome);
+        heroJournalRecords++;
+        appendedSeq++;
+        cv.notify_one();
+    }
+
+    // 英雄战绩查询：累计或最近 24 小时 / 7 天，只把窗口内的几个桶加起来
+    HeroTally heroRecord(int hero, HeroLedger::Window w) {
+        lock_guard<mutex> lk(mtx);
+        return heroLedger.hero(hero, w);
+    }
+
+    // 英雄 a 对上英雄 b 的战绩 (a 的视角)
+    HeroTally heroVersus(int a, int b, HeroLedger::Window w) {
+        lock_guard<mutex> lk(mtx);
+        return heroLedger.versus(a, b, w);
+    }
+
+    // 英雄出某一招的战绩
+    HeroTally heroMoveRecord(int hero, MoveType m, HeroLedger::Window w) {
+        lock_guard<mutex> lk(mtx);
+        return heroLedger.heroMove(hero, m, w);
+    }
+
+    int playerCount() {
+        lock_guard<mutex> lk(mtx);
+        return players.size();
+    }
+
+    // 排行榜上的一行
+    struct RankEntry { int id; int rank; string username; int wins; int rating; };
+
+    // 胜场最多的前 n 名
+    vector<RankEntry> topPlayers(int n) {
+        lock_guard<mutex> lk(mtx);
+        vector<RankEntry> rows;
+        for(int id : playerBoard().top(n)) rows.push_back({ id, board.rankOf(id), players.username(id), players.wins(id), players.rating(id) });
+        return rows;
+    }
+
+    // 某个玩家的名次 (并列同名次)
+    int rankOf(int id) {
+        lock_guard<mutex> lk(mtx);
+        return playerBoard().rankOf(id);
+    }
+
+    // 排行榜的排序方式
+    enum RankOrder { BY_WINS, BY_RATING, BY_NAME };
+
+    // 排行榜分页：界面的表格模型滚动到底时才调用，每次只取一页
+    // 紧接在 after 这一行之后取 count 行 (after 为空表示从头开始)，续取时不需要从第一名数起；
+    // prefix 非空时只列出用户名以它开头的玩家，此时按用户名排序
+    // 名次列：按积分排序时为积分名次，否则为胜场名次
+    vector<RankEntry> rankPage(RankOrder order, bool descending, const RankEntry* after, int count, const string& prefix = "") {
+        TRACE_SCOPE("DataManager::rankPage");
+        lock_guard<mutex> lk(mtx);
+        vector<int> ids;
+        if(order != BY_NAME && prefix.empty()) {
+            PlayerLeaderboard& b = order == BY_WINS ? playerBoard() : ratingBoard();
+            // 游标用取出那一行时的分数，玩家分数之后变了也不影响续取的位置
+            int afterScore = after ? (order == BY_WINS ? after->wins : after->rating) : 0;
+            ids = b.page(afterScore, after ? after->id : -1, count, descending);
+        } else {
+            const vector<int>& names = nameIndex();
+            auto less = [this](int id, const string& s) { return players.nameView(id) < string_view(s); };
+            int lo = 0, hi = names.size();
+            if(!prefix.empty()) {
+                lo = lower_bound(names.begin(), names.end(), prefix, less) - names.begin();
+                hi = partition_point(names.begin() + lo, names.end(), [&](int id) {
+                    return players.nameView(id).substr(0, prefix.size()) == prefix;
+                }) - names.begin();
+            }
+            int at = after ? (int)(lower_bound(names.begin(), names.end(), after->username, less) - names.begin()) : -1;
+            if(descending) {
+                for(int i = after ? at - 1 : hi - 1; i >= lo && (int)ids.size() < count; --i) ids.push_back(names[i]);
+            } else {
+                for(int i = after ? at + 1 : lo; i < hi && (int)ids.size() < count; ++i) ids.push_back(names[i]);
+            }
+        }
+
+        vector<RankEntry> rows;
+        rows.reserve(ids.size());
+        PlayerLeaderboard& rankBoard = order == BY_RATING && prefix.empty() ? ratingBoard() : playerBoard();
+        for(int id : ids) {
+            rows.push_back({ id, rankBoard.rankOf(id), players.username(id), players.wins(id), players.rating(id) });
+        }
+        return rows;
+    }
+
+private:
+    static constexpr const char* SNAPSHOT_FILE = "users.dat";
+    static constexpr const char* TEXT_FILE = "users.txt";
+    static constexpr const char* JOURNAL_FILE = "users.journal";
+    static constexpr const char* ROTATED_JOURNAL_FILE = "users.journal.1";
+    static constexpr const char* MODEL_FILE = "models.dat"; // [文件头 "KOPL" + 版本][MoveModel x 玩家编号]
+    static const uint32_t MODEL_FILE_VERSION = 1;
+    static constexpr const char* HERO_LEDGER_FILE = "herostats.dat";
+    static constexpr const char* HERO_JOURNAL_FILE = "herostats.journal";
+    static constexpr const char* ROTATED_HERO_JOURNAL_FILE = "herostats.journal.1";
+
+    PlayerStore players;   // 所有注册玩家
+    int currentId = -1;    // 当前登录玩家的编号
+
+    // 玩家胜场榜：第一次查看排行时才建立 (不拖慢启动)，之后增量更新
+    PlayerLeaderboard board;
+    bool boardReady = false;
+    // 积分榜、按用户名排序的玩家编号：同样在第一次用到时才建立
+    PlayerLeaderboard ratings;
+    bool ratingReady = false;
+    vector<int> nameOrder;
+    bool nameReady = false;
+
+    // 日志：修改时追加到 journalBuf，由写线程成批写进文件
+    string journalBuf;            // 还没写出的日志行
+    int journalRecords = 0;       // 自上次压缩以来追加的日志条数
+    uint64_t appendedSeq = 0;     // 已追加的日志条数 (累计，用于 flush)
+    uint64_t syncWanted = 0;      // flush() 要求落盘到第几条
+    uint64_t syncedSeq = 0;       // 已经落盘到第几条
+    FILE* journal = nullptr;      // 只由写线程使用 (保持打开，追加写)
+    mutex journalMtx;             // 保护 journal 文件句柄 (写出与轮换)
+
+    // 出招模型：本次运行中读过或改过的模型留在内存里，改过的由写线程按编号写回 models.dat
+    unordered_map<int, MoveModel> models;
+    vector<int> dirtyModels;      // 改过还没写出的玩家编号 (可能重复)
+    FILE* modelFile = nullptr;
+    mutex modelMtx;               // 保护 modelFile (登录时读、写线程写)
+
+    // 英雄战绩：账本和日志缓冲由 mtx 保护，日志文件句柄由 journalMtx 保护
+    HeroLedger heroLedger;
+    string heroJournalBuf;        // 还没写出的战绩日志行
+    int heroJournalRecords = 0;   // 自上次压缩以来追加的战绩日志条数
+    FILE* heroJournal = nullptr;  // 只由写线程使用
+    uint64_t heroJournalGen = 1;  // 当前日志的代数，每次轮换加一 (由 journalMtx 保护)
+
+    thread writer;               // 后台写线程：写日志、压缩
+    mutex mtx;                   // 保护 players / board / 日志缓冲
+    mutex saveMtx;               // 保证同一时间只有一次压缩
+    condition_variable cv;       // 通知写线程
+    condition_variable synced;   // 通知 flush() 的调用方
+    bool stopping = false;
+
+    vector<string> heroNames() const {
+        vector<string> names;
+        for(const Hero& h : heroes) names.push_back(h.name);
+        return names;
+    }
+
+    // 读英雄战绩：快照 (按名字对到当前名单) + 日志，再把累计战绩填回英雄表
+    void loadHeroLedger() {
+        heroLedger = HeroLedger(heroNames());
+        heroLedger.readSnapshot(HERO_LEDGER_FILE);
+        uint64_t rotatedGen = 0, currentGen = 0;
+        bool interrupted = heroLedger.replayJournal(ROTATED_HERO_JOURNAL_FILE, &rotatedGen) >= 0; // 上次压缩没做完
+        int replayed = heroLedger.replayJournal(HERO_JOURNAL_FILE, &currentGen);
+        // 当前日志还在就接着往里追加 (沿用它的代数)，否则新日志比已有的都新一代
+        heroJournalGen = replayed >= 0 ? currentGen : max(heroLedger.generation(), interrupted ? rotatedGen : 0) + 1;
+        heroJournalRecords = max(0, replayed);
+        if(interrupted) saveHeroLedger();
+        for(int i=0; i<(int)heroes.size(); ++i) {
+            HeroTally t = heroLedger.hero(i, HeroLedger::ALL_TIME);
+            heroes[i].totalMatches = (int)t.rounds;
+            heroes[i].winMatches = (int)t.wins;
+        }
+        rebuildHeroBoard();
+    }
+
+    // 压缩英雄战绩：持锁时把缓冲里的日志写出、复制账本并轮换日志，这样副本正好等于“旧快照 + 旧日志”；
+    // 写快照不持锁。快照记下并入的日志代数，写完快照、删旧日志之前退出的话，下次启动按代数跳过旧日志；
+    // 写失败时旧日志留着，下次压缩接着往它后面追加，战绩不会丢也不会重复
+    void saveHeroLedger() {
+        TRACE_SCOPE("DataManager::saveHeroLedger");
+        lock_guard<mutex> saveLock(saveMtx);
+        HeroLedger copy;
+        {
+            lock_guard<mutex> lk(mtx);
+            writeHeroJournal(heroJournalBuf, false);
+            heroJournalBuf.clear();
+            copy = heroLedger;
+            copy.setGeneration(rotateHeroJournal());
+        }
+        string tmp = string(HERO_LEDGER_FILE) + ".tmp";
+        if(!copy.writeSnapshot(tmp) || !replaceFile(tmp, HERO_LEDGER_FILE)) return;
+        remove(ROTATED_HERO_JOURNAL_FILE);
+    }
+
+    void rebuildHeroBoard() {
+        heroBoard = HeroLeaderboard();
+        for(int i=0; i<(int)heroes.size(); ++i) heroBoard.update(i, heroes[i].getWinRate());
+    }
+
+    // 调用方持有 mtx
+    PlayerLeaderboard& playerBoard() {
+        if(!boardReady) {
+            vector<int> wins(players.size());
+            for(int id=0; id<players.size(); ++id) wins[id] = players.wins(id);
+            board.assign(wins);
+            boardReady = true;
+        }
+        return board;
+    }
+
+    // 调用方持有 mtx
+    PlayerLeaderboard& ratingBoard() {
+        if(!ratingReady) {
+            vector<int> scores(players.size());
+            for(int id=0; id<players.size(); ++id) scores[id] = players.rating(id);
+            ratings.assign(scores);
+            ratingReady = true;
+        }
+        return ratings;
+    }
+
+    // 调用方持有 mtx
+    const vector<int>& nameIndex() {
+        if(!nameReady) {
+            nameOrder.resize(players.size());
+            for(int id=0; id<players.size(); ++id) nameOrder[id] = id;
+            sort(nameOrder.begin(), nameOrder.end(), [this](int a, int b) { return players.nameView(a) < players.nameView(b); });
+            nameReady = true;
+        }
+        return nameOrder;
+    }
+
+    // 加入一名玩家，返回编号；调用方持有 mtx
+    int addPlayer(const string& u, const string& p, int w) {
+        int id = players.add(u, p, w);
+        if(boardReady) board.insert(id, w);
+        if(ratingReady) ratings.insert(id, players.rating(id));
+        if(nameReady) {
+            auto pos = lower_bound(nameOrder.begin(), nameOrder.end(), u,
+                                   [this](int other, const string& s) { return players.nameView(other) < string_view(s); });
+            nameOrder.insert(pos, id);
+        }
+        return id;
+    }
+
+    // 追加一条日志：R 用户名 密码 胜场 (注册) / W 用户名 胜场 (胜场更新) / E 用户名 积分 积分场次 (积分更新)
+    // 只放进内存缓冲并唤醒写线程，不碰磁盘；调用方持有 mtx
+    void appendJournal(char op, const Player& p) {
+        if(op == 'R') journalBuf += "R " + p.username + " " + p.password + " " + to_string(p.totalWins) + "\n";
+        else if(op == 'E') journalBuf += "E " + p.username + " " + to_string(p.rating) + " " + to_string(p.ratedGames) + "\n";
+        else journalBuf += "W " + p.username + " " + to_string(p.totalWins) + "\n";
+        appendedSeq++;
+        journalRecords++;
+        cv.notify_one();
+    }
+
+    // 把一批日志行写进文件 (只由写线程调用，不持 mtx)；sync 为 true 时写完再 fsync
+    void writeJournal(const string& lines, bool sync) {
+        TRACE_SCOPE("DataManager::writeJournal");
+        TRACE_COUNTER("DataManager::journalBatchBytes", lines.size());
+        lock_guard<mutex> lk(journalMtx);
+        if(!journal) journal = fopen(JOURNAL_FILE, "ab");
+        if(!journal) return;
+        if(!lines.empty()) fwrite(lines.data(), 1, lines.size(), journal);
+        fflush(journal); // 交给操作系统，进程被杀也不会丢
+        if(sync) syncFile(journal);
+    }
+
+    // 重放一个日志文件，返回文件是否存在
+    bool replayJournal(const char* path) {
+        ifstream file(path);
+        if(!file.is_open()) return false;
+        lock_guard<mutex> lk(mtx);
+        string op, u, p; int w, g;
+        while(file >> op >> u) {
+            if(op == "R" && file >> p >> w) {
+                if(players.find(u) < 0) addPlayer(u, p, w);
+            } else if(op == "W" && file >> w) {
+                int id = players.find(u);
+                if(id >= 0) {
+                    players.at(id).totalWins = w;
+                    if(boardReady) board.update(id, w);
+                }
+            } else if(op == "E" && file >> w >> g) {
+                int id = players.find(u);
+                if(id >= 0) {
+                    players.at(id).rating = w;
+                    players.at(id).ratedGames = g;
+                    if(ratingReady) ratings.update(id, w);
+                }
+            } else {
+                break; // 最后一行没写完 (写到一半时崩溃)，忽略
+            }
+        }
+        return true;
+    }
+
+    // 把当前日志轮换成旧日志，新的日志文件在下次写出时创建；调用方持有 mtx
+    // (还在 journalBuf 里的行会写进新日志；它们记录的是绝对值，与新快照重复也没关系)
+    void rotateJournal() {
+        lock_guard<mutex> lk(journalMtx);
+        if(journal) { fclose(journal); journal = nullptr; }
+        rotateFile(JOURNAL_FILE, ROTATED_JOURNAL_FILE);
+        journalRecords = 0;
+    }
+
+    // 把日志 from 轮换成 to：to 不存在时直接改名；to 还在 (上次压缩没有成功，里面的记录还没并入快照) 时
+    // 把 from 接到它后面，不能覆盖。重放时先 to 后 from，顺序不变
+    static void rotateFile(const char* from, const char* to) {
+        FILE* old = fopen(to, "rb");
+        if(!old) {
+            rename(from, to);
+            return;
+        }
+        fclose(old);
+        ifstream cur(from, ios::binary);
+        if(!cur.is_open()) return;
+        ofstream(to, ios::binary | ios::app) << cur.rdbuf();
+        cur.close();
+        remove(from);
+    }
+
+    // 把一批战绩日志行写进文件 (写线程或压缩时调用)
+    void writeHeroJournal(const string& lines, bool sync) {
+        lock_guard<mutex> lk(journalMtx);
+        if(!heroJournal && lines.empty()) return; // 没有要写的就不建文件
+        if(!heroJournal) {
+            heroJournal = fopen(HERO_JOURNAL_FILE, "ab");
+            if(!heroJournal) return;
+            fseek(heroJournal, 0, SEEK_END);
+            if(ftell(heroJournal) == 0) fprintf(heroJournal, "G %llu\n", (unsigned long long)heroJournalGen);
+        }
+        if(!lines.empty()) fwrite(lines.data(), 1, lines.size(), heroJournal);
+        fflush(heroJournal);
+        if(sync) syncFile(heroJournal);
+    }
+
+    // 轮换战绩日志，返回被轮换出去的那一代；上次压缩失败留下的旧日志还在时，
+    // 把当前日志接到它后面 (战绩日志是增量，不能覆盖)。调用方持有 mtx
+    uint64_t rotateHeroJournal() {
+        lock_guard<mutex> lk(journalMtx);
+        if(heroJournal) { fclose(heroJournal); heroJournal = nullptr; }
+        rotateFile(HERO_JOURNAL_FILE, ROTATED_HERO_JOURNAL_FILE);
+        heroJournalRecords = 0;
+        return heroJournalGen++;
+    }
+
+    static long modelOffset(int id) { return 8 + (long)id * sizeof(MoveModel); }
+
+    // 打开 (必要时新建) 模型文件；文件头不对时清空重建。调用方持有 modelMtx
+    // 早期版本的文件头是 "KOPM"，与对阵表 matchups.bin 相同；内容格式没变，长度对得上时就地改成新文件头
+    bool openModelFile() {
+        if(modelFile) return true;
+        char head[8], legacy[8];
+        memcpy(head, "KOPL", 4);
+        memcpy(head + 4, &MODEL_FILE_VERSION, 4);
+        memcpy(legacy, "KOPM", 4);
+        memcpy(legacy + 4, &MODEL_FILE_VERSION, 4);
+        modelFile = fopen(MODEL_FILE, "r+b");
+        char found[8] = {};
+        if(modelFile && fread(found, 8, 1, modelFile) == 1 && memcmp(found, legacy, 8) == 0) {
+            fseek(modelFile, 0, SEEK_END);
+            long size = ftell(modelFile);
+            if((size - 8) % (long)sizeof(MoveModel) == 0 && fseek(modelFile, 0, SEEK_SET) == 0
+               && fwrite(head, 8, 1, modelFile) == 1 && fflush(modelFile) == 0) memcpy(found, head, 8);
+        }
+        if(modelFile && memcmp(found, head, 8) != 0) {
+            fclose(modelFile);
+            modelFile = nullptr;
+        }
+        if(!modelFile) {
+            modelFile = fopen(MODEL_FILE, "w+b");
+            if(!modelFile) return false;
+            fwrite(head, 8, 1, modelFile);
+        }
+        return true;
+    }
+
+    // 把改过的模型写回各自的位置 (只由写线程调用，不持 mtx)；sync 为 true 时写完再 fsync
+    // 每条记录自带校验值，写到一半被打断的记录下次读出时当作空模型
+    void writeModels(vector<pair<int, MoveModel>>& changed, bool sync) {
+        if(changed.empty()) return;
+        lock_guard<mutex> lk(modelMtx);
+        if(!openModelFile()) return;
+        for(auto& c : changed) {
+            c.second.seal();
+            if(fseek(modelFile, modelOffset(c.first), SEEK_SET) == 0) fwrite(&c.second, sizeof(MoveModel), 1, modelFile);
+        }
+        fflush(modelFile);
+        if(sync) syncFile(modelFile);
+    }
+
+    // 后台写线程：有新日志就把攒下的全部写出 (写的过程中又来的修改留到下一批)，
+    // flush() 在等时顺带 fsync；日志攒够条数或者到了时间间隔就压缩一次；退出前写完剩余日志并压缩
+    void writerLoop() {
+        Trace::nameThread("DataManager::writer");
+        unique_lock<mutex> lk(mtx);
+        auto lastCompact = chrono::steady_clock::now();
+        for(;;) {
+            cv.wait_for(lk, chrono::seconds(COMPACT_INTERVAL_SEC), [this]{
+                return stopping || !journalBuf.empty() || !heroJournalBuf.empty() || !dirtyModels.empty()
+                       || syncWanted > syncedSeq || journalRecords >= COMPACT_THRESHOLD || heroJournalRecords >= COMPACT_THRESHOLD;
+            });
+            if(!journalBuf.empty() || !heroJournalBuf.empty() || !dirtyModels.empty() || syncWanted > syncedSeq || stopping) {
+                string lines, heroLines;
+                lines.swap(journalBuf);
+                heroLines.swap(heroJournalBuf);
+                vector<pair<int, MoveModel>> changedModels;
+                sort(dirtyModels.begin(), dirtyModels.end());
+                dirtyModels.erase(unique(dirtyModels.begin(), dirtyModels.end()), dirtyModels.end());
+                for(int id : dirtyModels) changedModels.emplace_back(id, models[id]);
+                dirtyModels.clear();
+                uint64_t seq = appendedSeq;
+                bool sync = syncWanted > syncedSeq || stopping;
+                lk.unlock();
+                writeJournal(lines, sync);
+                writeHeroJournal(heroLines, sync);
+                writeModels(changedModels, sync);
+                lk.lock();
+                if(sync) {
+                    syncedSeq = seq;
+                    synced.notify_all();
+                }
+            }
+            bool due = journalRecords >= COMPACT_THRESHOLD
+                       || (journalRecords > 0 && chrono::steady_clock::now() - lastCompact >= chrono::seconds(COMPACT_INTERVAL_SEC));
+            bool heroDue = heroJournalRecords >= COMPACT_THRESHOLD
+                           || (heroJournalRecords > 0 && chrono::steady_clock::now() - lastCompact >= chrono::seconds(COMPACT_INTERVAL_SEC));
+            if(due || heroDue || (stopping && (journalRecords > 0 || heroJournalRecords > 0))) {
+                bool players = journalRecords > 0, heroStats = heroJournalRecords > 0;
+                lk.unlock();
+                if(players) savePlayers();
+                if(heroStats) saveHeroLedger();
+                lk.lock();
+                lastCompact = chrono::steady_clock::now();
+            }
+            if(stopping) break;
+        }
+        lock_guard<mutex> jl(journalMtx);
+        if(journal) { fclose(journal); journal = nullptr; }
+        if(heroJournal) { fclose(heroJournal); heroJournal = nullptr; }
+        lock_guard<mutex> ml(modelMtx);
+        if(modelFile) { fclose(modelFile); modelFile = nullptr; }
     }
 };
 
@@ -0,0 +1,533 @@
+/**
+ * 文件名: game_server.h
+ * 描述: 无界面对战服务器 - 同一个进程同时托管成千上万局互相独立的比赛，每局就是一个 BattleEngine。
+ * 结构: 少量工作线程，每个线程跑自己的 poll 事件循环，都监听同一个端口，谁先 accept 到连接就归谁；
+ *       一个连接 (以及它上面的所有对局) 从头到尾只由一个线程处理，对局、求解器、回合统计分片都是线程私有的，英雄表只读共享，
+ *       处理请求时不需要任何锁。协议见 protocol.h。
+ * 时限: 每局每回合有出招时限 (比界面的倒计时多留一点网络延迟)，每个工作线程用一个分层时间轮 (timer_wheel.h)
+ *       管理自己所有对局的截止时刻，到期由服务器随机代出，与界面超时的处理相同。
+ * 积分赛: 开了 Config::rated 时，服务器在当前目录打开玩家数据 (DataManager)，玩家排进匹配队列 (matchmaking.h)，
+ *       0 号工作线程每 RATED_TICK_MS 配一次对；配上的两名玩家同时出招，双方都出了才结算，打完按 Elo 结算积分。
+ *       排队的两名玩家可能在不同的工作线程上，所以匹配队列和积分赛由所有线程共用，用一把锁保护；
+ *       积分赛的出招时限也在配对时一并检查 (到期替没出招的一方随机代出)。
+ */
+#ifndef GAME_SERVER_H
+#define GAME_SERVER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <unordered_map>
+#include <mutex>
+#include "net.h"
+#include "protocol.h"
+#include "trace.h"
+#include "timer_wheel.h"
+
+class GameServer {
+public:
+    struct Config {
+        string host = "127.0.0.1";
+        int port = DEFAULT_SERVER_PORT;  // 0 表示由系统分配 (测试用)，实际端口见 port()
+        int threads = max(1, (int)thread::hardware_concurrency());
+        size_t maxMatchesPerConnection = 100000;
+        int turnTimeoutMs = TURN_TIME_LIMIT * 1000 + 2000; // 出招时限：界面先超时并请求代出，服务器兜底；0 表示不限时
+        uint64_t seed = 0;               // 主种子：各工作线程按线程编号从它派生自己的随机数流；0 表示每次启动取新种子
+        bool rated = false;              // 开积分赛：在当前目录打开玩家数据 (users.dat 等)，排队的玩家按积分配对对战
+    };
+
+    // 运行统计 (各工作线程累加，随时可读)
+    atomic<long long> requests{0};       // 处理的请求数
+    atomic<long long> moves{0};          // 其中的出招请求数
+    atomic<long long> matchesStarted{0};
+    atomic<long long> matchesActive{0};
+    atomic<long long> connections{0};    // 当前连接数
+    atomic<long long> turnTimeouts{0};   // 超过出招时限由服务器代出的回合数
+    atomic<long long> ratedQueued{0};    // 积分赛排队人数
+    atomic<long long> ratedStarted{0};   // 配成的积分赛局数
+    atomic<long long> ratedFinished{0};  // 打完并结算了积分的局数
+
+    ~GameServer() { stop(); }
+
+    // 监听端口并启动工作线程，端口被占用等情况返回 false
+    bool start(const Config& c) {
+        netInit();
+        config = c;
+        listenFd = netListen(c.host, c.port);
+        if(listenFd == INVALID_SOCK) return false;
+        netSetNonBlocking(listenFd);
+        boundPort = netLocalPort(listenFd);
+        stopping = false;
+        roster = DataManager::loadHeroRoster(); // 只读一次，所有线程共用 (回合统计不写在英雄表上)
+        stats.reset(new HeroStats(roster.size()));
+        uint64_t master = c.seed ? c.seed : GameRng::freshSeed();
+        if(c.rated) {
+            accounts.reset(new DataManager);
+            ratedStats = stats->addShard();
+            ratedSeeder.seed(master, c.threads); // 紧接在各工作线程的流之后
+        }
+        for(int i=0; i<c.threads; ++i) {
+            workers.emplace_back(new Worker(master, i, stats->addShard()));
+            Worker* w = workers.back().get();
+            w->th = thread(&GameServer::runWorker, this, w);
+        }
+        return true;
+    }
+
+    int port() const { return boundPort; }
+
+    // 各工作线程回合统计的汇总，随时可调用 (不会让工作线程等待)
+    StatsSnapshot heroStats() const { return stats ? stats->snapshot() : StatsSnapshot(); }
+
+    const vector<Hero>& heroes() const { return roster; }
+
+    // 积分赛用的玩家数据 (没开积分赛时为空)：玩家编号就是积分赛请求里的编号
+    DataManager* players() { return accounts.get(); }
+
+    // 停止所有工作线程并断开全部连接
+    void stop() {
+        if(workers.empty()) return;
+        stopping = true;
+        for(auto& w : workers) w->th.join();
+        workers.clear();
+        netClose(listenFd);
+        listenFd = INVALID_SOCK;
+        queue = MatchmakingQueue();
+        queued.clear();
+        ratedOf.clear();
+        rated.clear();
+        accounts.reset(); // 写完日志、压缩玩家数据
+    }
+
+private:
+    // 一局：引擎和本回合出招时限的定时器 (时间轮回调凭指针找回对局，对局释放前先取消定时器)
+    struct Match {
+        BattleEngine engine;
+        TimerWheel::Id turnDeadline = 0;
+        Match(vector<Hero>& roster, uint64_t seed) : engine(roster, seed) {}
+    };
+
+    struct Connection {
+        socket_t fd;
+        string in;                 // 收到但还没处理完的字节
+        string out;                // 待发送的应答
+        size_t outPos = 0;
+        unordered_map<uint32_t, unique_ptr<Match>> matches;
+        uint32_t nextMatchId = 1;
+        vector<int> ratedPlayers;  // 在这个连接上排过积分赛的玩家 (断开时还在排队的取消掉)
+        bool closed = false;
+    };
+
+    // 一局积分赛：players[0] 坐引擎的“我方”，players[1] 坐“电脑”一方，它的出招写进 script 由引擎照录执行
+    struct RatedMatch {
+        BattleEngine engine;
+        int players[2];
+        MoveType pending[2] = { NONE, NONE }; // 本回合双方已经提交的招
+        uint8_t script[MAX_ROUNDS] = {};
+        uint64_t roundStartMs = 0;
+        bool seen[2] = { false, false };      // 打完后双方是否都已经拿到最终结果
+        RatedMatch(vector<Hero>& roster, uint64_t seed) : engine(roster, seed) {}
+    };
+
+    // 排队中的玩家：阵容，以及在哪个连接上排的队
+    struct QueuedPlayer {
+        vector<int> lineup;
+        const Connection* conn;
+    };
+
+    // 每个线程私有：回合统计分片、求解器 (置换表在本线程的所有对局间共享)、出招时限的时间轮、连接
+    struct Worker {
+        thread th;
+        HeroStats::Shard* stats;
+        GameSolver solver;
+        GameRng seeder;            // 给新对局的引擎播种：主种子下编号为线程编号的流
+        TimerWheel deadlines;
+        vector<unique_ptr<Connection>> conns;
+        int index;
+        Worker(uint64_t masterSeed, int i, HeroStats::Shard* shard) : stats(shard), seeder(masterSeed, i), index(i) {}
+    };
+
+    static const size_t MAX_PENDING_OUT = 1 << 20; // 对端不读应答时，积压到这么多字节就暂停读取它的请求
+    static const uint64_t RATED_TICK_MS = 100;      // 积分赛配对、检查出招时限的间隔
+    static const uint64_t RATED_LINGER_MS = 60000;  // 打完的积分赛最多留这么久，等双方来取最终结果
+
+    Config config;
+    socket_t listenFd = INVALID_SOCK;
+    int boundPort = 0;
+    atomic<bool> stopping{false};
+    vector<unique_ptr<Worker>> workers;
+    vector<Hero> roster;               // 英雄表，工作线程只读
+    unique_ptr<HeroStats> stats;
+
+    // 积分赛 (以下全部由 ratedMtx 保护)
+    mutex ratedMtx;
+    unique_ptr<DataManager> accounts;
+    MatchmakingQueue queue;
+    unordered_map<int, QueuedPlayer> queued;
+    unordered_map<int, shared_ptr<RatedMatch>> ratedOf; // 玩家 -> 他正在打 (或打完还没取结果) 的积分赛
+    vector<shared_ptr<RatedMatch>> rated;
+    HeroStats::Shard* ratedStats = nullptr;             // 积分赛的回合统计 (持锁写入，同一时刻只有一个线程写)
+    GameRng ratedSeeder;
+    uint64_t lastRatedTickMs = 0;
+
+    void runWorker(Worker* w) {
+        Trace::nameThread("GameServer::worker");
+        vector<pollfd_t> fds;
+        char buf[64 * 1024];
+        while(!stopping) {
+            fds.clear();
+            fds.push_back({ listenFd, POLLIN, 0 });
+            for(auto& c : w->conns) {
+                short ev = 0;
+                if(c->out.size() - c->outPos < MAX_PENDING_OUT) ev |= POLLIN;
+                if(c->outPos < c->out.size()) ev |= POLLOUT;
+                fds.push_back({ c->fd, ev, 0 });
+            }
+            // 最多等到下一个出招时限到期；另外至少每 100 毫秒醒一次，检查 stopping
+            int64_t wait = w->deadlines.nextTimeoutMs();
+            int timeout = wait < 0 || wait > 100 ? 100 : (int)wait;
+            if(netPoll(fds.data(), fds.size(), timeout) > 0) {
+                size_t existing = w->conns.size();
+                for(size_t i=0; i<existing; ++i) {
+                    Connection& c = *w->conns[i];
+                    short rev = fds[i + 1].revents;
+                    if(rev & (POLLIN | POLLHUP | POLLERR)) readConnection(*w, c, buf, sizeof(buf));
+                    if(!c.closed && c.outPos < c.out.size()) writeConnection(c);
+                }
+                if(fds[0].revents & POLLIN) acceptConnections(*w);
+            }
+
+            w->deadlines.advance(TimerWheel::clockMs(), [&](uint64_t p) { turnExpired(*w, *(Match*)(uintptr_t)p); });
+            if(accounts && w->index == 0) ratedTick();
+
+            // 移除已断开的连接，它上面没打完的对局一并释放
+            for(size_t i=0; i<w->conns.size(); ) {
+                if(w->conns[i]->closed) {
+                    cancelQueued(*w->conns[i]);
+                    matchesActive -= w->conns[i]->matches.size();
+                    for(auto& m : w->conns[i]->matches) w->deadlines.cancel(m.second->turnDeadline);
+                    netClose(w->conns[i]->fd);
+                    w->conns[i] = move(w->conns.back());
+                    w->conns.pop_back();
+                    connections--;
+                } else {
+                    ++i;
+                }
+            }
+        }
+        for(auto& c : w->conns) { cancelQueued(*c); matchesActive -= c->matches.size(); netClose(c->fd); connections--; }
+        w->conns.clear();
+    }
+
+    // 所有线程都在等同一个监听端口，被别的线程抢先 accept 时这里直接拿到“暂无连接”
+    void acceptConnections(Worker& w) {
+        for(;;) {
+            socket_t s = accept(listenFd, nullptr, nullptr);
+            if(s == INVALID_SOCK) return;
+            netSetNonBlocking(s);
+            netSetNoDelay(s);
+            unique_ptr<Connection> c(new Connection);
+            c->fd = s;
+            w.conns.push_back(move(c));
+            connections++;
+        }
+    }
+
+    void readConnection(Worker& w, Connection& c, char* buf, size_t cap) {
+        for(;;) {
+            int n = recv(c.fd, buf, (int)cap, 0);
+            if(n > 0) { c.in.append(buf, n); continue; }
+            if(n < 0 && netWouldBlock()) break;
+            c.closed = true; // 对端关闭或出错
+            return;
+        }
+        // 逐个处理完整的请求帧，不完整的尾巴留到下次
+        size_t pos = 0;
+        while(c.in.size() - pos >= sizeof(Request)) {
+            Request q;
+            memcpy(&q, c.in.data() + pos, sizeof(q));
+            pos += sizeof(q);
+            Reply r = handle(w, c, q);
+            c.out.append((const char*)&r, sizeof(r));
+        }
+        c.in.erase(0, pos);
+    }
+
+    void writeConnection(Connection& c) {
+        while(c.outPos < c.out.size()) {
+            int n = send(c.fd, c.out.data() + c.outPos, (int)(c.out.size() - c.outPos), 0);
+            if(n > 0) { c.outPos += n; continue; }
+            if(n < 0 && netWouldBlock()) return;
+            c.closed = true;
+            return;
+        }
+        c.out.clear();
+        c.outPos = 0;
+    }
+
+    Reply handle(Worker& w, Connection& c, const Request& q) {
+        TRACE_SCOPE("GameServer::handle");
+        requests++;
+        Reply r = {};
+        r.type = q.type;
+        r.tag = q.tag;
+        r.matchId = q.matchId;
+        r.cpuSlot = -1;
+
+        if(q.type >= REQ_RATED_QUEUE && q.type <= REQ_RATED_MOVE) return handleRated(c, q, r);
+
+        if(q.type == REQ_NEW_MATCH) {
+            vector<int> mine(q.heroes, q.heroes + TEAM_SIZE);
+            if(c.matches.size() >= config.maxMatchesPerConnection || !validLineup(mine)) { r.status = REPLY_BAD_REQUEST; return r; }
+
+            r.matchId = c.nextMatchId++;
+            unique_ptr<Match> m(new Match(roster, w.seeder.next64()));
+            BattleEngine& e = m->engine;
+            e.solver = (q.flags & REQ_FLAG_SOLVER) ? &w.solver : nullptr;
+            e.stats = w.stats;
+            e.startNewGame(mine);
+            e.prepareRound();
+            fillReply(r, e);
+            if(!r.over()) armTurn(w, *m);
+            c.matches[r.matchId] = move(m);
+            matchesStarted++;
+            matchesActive++;
+            return r;
+        }
+
+        auto it = c.matches.find(q.matchId);
+        if(it == c.matches.end()) {
+            r.status = (q.type == REQ_MOVE || q.type == REQ_END) ? REPLY_NO_MATCH : REPLY_BAD_REQUEST;
+            return r;
+        }
+        Match& match = *it->second;
+        BattleEngine& e = match.engine;
+
+        if(q.type == REQ_MOVE) {
+            moves++;
+            fillReply(r, e);
+            // 客户端要出的那一回合已经超时代出 (或者代出后对局已经打完)：把代出的结果告诉它
+            if(r.over() || (q.round != 0 && q.round != e.currentRound)) {
+                r.status = REPLY_ROUND_EXPIRED;
+                if(r.over()) { w.deadlines.cancel(match.turnDeadline); c.matches.erase(it); matchesActive--; }
+                return r;
+            }
+            bool timedOut = (q.flags & REQ_FLAG_TIMEOUT) != 0;
+            MoveType m = timedOut ? e.randomAvailableMove() : (MoveType)q.move;
+            if(m > PAPER || !e.canUse(m)) {
+                r.status = REPLY_ILLEGAL_MOVE;
+                return r;
+            }
+            w.deadlines.cancel(match.turnDeadline);
+            playTurn(e, m, timedOut);
+            fillReply(r, e);
+            if(r.over()) { c.matches.erase(it); matchesActive--; } // 打完自动释放
+            else armTurn(w, match);
+            return r;
+        }
+
+        if(q.type == REQ_END) {
+            fillReply(r, e);
+            r.cpuSlot = -1;
+            w.deadlines.cancel(match.turnDeadline);
+            c.matches.erase(it);
+            matchesActive--;
+            return r;
+        }
+
+        r.status = REPLY_BAD_REQUEST;
+        return r;
+    }
+
+    // 结算一回合并让电脑准备下一回合；电脑无牌可出时标记为结束
+    static void playTurn(BattleEngine& e, MoveType m, bool timedOut) {
+        if(e.playRound(m).round == 0) { // 无招可出 (超时代出也找不到招)，直接结束
+            e.currentCpuHeroIndex = -1;
+            return;
+        }
+        e.rounds.back().timedOut = timedOut;
+        if(e.isOver() || !e.prepareRound()) e.currentCpuHeroIndex = -1;
+    }
+
+    bool validLineup(const vector<int>& mine) const {
+        for(int i=0; i<TEAM_SIZE; ++i) {
+            if(mine[i] >= (int)roster.size()) return false;
+            for(int j=0; j<i; ++j) if(mine[i] == mine[j]) return false;
+        }
+        return true;
+    }
+
+    // 积分赛请求：matchId 是玩家编号
+    Reply handleRated(Connection& c, const Request& q, Reply& r) {
+        if(!accounts) { r.status = REPLY_BAD_REQUEST; return r; }
+        int player = (int)q.matchId;
+        lock_guard<mutex> lk(ratedMtx);
+        if(q.matchId >= (uint32_t)accounts->playerCount()) { r.status = REPLY_BAD_REQUEST; return r; }
+        auto it = ratedOf.find(player);
+
+        if(q.type == REQ_RATED_QUEUE) {
+            vector<int> mine(q.heroes, q.heroes + TEAM_SIZE);
+            if(it != ratedOf.end() || !validLineup(mine)
+               || !queue.enqueue(player, accounts->ratingOf(player), TimerWheel::clockMs())) {
+                r.status = REPLY_BAD_REQUEST; // 阵容不合法、已经在排队或者还有一局积分赛没打完
+                return r;
+            }
+            queued[player] = { mine, &c };
+            if(find(c.ratedPlayers.begin(), c.ratedPlayers.end(), player) == c.ratedPlayers.end()) c.ratedPlayers.push_back(player);
+            ratedQueued = queue.size();
+            r.status = REPLY_QUEUED;
+            return r;
+        }
+        if(q.type == REQ_RATED_CANCEL) {
+            if(!queue.cancel(player)) { r.status = REPLY_NO_MATCH; return r; }
+            queued.erase(player);
+            ratedQueued = queue.size();
+            return r;
+        }
+        if(it == ratedOf.end()) {
+            r.status = queue.contains(player) ? REPLY_QUEUED : REPLY_NO_MATCH;
+            return r;
+        }
+
+        RatedMatch& m = *it->second;
+        BattleEngine& e = m.engine;
+        int seat = m.players[0] == player ? 0 : 1;
+        if(q.type == REQ_RATED_MOVE) {
+            if(e.isOver() || (q.round != 0 && q.round != e.currentRound)) {
+                r.status = REPLY_ROUND_EXPIRED; // 那一回合已经超时代出 (应答是现在的状态)
+            } else {
+                MoveType mv = (MoveType)q.move;
+                if(m.pending[seat] != NONE || mv > PAPER || BattleEngine::findHeroWithMove(seat ? e.cpuMoves : e.myMoves, mv) < 0) {
+                    fillRatedReply(r, m, seat);
+                    r.status = REPLY_ILLEGAL_MOVE;
+                    return r;
+                }
+                m.pending[seat] = mv;
+                if(m.pending[1 - seat] == NONE) {
+                    fillRatedReply(r, m, seat);
+                    r.status = REPLY_WAITING;
+                    return r;
+                }
+                settleRated(m);
+            }
+        }
+        fillRatedReply(r, m, seat);
+        if(e.isOver()) { // 最终结果已经交给这名玩家，他可以再排队了
+            m.seen[seat] = true;
+            ratedOf.erase(it);
+        }
+        return r;
+    }
+
+    // 积分赛的应答：按 seat 一方的视角填写 (坐“电脑”一方的玩家把双方对调)
+    static void fillRatedReply(Reply& r, const RatedMatch& m, int seat) {
+        const BattleEngine& e = m.engine;
+        fillReply(r, e);
+        r.cpuSlot = e.isOver() ? -1 : 0;
+        if(seat == 1) {
+            for(int i=0; i<TEAM_SIZE; ++i) {
+                r.myMoves[i] = e.cpuMoves[i];
+                r.cpuLineup[i] = (uint16_t)e.myHeroIndices[i];
+            }
+            swap(r.myScore, r.cpuScore);
+            swap(r.myHero, r.cpuHero);
+            swap(r.myMove, r.cpuMove);
+            if(r.outcome != OUTCOME_DRAW) r.outcome = (uint8_t)(OUTCOME_WIN + OUTCOME_LOSS - r.outcome);
+        }
+    }
+
+    // 双方都出了招：players[1] 由第一个有这一招的英雄出 (与 playRound(MoveType) 对我方的处理相同)；打完结算积分
+    void settleRated(RatedMatch& m) {
+        BattleEngine& e = m.engine;
+        int slot = BattleEngine::findHeroWithMove(e.cpuMoves, m.pending[1]);
+        m.script[e.currentRound - 1] = (uint8_t)(slot << 2 | m.pending[1]);
+        e.prepareRound();
+        e.playRound(m.pending[0]);
+        m.pending[0] = m.pending[1] = NONE;
+        m.roundStartMs = TimerWheel::clockMs();
+        if(e.isOver()) {
+            double scoreA = e.myScore > e.cpuScore ? 1.0 : e.myScore < e.cpuScore ? 0.0 : 0.5;
+            accounts->recordRatedMatch(m.players[0], m.players[1], scoreA);
+            ratedFinished++;
+        }
+    }
+
+    // 0 号工作线程定期调用：配对；给超过出招时限的回合代出；释放打完且双方都取过结果 (或等了太久) 的积分赛
+    void ratedTick() {
+        uint64_t now = TimerWheel::clockMs();
+        lock_guard<mutex> lk(ratedMtx);
+        if(now - lastRatedTickMs < RATED_TICK_MS) return;
+        lastRatedTickMs = now;
+
+        for(const MatchPair& p : queue.matchAll(now)) {
+            shared_ptr<RatedMatch> m(new RatedMatch(roster, ratedSeeder.next64()));
+            m->players[0] = p.a;
+            m->players[1] = p.b;
+            m->engine.stats = ratedStats;
+            m->engine.cpuScript = m->script;
+            m->engine.startNewGame(queued[p.a].lineup, queued[p.b].lineup);
+            m->roundStartMs = now;
+            queued.erase(p.a);
+            queued.erase(p.b);
+            ratedOf[p.a] = ratedOf[p.b] = m;
+            rated.push_back(move(m));
+            ratedStarted++;
+        }
+        ratedQueued = queue.size();
+
+        for(size_t i=0; i<rated.size(); ) {
+            RatedMatch& m = *rated[i];
+            BattleEngine& e = m.engine;
+            if(!e.isOver() && config.turnTimeoutMs > 0 && now - m.roundStartMs >= (uint64_t)config.turnTimeoutMs) {
+                for(int s=0; s<2; ++s) {
+                    if(m.pending[s] == NONE) m.pending[s] = BattleEngine::randomMoveOf(s ? e.cpuMoves : e.myMoves, e.rng);
+                }
+                settleRated(m);
+                turnTimeouts++;
+            }
+            if(e.isOver() && ((m.seen[0] && m.seen[1]) || now - m.roundStartMs >= RATED_LINGER_MS)) {
+                for(int s=0; s<2; ++s) {
+                    auto it = ratedOf.find(m.players[s]);
+                    if(it != ratedOf.end() && it->second == rated[i]) ratedOf.erase(it);
+                }
+                rated[i] = move(rated.back());
+                rated.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // 连接断开：它上面还在排队的玩家取消排队 (已经配上的积分赛照常进行，没人出招就按时限代出)
+    void cancelQueued(const Connection& c) {
+        if(!accounts || c.ratedPlayers.empty()) return;
+        lock_guard<mutex> lk(ratedMtx);
+        for(int p : c.ratedPlayers) {
+            auto it = queued.find(p);
+            if(it == queued.end() || it->second.conn != &c) continue;
+            queue.cancel(p);
+            queued.erase(it);
+        }
+        ratedQueued = queue.size();
+    }
+
+    // 新的一回合开始：设置出招时限
+    void armTurn(Worker& w, Match& m) {
+        if(config.turnTimeoutMs <= 0) return;
+        m.turnDeadline = w.deadlines.arm(TimerWheel::clockMs() + config.turnTimeoutMs, (uint64_t)(uintptr_t)&m);
+    }
+
+    // 出招时限到了：和界面超时一样随机代出。对局打完也先留着，等客户端下一次出招时把结果告诉它再释放
+    // (客户端一直不来的，随连接断开一起释放)
+    void turnExpired(Worker& w, Match& m) {
+        BattleEngine& e = m.engine;
+        m.turnDeadline = 0;
+        turnTimeouts++;
+        playTurn(e, e.randomAvailableMove(), true);
+        if(!e.isOver() && e.currentCpuHeroIndex >= 0) armTurn(w, m);
+    }
+};
+
+#endif
@@ -0,0 +1,260 @@
+/**
+ * 文件名: game_solver.h
+ * 描述: 博弈求解器 - 对 9 回合的“库存猜拳”求精确的均衡混合策略和博弈值。
+ * 注意: 每回合双方同时出招，是一个零和同时博弈。回合内的 3x3 矩阵博弈用
+ *       Shapley-Snow 定理枚举方阵子矩阵精确求解，整棵博弈树用置换表 (哈希表) 记忆化。
+ */
+#ifndef GAME_SOLVER_H
+#define GAME_SOLVER_H
+
+#include <cmath>
+#include <cstdint>
+#include "game_data.h"
+
+// ==========================================
+// 结构体: MatchState (对局状态)
+// 描述: 决定后续胜负的全部信息。
+//   哪个英雄出招不影响结算，玩家出招时系统会自动找有这一招的英雄，
+//   电脑也可以任选一个有这一招的英雄，所以只需记录每方三种招数的剩余总数。
+// ==========================================
+struct MatchState {
+    int my[3];      // 我方剩余的 剪刀/石头/布 总数
+    int cpu[3];     // 电脑剩余的 剪刀/石头/布 总数
+    int round;      // 当前回合 (1-9)
+    int scoreDiff;  // 我方得分 - 电脑得分
+
+    // 64 位编码：6 个数量各 6 位，回合 4 位，分差 6 位 (加 32 偏移)，共 46 位
+    // 回合从 1 开始，所以编码永远不为 0，0 可以用作哈希表的空槽标记
+    uint64_t encode() const {
+        uint64_t k = 0;
+        for(int i=0; i<3; ++i) k = k << 6 | (uint64_t)my[i];
+        for(int i=0; i<3; ++i) k = k << 6 | (uint64_t)cpu[i];
+        k = k << 4 | (uint64_t)round;
+        k = k << 6 | (uint64_t)(scoreDiff + 32);
+        return k;
+    }
+
+    static MatchState decode(uint64_t k) {
+        MatchState s;
+        s.scoreDiff = (int)(k & 63) - 32; k >>= 6;
+        s.round = (int)(k & 15); k >>= 4;
+        for(int i=2; i>=0; --i) { s.cpu[i] = (int)(k & 63); k >>= 6; }
+        for(int i=2; i>=0; --i) { s.my[i] = (int)(k & 63); k >>= 6; }
+        return s;
+    }
+};
+
+// 求解结果：博弈值 (我方视角，胜=1 平=0 负=-1 的期望) 以及双方的均衡混合策略
+struct SolveResult {
+    double value;
+    double myStrategy[3];  // 我方出 剪刀/石头/布 的概率
+    double cpuStrategy[3]; // 电脑出 剪刀/石头/布 的概率
+};
+
+// ==========================================
+// 类: TranspositionTable (置换表)
+// 描述: 开放寻址哈希表，键为 64 位状态编码，容量为 2 的幂，装填超过一半时翻倍
+// ==========================================
+class TranspositionTable {
+public:
+    long long hits = 0, misses = 0; // 查询命中 / 未命中次数
+
+    TranspositionTable(int capacityBits = 16) { resize(capacityBits); }
+
+    const SolveResult* find(uint64_t key) {
+        for(size_t i = slotOf(key); ; i = (i + 1) & mask) {
+            if(slots[i].key == key) { hits++; return &slots[i].result; }
+            if(slots[i].key == 0) { misses++; return nullptr; }
+        }
+    }
+
+    void insert(uint64_t key, const SolveResult& r) {
+        if((count + 1) * 2 > slots.size()) resize(bits + 1);
+        place(key, r);
+    }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+    double hitRate() const { return hits + misses ? (double)hits / (hits + misses) : 0.0; }
+
+    void clear() {
+        for(auto& e : slots) e.key = 0;
+        count = 0; hits = 0; misses = 0;
+    }
+
+private:
+    struct Entry { uint64_t key; SolveResult result; };
+    vector<Entry> slots;
+    size_t count = 0, mask = 0;
+    int bits = 0;
+
+    // Fibonacci 哈希：乘以黄金分割常数后取高位，相邻状态编码也能均匀散开
+    size_t slotOf(uint64_t key) const { return (size_t)((key * 0x9E3779B97F4A7C15ull) >> (64 - bits)); }
+
+    void place(uint64_t key, const SolveResult& r) {
+        size_t i = slotOf(key);
+        while(slots[i].key != 0 && slots[i].key != key) i = (i + 1) & mask;
+        if(slots[i].key == 0) count++;
+        slots[i].key = key;
+        slots[i].result = r;
+    }
+
+    void resize(int newBits) {
+        vector<Entry> old;
+        old.swap(slots);
+        bits = newBits;
+        slots.assign((size_t)1 << bits, Entry{0, {}});
+        mask = slots.size() - 1;
+        count = 0;
+        for(const auto& e : old) if(e.key != 0) place(e.key, e.result);
+    }
+};
+
+// ==========================================
+// 类: GameSolver (博弈求解器)
+// 描述: 对任意局面求博弈值与均衡策略，结果缓存在置换表中，跨对局复用
+// ==========================================
+class GameSolver {
+public:
+    TranspositionTable table;
+    long long nodes = 0; // 实际展开求解的局面数
+
+    SolveResult solve(const MatchState& s) {
+        if(isTerminal(s)) return terminalResult(s);
+        uint64_t key = s.encode();
+        if(const SolveResult* cached = table.find(key)) return *cached;
+
+        nodes++;
+        // 收集双方可出的招
+        int rows[3], cols[3], m = 0, n = 0;
+        for(int i=0; i<3; ++i) if(s.my[i] > 0) rows[m++] = i;
+        for(int j=0; j<3; ++j) if(s.cpu[j] > 0) cols[n++] = j;
+
+        // 收益矩阵：A[a][b] = 我方出 rows[a]、电脑出 cols[b] 之后的子局面价值
+        double A[3][3];
+        for(int a=0; a<m; ++a) {
+            for(int b=0; b<n; ++b) {
+                MatchState c = s;
+                c.my[rows[a]]--;
+                c.cpu[cols[b]]--;
+                c.round++;
+                int res = ClassicRules::outcome(rows[a], cols[b]); // 与引擎相同的胜负判定
+                c.scoreDiff += (res == OUTCOME_WIN) - (res == OUTCOME_LOSS);
+                A[a][b] = solve(c).value;
+            }
+        }
+
+        double x[3], y[3];
+        SolveResult r = {};
+        r.value = solveMatrixGame(A, m, n, x, y);
+        for(int a=0; a<m; ++a) r.myStrategy[rows[a]] = x[a];
+        for(int b=0; b<n; ++b) r.cpuStrategy[cols[b]] = y[b];
+        table.insert(key, r);
+        return r;
+    }
+
+    // 对局结束：打满 9 回合，或者任意一方无招可出
+    static bool isTerminal(const MatchState& s) {
+        return s.round > MAX_ROUNDS
+            || s.my[0] + s.my[1] + s.my[2] == 0
+            || s.cpu[0] + s.cpu[1] + s.cpu[2] == 0;
+    }
+
+    // 求解 m x n (m, n <= 3) 的零和矩阵博弈，行方最大化
+    // 返回博弈值，x / y 为行方 / 列方的最优混合策略
+    // Shapley-Snow 定理：一定存在一对极端最优策略，其支撑集对应某个非奇异的 k x k 子矩阵，
+    // 所以枚举所有方阵子矩阵，解“无差异”线性方程组，再验证是否互为最优应对即可
+    static double solveMatrixGame(const double A[3][3], int m, int n, double x[3], double y[3]) {
+        const double EPS = 1e-9;
+        for(int k=1; k<=min(m, n); ++k) {
+            for(int rs=0; rs<(1<<m); ++rs) {
+                if(popcount(rs) != k) continue;
+                for(int cs=0; cs<(1<<n); ++cs) {
+                    if(popcount(cs) != k) continue;
+                    int I[3], J[3];
+                    for(int a=0, t=0; a<m; ++a) if(rs >> a & 1) I[t++] = a;
+                    for(int b=0, t=0; b<n; ++b) if(cs >> b & 1) J[t++] = b;
+
+                    double xs[3], ys[3], v1, v2;
+                    if(!equalize(A, I, J, k, false, xs, v1)) continue;
+                    if(!equalize(A, I, J, k, true, ys, v2)) continue;
+                    if(fabs(v1 - v2) > EPS) continue;
+
+                    // 验证：行方策略对任意列都保证至少 v，列方策略对任意行都保证至多 v
+                    bool ok = true;
+                    for(int b=0; b<n && ok; ++b) {
+                        double sum = 0;
+                        for(int t=0; t<k; ++t) sum += xs[t] * A[I[t]][b];
+                        if(sum < v1 - EPS) ok = false;
+                    }
+                    for(int a=0; a<m && ok; ++a) {
+                        double sum = 0;
+                        for(int t=0; t<k; ++t) sum += ys[t] * A[a][J[t]];
+                        if(sum > v1 + EPS) ok = false;
+                    }
+                    if(!ok) continue;
+
+                    for(int a=0; a<m; ++a) x[a] = 0;
+                    for(int b=0; b<n; ++b) y[b] = 0;
+                    for(int t=0; t<k; ++t) { x[I[t]] = xs[t]; y[J[t]] = ys[t]; }
+                    return v1;
+                }
+            }
+        }
+        // 理论上不会到达 (极小极大定理保证均衡存在)，数值误差兜底：双方均匀出招
+        for(int a=0; a<m; ++a) x[a] = 1.0 / m;
+        for(int b=0; b<n; ++b) y[b] = 1.0 / n;
+        double v = 0;
+        for(int a=0; a<m; ++a) for(int b=0; b<n; ++b) v += A[a][b] / (m * n);
+        return v;
+    }
+
+private:
+    static int popcount(int v) { int c = 0; for(; v; v &= v - 1) c++; return c; }
+
+    // 在支撑集 I x J 上解无差异方程组：
+    //   行方 (forColumn=false): sum_t p_t * A[I[t]][J[u]] = v 对每个 u 成立，且 sum p = 1
+    //   列方 (forColumn=true):  sum_t p_t * A[I[u]][J[t]] = v 对每个 u 成立，且 sum p = 1
+    // 未知数为 p_0..p_{k-1} 和 v，用带主元选择的高斯消元求解；要求 p 全部非负
+    static bool equalize(const double A[3][3], const int I[3], const int J[3], int k,
+                         bool forColumn, double p[3], double& v) {
+        const double EPS = 1e-12;
+        int N = k + 1;
+        double M[4][5] = {};
+        for(int u=0; u<k; ++u) {
+            for(int t=0; t<k; ++t) M[u][t] = forColumn ? A[I[u]][J[t]] : A[I[t]][J[u]];
+            M[u][k] = -1; // -v
+            M[u][N] = 0;
+        }
+        for(int t=0; t<k; ++t) M[k][t] = 1;
+        M[k][k] = 0;
+        M[k][N] = 1;
+
+        for(int col=0; col<N; ++col) {
+            int piv = col;
+            for(int r=col+1; r<N; ++r) if(fabs(M[r][col]) > fabs(M[piv][col])) piv = r;
+            if(fabs(M[piv][col]) < EPS) return false; // 奇异，跳过这个子矩阵
+            if(piv != col) for(int c=0; c<=N; ++c) swap(M[piv][c], M[col][c]);
+            for(int r=0; r<N; ++r) {
+                if(r == col) continue;
+                double f = M[r][col] / M[col][col];
+                for(int c=col; c<=N; ++c) M[r][c] -= f * M[col][c];
+            }
+        }
+        for(int t=0; t<k; ++t) {
+            p[t] = M[t][N] / M[t][t];
+            if(p[t] < -1e-9) return false;
+            if(p[t] < 0) p[t] = 0;
+        }
+        v = M[k][N] / M[k][k];
+        return true;
+    }
+
+    static SolveResult terminalResult(const MatchState& s) {
+        SolveResult r = {};
+        r.value = (s.scoreDiff > 0) - (s.scoreDiff < 0);
+        return r;
+    }
+};
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * 文件名: hero_index.h
+ * 描述: 英雄筛选索引 - 选人页边输入边筛选用。名单载入时为每个英雄预先算好小写名字和招数特征标签 (位掩码)，
+ *       每次按键只解析一次查询，之后对每个英雄只做几次整数比较和一次名字子串查找，几千个英雄也不会卡顿。
+ * 查询: 空格分隔的多个条件，全部满足才算匹配
+ *       特征:  rock-heavy / 石头型   scissors-heavy / 剪刀型   paper-heavy / 布型   balanced / 均衡
+ *              no-rock / 无石头     no-scissors / 无剪刀     no-paper / 无布
+ *       数量:  r>=3  s=0  p<2 (s/r/p 也可以写成 剪/石/布，运算符为 = > < >= <=)
+ *       其余的词按名字子串匹配，英文不区分大小写
+ * 注意: 纯逻辑头文件，不依赖 Qt。
+ */
+#ifndef HERO_INDEX_H
+#define HERO_INDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+#include <array>
+#include <sstream>
+#include <unordered_map>
+#include "game_data.h"
+
+using namespace std;
+
+// 招数特征标签：某种招占一半及以上为“X 型”，三种招数量相差不超过 1 为“均衡”
+enum HeroTag : uint16_t {
+    TAG_SCISSORS_HEAVY = 1 << 0, TAG_ROCK_HEAVY = 1 << 1, TAG_PAPER_HEAVY = 1 << 2, // 按 MoveType 排列
+    TAG_NO_SCISSORS = 1 << 3, TAG_NO_ROCK = 1 << 4, TAG_NO_PAPER = 1 << 5,
+    TAG_BALANCED = 1 << 6
+};
+
+// 解析好的查询条件
+struct HeroQuery {
+    enum Op { EQ, LT, GT, LE, GE };
+    struct Count { int move; Op op; int value; }; // 例如 r>=3 -> { ROCK, GE, 3 }
+
+    uint16_t tags = 0;     // 必须同时具有的特征
+    vector<Count> counts;
+    vector<string> names;  // 名字必须包含的片段 (已转小写)
+
+    bool empty() const { return tags == 0 && counts.empty() && names.empty(); }
+
+    static HeroQuery parse(const string& text) {
+        static const unordered_map<string, uint16_t> keywords = {
+            { "scissors-heavy", TAG_SCISSORS_HEAVY }, { "剪刀型", TAG_SCISSORS_HEAVY },
+            { "rock-heavy", TAG_ROCK_HEAVY },         { "石头型", TAG_ROCK_HEAVY },
+            { "paper-heavy", TAG_PAPER_HEAVY },       { "布型", TAG_PAPER_HEAVY },
+            { "no-scissors", TAG_NO_SCISSORS },       { "无剪刀", TAG_NO_SCISSORS },
+            { "no-rock", TAG_NO_ROCK },               { "无石头", TAG_NO_ROCK },
+            { "no-paper", TAG_NO_PAPER },             { "无布", TAG_NO_PAPER },
+            { "balanced", TAG_BALANCED },             { "均衡", TAG_BALANCED }
+        };
+        HeroQuery q;
+        istringstream in(text);
+        string word;
+        while(in >> word) {
+            word = fold(word);
+            auto it = keywords.find(word);
+            if(it != keywords.end()) { q.tags |= it->second; continue; }
+            Count c;
+            if(parseCount(word, c)) q.counts.push_back(c);
+            else q.names.push_back(word);
+        }
+        return q;
+    }
+
+    // ASCII 转小写，中文等多字节字符原样保留
+    static string fold(string s) {
+        for(char& ch : s) ch = (char)tolower((unsigned char)ch);
+        return s;
+    }
+
+private:
+    static bool parseCount(const string& w, Count& c) {
+        static const pair<const char*, int> moves[] = {
+            { "s", SCISSORS }, { "r", ROCK }, { "p", PAPER }, { "剪", SCISSORS }, { "石", ROCK }, { "布", PAPER }
+        };
+        for(const auto& m : moves) {
+            size_t n = strlen(m.first);
+            if(w.compare(0, n, m.first) != 0) continue;
+            size_t pos = n;
+            while(pos < w.size() && (w[pos] == '<' || w[pos] == '>' || w[pos] == '=')) pos++;
+            string op = w.substr(n, pos - n);
+            if(op == "=") c.op = EQ;
+            else if(op == "<") c.op = LT;
+            else if(op == ">") c.op = GT;
+            else if(op == "<=") c.op = LE;
+            else if(op == ">=") c.op = GE;
+            else return false;
+            if(pos == w.size() || w.find_first_not_of("0123456789", pos) != string::npos) return false;
+            c.move = m.second;
+            c.value = atoi(w.c_str() + pos);
+            return true;
+        }
+        return false;
+    }
+};
+
+// ==========================================
+// 类: HeroIndex (英雄筛选索引)
+// 描述: 按英雄在名单中的下标存放预先算好的筛选字段，名单变化后整体重建 (只是几个数组，与界面无关)
+// ==========================================
+class HeroIndex {
+public:
+    void build(const vector<Hero>& heroes) {
+        int n = heroes.size();
+        folded.resize(n);
+        counts.resize(n);
+        tags.resize(n);
+        for(int i=0; i<n; ++i) {
+            const Hero& h = heroes[i];
+            folded[i] = HeroQuery::fold(h.name);
+            counts[i] = { (uint8_t)h.s, (uint8_t)h.r, (uint8_t)h.p };
+            tags[i] = tagsOf(h.s, h.r, h.p);
+        }
+    }
+
+    int size() const { return folded.size(); }
+
+    bool matches(int id, const HeroQuery& q) const {
+        if((tags[id] & q.tags) != q.tags) return false;
+        for(const HeroQuery::Count& c : q.counts) {
+            int v = counts[id][c.move];
+            switch(c.op) {
+                case HeroQuery::EQ: if(v != c.value) return false; break;
+                case HeroQuery::LT: if(v >= c.value) return false; break;
+                case HeroQuery::GT: if(v <= c.value) return false; break;
+                case HeroQuery::LE: if(v > c.value) return false; break;
+                case HeroQuery::GE: if(v < c.value) return false; break;
+            }
+        }
+        for(const string& part : q.names) {
+            if(folded[id].find(part) == string::npos) return false;
+        }
+        return true;
+    }
+
+    // 全部匹配的英雄下标 (从小到大)
+    vector<int> filter(const HeroQuery& q) const {
+        vector<int> ids;
+        for(int i=0; i<size(); ++i) if(matches(i, q)) ids.push_back(i);
+        return ids;
+    }
+
+    static uint16_t tagsOf(int s, int r, int p) {
+        const int c[3] = { s, r, p };
+        int total = s + r + p;
+        uint16_t t = 0;
+        for(int m=SCISSORS; m<=PAPER; ++m) {
+            if(c[m] > 0 && c[m] * 2 >= total) t |= TAG_SCISSORS_HEAVY << m;
+            if(c[m] == 0) t |= TAG_NO_SCISSORS << m;
+        }
+        if(max({ s, r, p }) - min({ s, r, p }) <= 1) t |= TAG_BALANCED;
+        return t;
+    }
+
+private:
+    vector<string> folded;              // 小写名字
+    vector<array<uint8_t, 3>> counts;   // 三种招的初始数量，按 MoveType 排列
+    vector<uint16_t> tags;              // HeroTag 位掩码
+};
+
+#endif // HERO_INDEX_H
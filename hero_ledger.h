@@ -0,0 +1,362 @@
+/**
+ * 文件名: hero_ledger.h
+ * 描述: 英雄战绩账本 - 英雄、英雄对位 (甲对乙) 和出招的回合战绩，除累计总数外还有最近 24 小时、最近 7 天两个滚动窗口。
+ * 结构: 所有计数都放在“键 -> 战绩”的表里，键里编码了种类和英雄/招 (见 KIND_*)。
+ *       除了累计表，还有两个预先分好桶的环：24 个 1 小时桶、7 个 1 天桶 (按 UTC 对齐)，每个桶带着它代表的时段编号。
+ *       记一个回合只更新累计表和两个环中的当前桶；桶的时段过期了就先清空再用，不需要后台清理。
+ *       查询窗口只把落在窗口内的几个桶加起来，O(桶数)，不扫对战记录。
+ *       “最近 24 小时”是当前这一小时加上之前的 23 个整点小时，“最近 7 天”是今天加上之前的 6 天 (UTC)。
+ * 持久化: writeSnapshot / readSnapshot 读写二进制快照，appendJournal / replayJournal 读写文本日志；
+ *       DataManager 负责“快照 + 日志 + 定期压缩” (与 users.dat 相同)。快照和日志里英雄都按名字记，
+ *       英雄名单改动 (增删、换顺序) 后同名英雄的战绩照样对得上。
+ * 注意: 本类不加锁，由 DataManager 串行化访问；招数是 0 起的整数，与 MoveType 取值相同。
+ */
+#ifndef HERO_LEDGER_H
+#define HERO_LEDGER_H
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "mapped_file.h"
+#include "rules.h"
+
+using namespace std;
+
+const uint32_t HERO_LEDGER_VERSION = 1;
+
+// 文件布局: [文件头][名字表][范围 x scopeCount]，范围 = [LedgerScope][LedgerEntry x count]
+// 范围依次为: 累计、24 个小时桶、7 个天桶 (按环中的位置排列)
+struct HeroLedgerHeader {
+    char magic[4];          // "KOPH"
+    uint32_t version;       // HERO_LEDGER_VERSION
+    uint32_t heroCount;     // 名字表中的英雄数，快照里的英雄编号都是名字表的下标
+    uint32_t scopeCount;    // 1 + HOUR_BUCKETS + DAY_BUCKETS
+    uint64_t namesSize;     // 名字表字节数 (每个名字以 '\0' 结尾)
+    uint64_t generation;    // 已经并进快照的最后一代日志 (见 replayJournal)
+};
+
+struct LedgerScope {
+    int64_t stamp;          // 桶代表的时段编号 (毫秒时间 / 桶宽)，没用过的桶为 -1；累计为 0
+    uint64_t count;         // 条目数
+};
+
+struct LedgerEntry {
+    uint64_t key;
+    uint64_t rounds, wins, losses;
+};
+
+// 一组回合战绩
+struct HeroTally {
+    uint64_t rounds = 0, wins = 0, losses = 0;
+
+    uint64_t draws() const { return rounds - wins - losses; }
+    // 回合胜率 (百分比)，与 Hero::getWinRate 一致
+    double winRate() const { return rounds ? (double)wins / rounds * 100.0 : 0.0; }
+
+    void add(const HeroTally& t) { rounds += t.rounds; wins += t.wins; losses += t.losses; }
+};
+
+// ==========================================
+// 类: HeroLedger (英雄战绩账本)
+// 描述: recordRound 记一个回合；hero / versus / heroMove / moveRecord 按窗口查询
+// ==========================================
+class HeroLedger {
+public:
+    enum Window { ALL_TIME, LAST_DAY, LAST_WEEK };
+
+    static const int HOUR_BUCKETS = 24;
+    static const int DAY_BUCKETS = 7;
+    static const int64_t HOUR_MS = 3600 * 1000;
+    static const int64_t DAY_MS = 24 * HOUR_MS;
+
+    // 当前时间 (Unix 毫秒)
+    static long long nowMs() {
+        return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    explicit HeroLedger(const vector<string>& heroNames = vector<string>())
+        : names(heroNames), hours(HOUR_BUCKETS), days(DAY_BUCKETS) { reindex(); }
+
+    const vector<string>& heroNames() const { return names; }
+
+    // 英雄名在当前名单中的编号，没有返回 -1
+    int indexOf(const string& name) const {
+        auto it = nameIndex.find(name);
+        return it == nameIndex.end() ? -1 : it->second;
+    }
+
+    // 记一个回合：outcome 为我方的结算结果 (OUTCOME_*)，timeMs 为回合结算的时间
+    // 同一个英雄两边都出场时，它的出场回合记两次 (与 Hero::totalMatches 一致)，对位战绩不记
+    void recordRound(long long timeMs, int myHero, int cpuHero, int myMove, int cpuMove, int outcome) {
+        Counts* hour = bucketFor(hours, HOUR_MS, timeMs);
+        Counts* day = bucketFor(days, DAY_MS, timeMs);
+        auto add = [&](uint64_t key, bool won, bool lost) {
+            bump(total, key, won, lost);
+            if(hour) bump(*hour, key, won, lost);
+            if(day) bump(*day, key, won, lost);
+        };
+        bool won = outcome == OUTCOME_WIN, lost = outcome == OUTCOME_LOSS;
+        add(heroKey(myHero), won, lost);
+        add(heroKey(cpuHero), lost, won);
+        add(moveKey(myMove), won, lost);
+        add(moveKey(cpuMove), lost, won);
+        add(heroMoveKey(myHero, myMove), won, lost);
+        add(heroMoveKey(cpuHero, cpuMove), lost, won);
+        if(myHero < cpuHero) add(pairKey(myHero, cpuHero), won, lost);
+        else if(cpuHero < myHero) add(pairKey(cpuHero, myHero), lost, won);
+    }
+
+    // 英雄的回合战绩
+    HeroTally hero(int h, Window w, long long now = nowMs()) const { return tally(heroKey(h), w, now); }
+
+    // 英雄 a 对上英雄 b 的回合战绩 (a 的视角)
+    HeroTally versus(int a, int b, Window w, long long now = nowMs()) const {
+        if(a == b) return HeroTally();
+        if(a < b) return tally(pairKey(a, b), w, now);
+        HeroTally t = tally(pairKey(b, a), w, now);
+        swap(t.wins, t.losses);
+        return t;
+    }
+
+    // 英雄出某一招的战绩
+    HeroTally heroMove(int h, int m, Window w, long long now = nowMs()) const { return tally(heroMoveKey(h, m), w, now); }
+
+    // 某一招的战绩 (所有英雄合计，双方都算)
+    HeroTally moveRecord(int m, Window w, long long now = nowMs()) const { return tally(moveKey(m), w, now); }
+
+    // 英雄名单变了：按名字把战绩搬到新编号上，新名单里没有的英雄 (及其对位) 的战绩丢弃
+    void rename(const vector<string>& heroNames) {
+        unordered_map<string, int> at;
+        for(int i=0; i<(int)heroNames.size(); ++i) at.emplace(heroNames[i], i);
+        vector<int> to(names.size(), -1);
+        for(int i=0; i<(int)names.size(); ++i) {
+            auto it = at.find(names[i]);
+            if(it != at.end()) to[i] = it->second;
+        }
+        remap(total, to);
+        for(auto& b : hours) remap(b.counts, to);
+        for(auto& b : days) remap(b.counts, to);
+        names = heroNames;
+        reindex();
+    }
+
+    // 已经并进本账本的最后一代日志 (写快照时记下，读快照后用来跳过已并入的日志)
+    uint64_t generation() const { return gen; }
+    void setGeneration(uint64_t g) { gen = g; }
+
+    // 日志行: "H 时间 我方英雄名 电脑英雄名 我方招 电脑招 结果"；每个日志文件以 "G 代数" 开头
+    void appendJournal(string& out, long long timeMs, int myHero, int cpuHero, int myMove, int cpuMove, int outcome) const {
+        out += "H " + to_string(timeMs) + " " + names[myHero] + " " + names[cpuHero] + " "
+             + to_string(myMove) + " " + to_string(cpuMove) + " " + to_string(outcome) + "\n";
+    }
+
+    // 重放一个日志文件，返回重放的行数，文件不存在返回 -1；lastGen 带回文件中最后一段的代数。
+    // 代数不大于 generation() 的段已经在快照里了，跳过 (压缩写完快照、还没删掉旧日志时退出就会这样)。
+    // 英雄不在当前名单中的回合跳过
+    int replayJournal(const string& path, uint64_t* lastGen = nullptr) {
+        ifstream file(path);
+        if(!file.is_open()) return -1;
+        int n = 0;
+        uint64_t segment = gen + 1;
+        string line, op, my, cpu;
+        while(getline(file, line)) {
+            istringstream in(line);
+            long long t;
+            int mm, cm, res;
+            if(line.compare(0, 2, "G ") == 0 && in >> op >> segment) continue;
+            if(!(in >> op >> t >> my >> cpu >> mm >> cm >> res) || op != "H") break; // 最后一行没写完，忽略
+            if(segment <= gen) continue;
+            int a = indexOf(my), b = indexOf(cpu);
+            if(a >= 0 && b >= 0 && mm >= 0 && mm < 3 && cm >= 0 && cm < 3) recordRound(t, a, b, mm, cm, res);
+            n++;
+        }
+        if(lastGen) *lastGen = segment;
+        return n;
+    }
+
+    // 写快照：先写进内存，一次写出并落盘；失败时删掉写了一半的文件
+    bool writeSnapshot(const string& path) const {
+        string buf;
+        HeroLedgerHeader h = {};
+        memcpy(h.magic, "KOPH", 4);
+        h.version = HERO_LEDGER_VERSION;
+        h.heroCount = names.size();
+        h.scopeCount = 1 + HOUR_BUCKETS + DAY_BUCKETS;
+        for(const string& n : names) h.namesSize += n.size() + 1;
+        h.generation = gen;
+        buf.append((const char*)&h, sizeof(h));
+        for(const string& n : names) buf.append(n.c_str(), n.size() + 1);
+        appendScope(buf, 0, total);
+        for(const auto& b : hours) appendScope(buf, b.stamp, b.counts);
+        for(const auto& b : days) appendScope(buf, b.stamp, b.counts);
+
+        FILE* f = fopen(path.c_str(), "wb");
+        if(!f) return false;
+        bool ok = fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+        ok = ok && fflush(f) == 0 && syncFile(f);
+        ok = (fclose(f) == 0) && ok;
+        if(!ok) remove(path.c_str());
+        return ok;
+    }
+
+    // 读快照并按名字对到当前名单；文件不存在或格式不对返回 false，账本不变
+    bool readSnapshot(const string& path) {
+        MappedFile file;
+        if(!file.open(path) || file.size() < sizeof(HeroLedgerHeader)) return false;
+        const char* p = file.data();
+        const char* end = p + file.size();
+        HeroLedgerHeader h;
+        memcpy(&h, p, sizeof(h));
+        p += sizeof(h);
+        if(memcmp(h.magic, "KOPH", 4) != 0 || h.version != HERO_LEDGER_VERSION
+           || h.scopeCount != 1 + HOUR_BUCKETS + DAY_BUCKETS || h.namesSize > (uint64_t)(end - p)) return false;
+
+        vector<string> saved;
+        for(const char* n = p; n < p + h.namesSize; n += saved.back().size() + 1) saved.emplace_back(n, strnlen(n, p + h.namesSize - n));
+        if(saved.size() != h.heroCount) return false;
+        p += h.namesSize;
+
+        HeroLedger loaded(saved);
+        loaded.gen = h.generation;
+        const int SCOPES = 1 + HOUR_BUCKETS + DAY_BUCKETS;
+        for(int i=0; i<SCOPES; ++i) {
+            LedgerScope s;
+            if((size_t)(end - p) < sizeof(s)) return false;
+            memcpy(&s, p, sizeof(s));
+            p += sizeof(s);
+            if(s.count > (uint64_t)(end - p) / sizeof(LedgerEntry)) return false;
+            Bucket* b = i == 0 ? nullptr : i <= HOUR_BUCKETS ? &loaded.hours[i - 1] : &loaded.days[i - 1 - HOUR_BUCKETS];
+            Counts& c = b ? b->counts : loaded.total;
+            if(b) b->stamp = s.stamp;
+            c.reserve(s.count);
+            for(uint64_t k=0; k<s.count; ++k) {
+                LedgerEntry e;
+                memcpy(&e, p, sizeof(e));
+                p += sizeof(e);
+                HeroTally& t = c[e.key];
+                t.rounds = e.rounds; t.wins = e.wins; t.losses = e.losses;
+            }
+        }
+        loaded.rename(names);
+        *this = move(loaded);
+        return true;
+    }
+
+private:
+    // 键 = 种类 << 32 | 值
+    static const uint64_t KIND_HERO = 1;      // 值 = 英雄
+    static const uint64_t KIND_MOVE = 2;      // 值 = 招
+    static const uint64_t KIND_HERO_MOVE = 3; // 值 = 英雄 << 2 | 招
+    static const uint64_t KIND_PAIR = 4;      // 值 = 编号小的英雄 << 16 | 编号大的英雄 (英雄最多 65535 个)
+
+    typedef unordered_map<uint64_t, HeroTally> Counts;
+
+    struct Bucket {
+        int64_t stamp = -1;
+        Counts counts;
+    };
+
+    vector<string> names;
+    unordered_map<string, int> nameIndex;
+    uint64_t gen = 0;
+    Counts total;
+    vector<Bucket> hours, days;
+
+    static uint64_t heroKey(int h) { return KIND_HERO << 32 | (uint32_t)h; }
+    static uint64_t moveKey(int m) { return KIND_MOVE << 32 | (uint32_t)m; }
+    static uint64_t heroMoveKey(int h, int m) { return KIND_HERO_MOVE << 32 | (uint32_t)h << 2 | (uint32_t)m; }
+    static uint64_t pairKey(int a, int b) { return KIND_PAIR << 32 | (uint32_t)a << 16 | (uint32_t)b; }
+
+    void reindex() {
+        nameIndex.clear();
+        for(int i=0; i<(int)names.size(); ++i) nameIndex.emplace(names[i], i);
+    }
+
+    static void bump(Counts& c, uint64_t key, bool won, bool lost) {
+        HeroTally& t = c[key];
+        t.rounds++;
+        t.wins += won;
+        t.losses += lost;
+    }
+
+    static HeroTally find(const Counts& c, uint64_t key) {
+        auto it = c.find(key);
+        return it == c.end() ? HeroTally() : it->second;
+    }
+
+    // timeMs 所在时段在环里的桶：桶里是更早的时段就清空后改用；桶里已经是更晚的时段
+    // (时钟回拨，或者补记很久以前的回合) 说明这个时段早已滑出窗口，返回空，只计入累计
+    static Counts* bucketFor(vector<Bucket>& ring, int64_t width, long long timeMs) {
+        int64_t stamp = timeMs / width;
+        if(stamp < 0) return nullptr;
+        Bucket& b = ring[stamp % (int64_t)ring.size()];
+        if(b.stamp > stamp) return nullptr;
+        if(b.stamp < stamp) {
+            b.stamp = stamp;
+            b.counts.clear();
+        }
+        return &b.counts;
+    }
+
+    HeroTally tally(uint64_t key, Window w, long long now) const {
+        if(w == ALL_TIME) return find(total, key);
+        const vector<Bucket>& ring = w == LAST_DAY ? hours : days;
+        int64_t newest = now / (w == LAST_DAY ? HOUR_MS : DAY_MS);
+        int64_t oldest = newest - (int64_t)ring.size() + 1;
+        HeroTally t;
+        for(const Bucket& b : ring) {
+            if(b.stamp >= oldest && b.stamp <= newest) t.add(find(b.counts, key));
+        }
+        return t;
+    }
+
+    // 把表里的英雄编号按 to 换成新编号 (-1 表示丢弃)
+    static void remap(Counts& c, const vector<int>& to) {
+        Counts out;
+        out.reserve(c.size());
+        auto newIndex = [&](uint32_t h) { return h < to.size() ? to[h] : -1; };
+        for(const auto& kv : c) {
+            uint64_t kind = kv.first >> 32;
+            uint32_t v = (uint32_t)kv.first;
+            HeroTally t = kv.second;
+            uint64_t key;
+            if(kind == KIND_MOVE) {
+                key = kv.first;
+            } else if(kind == KIND_HERO) {
+                int h = newIndex(v);
+                if(h < 0) continue;
+                key = heroKey(h);
+            } else if(kind == KIND_HERO_MOVE) {
+                int h = newIndex(v >> 2);
+                if(h < 0) continue;
+                key = heroMoveKey(h, v & 3);
+            } else if(kind == KIND_PAIR) {
+                int a = newIndex(v >> 16), b = newIndex(v & 0xFFFF);
+                if(a < 0 || b < 0 || a == b) continue;
+                if(a > b) { swap(a, b); swap(t.wins, t.losses); }
+                key = pairKey(a, b);
+            } else {
+                continue;
+            }
+            out[key].add(t);
+        }
+        c.swap(out);
+    }
+
+    static void appendScope(string& buf, int64_t stamp, const Counts& c) {
+        LedgerScope s = { stamp, c.size() };
+        buf.append((const char*)&s, sizeof(s));
+        for(const auto& kv : c) {
+            LedgerEntry e = { kv.first, kv.second.rounds, kv.second.wins, kv.second.losses };
+            buf.append((const char*)&e, sizeof(e));
+        }
+    }
+};
+
+#endif
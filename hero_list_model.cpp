@@ -0,0 +1,84 @@
+/**
+ * 文件名: hero_list_model.cpp
+ * 描述: 英雄列表模型与筛选代理的实现。
+ */
+#include "hero_list_model.h"
+
+HeroListModel::HeroListModel(const vector<Hero>& heroes, const MatchupTable& matchups, QObject* parent)
+    : QAbstractListModel(parent), heroes(heroes), matchups(matchups) {
+    sync();
+}
+
+int HeroListModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : (int)rows.size();
+}
+
+QVariant HeroListModel::data(const QModelIndex& index, int role) const {
+    if(!index.isValid() || index.row() >= (int)rows.size()) return QVariant();
+    const Row& h = rows[index.row()];
+    if(role == Qt::DisplayRole) {
+        QString info = QString::fromStdString(h.name) + QString(" (剪%1/石%2/布%3)").arg(h.s).arg(h.r).arg(h.p);
+        // 对阵表可用时附上选取评分 (包含该英雄的阵容平均优势)
+        if(ratingsShown) info += QString(" 评分 %1").arg(matchups.heroRating(index.row()), 0, 'f', 3);
+        return info;
+    } else if(role == Qt::UserRole) {
+        return index.row(); // 行号就是英雄在名单中的下标
+    }
+    return QVariant();
+}
+
+void HeroListModel::sync() {
+    vector<Row> next;
+    next.reserve(heroes.size());
+    for(const Hero& h : heroes) next.push_back({ h.name, h.s, h.r, h.p });
+    bool ratings = matchups.isOpen();
+    int before = rows.size(), after = next.size(), common = min(before, after);
+
+    // 先换上新名单和新索引，再发增删信号 (代理模型收到插入信号时会立即用索引筛选新行)
+    vector<bool> changed(common);
+    for(int i=0; i<common; ++i) {
+        const Row& a = rows[i];
+        const Row& b = next[i];
+        changed[i] = ratings != ratingsShown || a.name != b.name || a.s != b.s || a.r != b.r || a.p != b.p;
+    }
+    if(after > before) {
+        beginInsertRows(QModelIndex(), before, after - 1);
+        rows.swap(next);
+        ratingsShown = ratings;
+        heroIndex.build(heroes);
+        endInsertRows();
+    } else if(after < before) {
+        beginRemoveRows(QModelIndex(), after, before - 1);
+        rows.swap(next);
+        ratingsShown = ratings;
+        heroIndex.build(heroes);
+        endRemoveRows();
+    } else {
+        rows.swap(next);
+        ratingsShown = ratings;
+        heroIndex.build(heroes);
+    }
+
+    // 连续变化的行合并成一次 dataChanged
+    for(int i=0; i<common; ) {
+        if(!changed[i]) { ++i; continue; }
+        int j = i;
+        while(j + 1 < common && changed[j + 1]) ++j;
+        emit dataChanged(index(i), index(j));
+        i = j + 1;
+    }
+}
+
+HeroFilterProxy::HeroFilterProxy(HeroListModel* source, QObject* parent) : QSortFilterProxyModel(parent), model(source) {
+    setSourceModel(source);
+}
+
+void HeroFilterProxy::setQuery(const QString& text) {
+    query = HeroQuery::parse(text.toStdString());
+    invalidateFilter();
+}
+
+bool HeroFilterProxy::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
+    if(sourceParent.isValid()) return false;
+    return query.empty() || model->filterIndex().matches(sourceRow, query);
+}
@@ -0,0 +1,58 @@
+/**
+ * 文件名: hero_list_model.h
+ * 描述: 选人页的英雄列表模型 - 给 QListView 用的 QAbstractListModel，外加一个按 HeroIndex 筛选的代理模型。
+ * 注意: 英雄名单重新载入后调用 sync()，模型只对比前后两份名单，对变化的行发 dataChanged、
+ *       对多出/少掉的行发插入/删除信号，视图不会整个重建；筛选时代理模型也只增删不再匹配/新匹配的行。
+ */
+#ifndef HERO_LIST_MODEL_H
+#define HERO_LIST_MODEL_H
+
+#include <QAbstractListModel>
+#include <QSortFilterProxyModel>
+#include <QString>
+#include "hero_index.h"
+#include "matchup_table.h"
+
+class HeroListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    // matchups 可用时在每行后面附上选取评分
+    HeroListModel(const vector<Hero>& heroes, const MatchupTable& matchups, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    // 英雄名单 (或对阵表) 变化后调用：与上次的名单逐行对比，只通知变化的部分
+    void sync();
+
+    const HeroIndex& filterIndex() const { return heroIndex; }
+
+private:
+    struct Row { string name; int s, r, p; };
+
+    const vector<Hero>& heroes;
+    const MatchupTable& matchups;
+    vector<Row> rows;           // 视图当前看到的名单 (只存显示用的字段，用来和新名单对比)
+    bool ratingsShown = false;  // 上次同步时对阵表是否可用
+    HeroIndex heroIndex;
+};
+
+// 按筛选框内容过滤英雄列表，查询语法见 hero_index.h
+class HeroFilterProxy : public QSortFilterProxyModel {
+    Q_OBJECT
+
+public:
+    explicit HeroFilterProxy(HeroListModel* source, QObject* parent = nullptr);
+
+    void setQuery(const QString& text);
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    HeroListModel* model;
+    HeroQuery query;
+};
+
+#endif // HERO_LIST_MODEL_H
@@ -0,0 +1,45 @@
+/**
+ * 文件名: hero_state.h
+ * 描述: 紧凑的英雄库存表示 - 把一个英雄的剪刀/石头/布剩余数量压缩进 2 个字节，
+ *       并提供不分配内存、不含分支的加权随机出招。
+ * 注意: 对战引擎的热路径只用这里的打包库存，Hero 类的对外行为保持不变。
+ */
+#ifndef HERO_STATE_H
+#define HERO_STATE_H
+
+#include <cstdint>
+#include "game_data.h"
+
+// 打包库存：每种招数占 4 位 (最多 15 个)，布局由经典规则的模板生成 (rules.h)
+//   bit 0-3: 剪刀   bit 4-7: 石头   bit 8-11: 布
+typedef ClassicRules::Layout MoveLayout;
+typedef MoveLayout::Packed PackedMoves;
+
+const int MOVE_BITS = MoveLayout::BITS;
+const int MOVE_MASK = MoveLayout::MASK;
+
+// 把 (剪刀, 石头, 布) 的数量打包
+inline PackedMoves packMoves(int s, int r, int p) {
+    const int counts[] = { s, r, p };
+    return MoveLayout::pack(counts);
+}
+
+// 打包英雄的初始库存
+inline PackedMoves packMoves(const Hero& h) { return packMoves(h.s, h.r, h.p); }
+
+// 取出某一招的剩余数量
+inline int movesCount(PackedMoves inv, MoveType m) { return MoveLayout::count(inv, m); }
+
+// 三种招数的剩余总数
+inline int movesTotal(PackedMoves inv) { return MoveLayout::total(inv); }
+
+// 扣除一招库存 (调用方保证该招数量 > 0)
+inline PackedMoves removeMove(PackedMoves inv, MoveType m) { return MoveLayout::remove(inv, m); }
+
+// 核心算法：加权随机出招，u 为一个 32 位均匀随机数
+// 把 u 映射到 [0, total) 得到 x，等价于在展开的 {剪.., 石.., 布..} 中取第 x 个：
+//   x < s 为剪刀，s <= x < s+r 为石头，其余为布
+// 两次比较的结果直接相加得到招数，全程没有分支和内存分配；库存为空时返回 NONE (实现见 PackedLayout::sample)
+inline MoveType sampleMove(PackedMoves inv, uint32_t u) { return (MoveType)MoveLayout::sample(inv, u); }
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * 文件名: hero_stats.h
+ * 描述: 回合统计 - 多个线程同时对局时，每个英雄的出战/获胜回合数和每种招的出招/获胜次数。
+ * 结构: 每个写线程一个分片 (HeroStats::Shard)，分片的计数器占满整条缓存行，不与其他线程共享缓存行；
+ *       写入只是“读本线程的计数器，加一，写回” (relaxed 原子读写，编译成普通的 load/store，没有加锁的读改写)。
+ *       读取时才把所有分片逐个加起来得到一份快照 (StatsSnapshot)：读的一方不加锁，写的一方永远不用等。
+ * 注意: 快照中每个计数器单独读取，不是所有计数器在同一瞬间的值；但每个值都不会倒退，也不会读到写了一半的数。
+ */
+#ifndef HERO_STATS_H
+#define HERO_STATS_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include "game_data.h"
+
+// 某一时刻的汇总统计
+struct StatsSnapshot {
+    vector<uint64_t> heroRounds;  // 每个英雄出战的回合数
+    vector<uint64_t> heroWins;    // 每个英雄获胜的回合数
+    uint64_t moveUsed[3] = {};    // 每种招被出的次数 (双方合计，按 MoveType 排列)
+    uint64_t moveWon[3] = {};     // 每种招赢下回合的次数
+    uint64_t rounds = 0;          // 总回合数
+
+    // 英雄回合胜率 (百分比)，与 Hero::getWinRate 一致
+    double winRate(int hero) const {
+        return heroRounds[hero] ? (double)heroWins[hero] / heroRounds[hero] * 100.0 : 0.0;
+    }
+};
+
+// ==========================================
+// 类: HeroStats (分片统计)
+// 描述: addShard 给每个写线程发一个分片；snapshot 随时可以从任意线程调用
+// ==========================================
+class HeroStats {
+public:
+    class Shard {
+    public:
+        // 记录一个回合：outcome 为 OUTCOME_* (我方视角，与 RoundResult 一致)
+        void recordRound(int myHero, int cpuHero, MoveType myMove, MoveType cpuMove, int outcome) {
+            bump(ROUNDS);
+            bump(MOVE_USED + myMove);
+            bump(MOVE_USED + cpuMove);
+            bump(HEROES + myHero * 2);
+            bump(HEROES + cpuHero * 2);
+            if(outcome == OUTCOME_WIN) {
+                bump(MOVE_WON + myMove);
+                bump(HEROES + myHero * 2 + 1);
+            } else if(outcome == OUTCOME_LOSS) {
+                bump(MOVE_WON + cpuMove);
+                bump(HEROES + cpuHero * 2 + 1);
+            }
+        }
+
+    private:
+        friend class HeroStats;
+
+        // 计数器编号：[总回合][出招 x3][赢招 x3][英雄 0 出战, 英雄 0 获胜, 英雄 1 出战, ...]
+        enum { ROUNDS = 0, MOVE_USED = 1, MOVE_WON = 4, HEROES = 7 };
+        static const int PER_LINE = 64 / sizeof(uint64_t);
+
+        struct alignas(64) Line { atomic<uint64_t> v[PER_LINE]; };
+
+        explicit Shard(int heroCount) : lineCount((HEROES + heroCount * 2 + PER_LINE - 1) / PER_LINE),
+                                        lines(new Line[lineCount]) {
+            for(int i=0; i<lineCount * PER_LINE; ++i) at(i).store(0, memory_order_relaxed);
+        }
+
+        atomic<uint64_t>& at(int i) const { return lines[i / PER_LINE].v[i % PER_LINE]; }
+
+        // 只有本线程写，不需要读改写指令；用原子读写只是为了让并发读取的快照线程读到完整的值
+        void bump(int i) {
+            atomic<uint64_t>& c = at(i);
+            c.store(c.load(memory_order_relaxed) + 1, memory_order_relaxed);
+        }
+
+        uint64_t read(int i) const { return at(i).load(memory_order_relaxed); }
+
+        int lineCount;
+        unique_ptr<Line[]> lines;
+    };
+
+    explicit HeroStats(int heroCount) : heroes(heroCount) {}
+
+    int heroCount() const { return heroes; }
+
+    // 为调用线程新建一个分片 (每个写线程调用一次，之后只由该线程写)；分片在 HeroStats 析构前一直有效
+    Shard* addShard() {
+        lock_guard<mutex> lk(mtx);
+        shards.emplace_back(new Shard(heroes));
+        return shards.back().get();
+    }
+
+    // 把所有分片加起来；只在读分片列表时短暂持锁 (与 addShard 互斥)，不影响正在写的线程
+    StatsSnapshot snapshot() const {
+        StatsSnapshot s;
+        s.heroRounds.assign(heroes, 0);
+        s.heroWins.assign(heroes, 0);
+        vector<const Shard*> list;
+        {
+            lock_guard<mutex> lk(mtx);
+            for(const auto& sh : shards) list.push_back(sh.get());
+        }
+        for(const Shard* sh : list) {
+            s.rounds += sh->read(Shard::ROUNDS);
+            for(int m=0; m<3; ++m) {
+                s.moveUsed[m] += sh->read(Shard::MOVE_USED + m);
+                s.moveWon[m] += sh->read(Shard::MOVE_WON + m);
+            }
+            for(int h=0; h<heroes; ++h) {
+                s.heroRounds[h] += sh->read(Shard::HEROES + h * 2);
+                s.heroWins[h] += sh->read(Shard::HEROES + h * 2 + 1);
+            }
+        }
+        return s;
+    }
+
+private:
+    int heroes;
+    mutable mutex mtx;                  // 只保护 shards 列表本身
+    vector<unique_ptr<Shard>> shards;
+};
+
+#endif // HERO_STATS_H
@@ -0,0 +1,485 @@
+/**
+ * 文件名: history_query.cpp
+ * 描述: 列式对战记录查询工具 - 在 history.kpc (见 history_store.h) 上做统计。文件整体内存映射，
+ *       按块分给各线程 (工作窃取) 扫描，每个查询只读它用到的几列；各线程自己累加，最后汇总。
+ * 用法: history_query [--file history.kpc] [--threads N] [--days N] <命令> ...
+ *       info                          文件概况 (块数、局数、回合数、时间范围)
+ *       lineups [--top N] [--min N]   阵容胜率 (双方阵容都算，阵容不分选人顺序)，至少 min 局的前 top 名
+ *       user <用户名>                  某个玩家每天的局数、胜率、平均比分和用时 (按 UTC 日期)
+ *       moves [--user 用户名]          出招分布：每回合三种招的比例、每种招的回合胜率、超时比例
+ *       import <gamedata.txt>         从文本记录重建列式记录 (覆盖 --file)，没有结构化字段的旧格式行跳过
+ *       generate <局数> [--users N] [--seed S]
+ *                                     用电脑对电脑的对局生成测试数据 (覆盖 --file)，时间均匀分布在最近 --days 天 (默认 30)
+ *       --days N 对统计命令表示只看最近 N 天 (整块早于此的直接跳过)
+ */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <climits>
+#include <map>
+#include <algorithm>
+#include "history_store.h"
+#include "match_history.h"
+#include "work_stealing.h"
+
+const long long DAY_MS = 86400000LL;
+
+struct QueryOptions {
+    string file = "history.kpc";
+    int threads = (int)thread::hardware_concurrency();
+    long long sinceMs = LLONG_MIN; // --days 换算成的起始时间
+    int days = 0;
+    int top = 20;
+    long long minGames = 100;
+    string user;
+    int users = 1000;
+    uint64_t seed = 0;
+};
+
+// 块内第一个不早于 sinceMs 的开局时间对应的相对秒数 (块内全部都不早于时为 0)
+static uint32_t cutoffSec(const HistoryBlock& b, long long sinceMs) {
+    if(sinceMs <= b.baseMs()) return 0;
+    return (uint32_t)min<long long>((sinceMs - b.baseMs() + 999) / 1000, UINT32_MAX);
+}
+
+// 按块并行扫描，body(worker, block)；时间上整块早于 sinceMs 的块不交给 body
+template <class Body>
+static void scanBlocks(const HistoryStore& store, const QueryOptions& opt, Body body) {
+    parallelForStealing(opt.threads, (uint32_t)store.blocks(), [&](int worker, uint32_t i) {
+        HistoryBlock b = store.block(i);
+        if(b.lastMs() >= opt.sinceMs) body(worker, b);
+    });
+}
+
+static string heroName(const vector<Hero>& roster, int id) {
+    return id < (int)roster.size() ? roster[id].name : "#" + to_string(id);
+}
+
+static string formatDay(long long day) {
+    time_t t = (time_t)(day * (DAY_MS / 1000));
+    char buf[16];
+    strftime(buf, sizeof(buf), "%Y-%m-%d", gmtime(&t));
+    return buf;
+}
+
+static double percent(long long part, long long whole) { return whole ? part * 100.0 / whole : 0.0; }
+
+// ========== info ==========
+static int cmdInfo(const HistoryStore& store, const QueryOptions& opt) {
+    long long first = LLONG_MAX, last = LLONG_MIN;
+    for(size_t i=0; i<store.blocks(); ++i) {
+        first = min(first, store.block(i).baseMs());
+        last = max(last, store.block(i).lastMs());
+    }
+    cout << opt.file << ": " << store.completeSize() << " 字节, " << store.blocks() << " 块, "
+         << store.totalMatches() << " 局, " << store.totalRounds() << " 回合" << endl;
+    if(store.blocks()) cout << "时间范围 " << formatDay(first / DAY_MS) << " ~ " << formatDay(last / DAY_MS) << " (UTC)" << endl;
+    return 0;
+}
+
+// ========== lineups ==========
+struct LineupTally { long long games = 0, wins = 0, draws = 0; };
+
+static int cmdLineups(const HistoryStore& store, const QueryOptions& opt, const vector<Hero>& roster) {
+    struct Worker {
+        unordered_map<uint64_t, LineupTally> tally; // 键：排好序的三个英雄下标
+        vector<uint32_t> games, wins, draws;        // 当前块按阵容字典编号计数
+    };
+    vector<Worker> workers(max(opt.threads, 1));
+
+    scanBlocks(store, opt, [&](int w, const HistoryBlock& b) {
+        Worker& k = workers[w];
+        k.games.assign(b.lineups(), 0);
+        k.wins.assign(b.lineups(), 0);
+        k.draws.assign(b.lineups(), 0);
+        const uint16_t* mine = b.myLineups();
+        const uint16_t* cpu = b.cpuLineups();
+        const uint8_t* score = b.scores();
+        const uint32_t* start = b.startSec();
+        uint32_t cut = cutoffSec(b, opt.sinceMs);
+        uint32_t n = b.matches();
+        // 没有分支：结果和时间过滤都折算成 0/1 累加
+        for(uint32_t i=0; i<n; ++i) {
+            uint32_t in = start[i] >= cut;
+            uint32_t my = score[i] >> 4, other = score[i] & 15;
+            uint32_t win = my > other, loss = my < other, draw = my == other;
+            k.games[mine[i]] += in; k.wins[mine[i]] += in & win;  k.draws[mine[i]] += in & draw;
+            k.games[cpu[i]] += in;  k.wins[cpu[i]] += in & loss;  k.draws[cpu[i]] += in & draw;
+        }
+        for(uint32_t c=0; c<b.lineups(); ++c) {
+            if(!k.games[c]) continue;
+            const uint16_t* h = b.lineup(c);
+            uint16_t s[TEAM_SIZE] = { h[0], h[1], h[2] };
+            sort(s, s + TEAM_SIZE);
+            LineupTally& t = k.tally[(uint64_t)s[0] << 32 | (uint64_t)s[1] << 16 | s[2]];
+            t.games += k.games[c]; t.wins += k.wins[c]; t.draws += k.draws[c];
+        }
+    });
+
+    unordered_map<uint64_t, LineupTally> total;
+    for(Worker& k : workers) {
+        for(auto& [key, t] : k.tally) {
+            LineupTally& s = total[key];
+            s.games += t.games; s.wins += t.wins; s.draws += t.draws;
+        }
+    }
+    vector<pair<uint64_t, LineupTally>> rows;
+    for(auto& e : total) if(e.second.games >= opt.minGames) rows.push_back(e);
+    sort(rows.begin(), rows.end(), [](const pair<uint64_t, LineupTally>& a, const pair<uint64_t, LineupTally>& b) {
+        return a.second.wins * b.second.games > b.second.wins * a.second.games; // 比较胜率，不做除法
+    });
+
+    cout << "共 " << total.size() << " 套阵容, 至少 " << opt.minGames << " 局的 " << rows.size() << " 套, 按胜率排序:" << endl;
+    cout << "阵容\t局数\t胜率\t平局率" << endl;
+    cout << fixed << setprecision(2);
+    for(size_t i=0; i<rows.size() && (int)i<opt.top; ++i) {
+        uint64_t key = rows[i].first;
+        const LineupTally& t = rows[i].second;
+        cout << heroName(roster, key >> 32) << "/" << heroName(roster, key >> 16 & 0xFFFF) << "/" << heroName(roster, key & 0xFFFF)
+             << "\t" << t.games << "\t" << percent(t.wins, t.games) << "%\t" << percent(t.draws, t.games) << "%" << endl;
+    }
+    return 0;
+}
+
+// ========== user ==========
+struct DayTally { long long games = 0, wins = 0, losses = 0, myScore = 0, cpuScore = 0, durationMs = 0; };
+
+static int cmdUser(const HistoryStore& store, const QueryOptions& opt) {
+    vector<map<long long, DayTally>> workers(max(opt.threads, 1));
+    scanBlocks(store, opt, [&](int w, const HistoryBlock& b) {
+        int code = b.findUser(opt.user);
+        if(code < 0) return; // 本块没有这个玩家：列数据一页都不用读
+        const uint16_t* users = b.userCodes();
+        const uint8_t* score = b.scores();
+        const uint32_t* start = b.startSec();
+        const uint32_t* duration = b.durationMs();
+        uint32_t cut = cutoffSec(b, opt.sinceMs);
+        DayTally* day = nullptr;
+        long long current = LLONG_MIN;
+        for(uint32_t i=0; i<b.matches(); ++i) {
+            if(users[i] != code || start[i] < cut) continue;
+            long long d = (b.baseMs() + start[i] * 1000LL) / DAY_MS;
+            if(d != current) { day = &workers[w][d]; current = d; } // 块内按时间顺序，很少换天
+            int my = score[i] >> 4, other = score[i] & 15;
+            day->games++;
+            day->wins += my > other;
+            day->losses += my < other;
+            day->myScore += my;
+            day->cpuScore += other;
+            day->durationMs += duration[i];
+        }
+    });
+
+    map<long long, DayTally> days;
+    for(auto& m : workers) {
+        for(auto& [d, t] : m) {
+            DayTally& s = days[d];
+            s.games += t.games; s.wins += t.wins; s.losses += t.losses;
+            s.myScore += t.myScore; s.cpuScore += t.cpuScore; s.durationMs += t.durationMs;
+        }
+    }
+    if(days.empty()) {
+        cout << "没有玩家 " << opt.user << " 的记录" << endl;
+        return 1;
+    }
+
+    DayTally all;
+    cout << "玩家 " << opt.user << " 每天的战绩 (UTC):" << endl;
+    cout << "日期\t\t局数\t胜率\t负率\t平均比分\t平均用时(秒)" << endl;
+    cout << fixed << setprecision(2);
+    for(auto& [d, t] : days) {
+        cout << formatDay(d) << "\t" << t.games << "\t" << percent(t.wins, t.games) << "%\t" << percent(t.losses, t.games) << "%\t"
+             << (double)t.myScore / t.games << ":" << (double)t.cpuScore / t.games << "\t"
+             << t.durationMs / 1000.0 / t.games << endl;
+        all.games += t.games; all.wins += t.wins; all.losses += t.losses;
+    }
+    cout << "合计 " << all.games << " 局, 胜率 " << percent(all.wins, all.games) << "%, 负率 " << percent(all.losses, all.games) << "%" << endl;
+
+    // 走势：前一半天数与后一半天数的胜率对比
+    if(days.size() >= 2) {
+        DayTally early, late;
+        size_t i = 0;
+        for(auto& [d, t] : days) {
+            DayTally& s = i++ < days.size() / 2 ? early : late;
+            s.games += t.games; s.wins += t.wins;
+        }
+        cout << "走势: 前 " << days.size() / 2 << " 天胜率 " << percent(early.wins, early.games) << "%, 后 "
+             << days.size() - days.size() / 2 << " 天胜率 " << percent(late.wins, late.games) << "%" << endl;
+    }
+    return 0;
+}
+
+// ========== moves ==========
+// 每回合的低 7 位 (双方的招、结果、超时) 作为直方图下标，按回合序号分开统计 (超出 MAX_ROUNDS 的并入最后一行)
+static const int ROUND_CODES = 128;
+
+static int cmdMoves(const HistoryStore& store, const QueryOptions& opt) {
+    vector<vector<uint64_t>> workers(max(opt.threads, 1), vector<uint64_t>(MAX_ROUNDS * ROUND_CODES, 0));
+    scanBlocks(store, opt, [&](int w, const HistoryBlock& b) {
+        int user = -1;
+        if(!opt.user.empty() && (user = b.findUser(opt.user)) < 0) return;
+        uint64_t* hist = workers[w].data();
+        const uint8_t* count = b.roundCounts();
+        const uint16_t* rounds = b.roundCodes();
+        const uint16_t* users = b.userCodes();
+        const uint32_t* start = b.startSec();
+        uint32_t cut = cutoffSec(b, opt.sinceMs);
+        bool everything = user < 0 && cut == 0;
+        uint32_t total = b.rounds(), off = 0;
+        for(uint32_t i=0; i<b.matches(); ++i) {
+            uint32_t n = count[i];
+            if(n > total - off) break; // 回合数列与块头对不上 (文件损坏)
+            if(everything || ((user < 0 || users[i] == user) && start[i] >= cut)) {
+                for(uint32_t k=0; k<n; ++k) hist[min<uint32_t>(k, MAX_ROUNDS - 1) * ROUND_CODES + (rounds[off + k] & (ROUND_CODES - 1))]++;
+            }
+            off += n;
+        }
+    });
+
+    vector<uint64_t> hist(MAX_ROUNDS * ROUND_CODES, 0);
+    for(auto& h : workers) for(size_t i=0; i<hist.size(); ++i) hist[i] += h[i];
+
+    // 汇总：used[回合][招] 我方出招次数，won / lost[招] 我方这招赢 / 输的回合数，cpuUsed[招] 电脑出招次数
+    long long used[MAX_ROUNDS][3] = {}, won[3] = {}, lost[3] = {}, cpuUsed[3] = {}, timedOut = 0, rounds = 0;
+    for(int r=0; r<MAX_ROUNDS; ++r) {
+        for(int c=0; c<ROUND_CODES; ++c) {
+            long long n = hist[r * ROUND_CODES + c];
+            if(!n) continue;
+            uint16_t code = (uint16_t)c;
+            int m = HistoryRound::myMove(code);
+            if(m > PAPER) continue;
+            used[r][m] += n;
+            if(HistoryRound::cpuMove(code) <= PAPER) cpuUsed[HistoryRound::cpuMove(code)] += n;
+            if(HistoryRound::outcome(code) == OUTCOME_WIN) won[m] += n;
+            if(HistoryRound::outcome(code) == OUTCOME_LOSS) lost[m] += n;
+            if(HistoryRound::timedOut(code)) timedOut += n;
+            rounds += n;
+        }
+    }
+    if(!rounds) {
+        cout << "没有符合条件的回合" << endl;
+        return 1;
+    }
+
+    cout << fixed << setprecision(2);
+    cout << "共 " << rounds << " 回合" << (opt.user.empty() ? "" : " (玩家 " + opt.user + ")") << ", 超时 " << percent(timedOut, rounds) << "%" << endl;
+    cout << "回合\t";
+    for(int m=SCISSORS; m<=PAPER; ++m) cout << moveToString((MoveType)m) << "\t";
+    cout << "回合数" << endl;
+    for(int r=0; r<MAX_ROUNDS; ++r) {
+        long long n = used[r][0] + used[r][1] + used[r][2];
+        if(!n) continue;
+        cout << r + 1 << "\t";
+        for(int m=SCISSORS; m<=PAPER; ++m) cout << percent(used[r][m], n) << "%\t";
+        cout << n << endl;
+    }
+    cout << "招数\t我方占比\t胜\t负\t电脑占比" << endl;
+    for(int m=SCISSORS; m<=PAPER; ++m) {
+        long long n = 0;
+        for(int r=0; r<MAX_ROUNDS; ++r) n += used[r][m];
+        cout << moveToString((MoveType)m) << "\t" << percent(n, rounds) << "%\t\t" << percent(won[m], n) << "%\t"
+             << percent(lost[m], n) << "%\t" << percent(cpuUsed[m], rounds) << "%" << endl;
+    }
+    return 0;
+}
+
+// ========== import ==========
+// 解析 gamedata.txt 的一行 (格式见 match_history.h)，旧格式或格式不对返回 false
+static bool parseGameLine(const char* p, const char* end, MatchRecord& r) {
+    static const char MOVES[] = "SRP", RESULTS[] = "DWL";
+    auto expect = [&](const char* s) {
+        size_t n = strlen(s);
+        if((size_t)(end - p) < n || memcmp(p, s, n) != 0) return false;
+        p += n;
+        return true;
+    };
+    auto number = [&](long long& v) {
+        char* e;
+        v = strtoll(p, &e, 10);
+        if(e == p || e > end) return false;
+        p = e;
+        return true;
+    };
+    auto lineup = [&](vector<int>& ids) {
+        ids.clear();
+        for(int i=0; i<TEAM_SIZE; ++i) {
+            long long v;
+            if((i && !expect(",")) || !number(v) || v < 0 || v > 0xFFFF) return false;
+            ids.push_back((int)v);
+        }
+        return true;
+    };
+    auto symbol = [&](const char* table, int& v) {
+        const char* s = p < end ? strchr(table, *p) : nullptr;
+        if(!s || !*p) return false;
+        v = s - table;
+        p++;
+        return true;
+    };
+
+    if(!expect("Game: ")) return false;
+    const char* name = p;
+    while(p < end && *p != ' ') p++;
+    r.username.assign(name, p);
+    long long my, cpu, t, d;
+    if(!expect(" ") || !number(my) || !expect(":") || !number(cpu) || !expect(" t=") || !number(t) || !expect(" d=") || !number(d)
+       || !expect(" my=") || !lineup(r.myLineup) || !expect(" cpu=") || !lineup(r.cpuLineup) || !expect(" rounds=")) return false;
+    r.myScore = (int)my; r.cpuScore = (int)cpu;
+    r.startMs = t; r.endMs = t + d;
+    r.rounds.clear();
+    while(p < end && *p != '\r' && *p != '\n') {
+        RoundResult x;
+        long long mh, ch, think;
+        int mm, cm, res;
+        if((!r.rounds.empty() && !expect(";")) || !number(mh) || !expect(":") || !symbol(MOVES, mm) || !expect("-")
+           || !number(ch) || !expect(":") || !symbol(MOVES, cm) || !expect(":") || !symbol(RESULTS, res)
+           || !expect(":") || !number(think)) return false;
+        x.round = r.rounds.size() + 1;
+        x.myHero = (int)mh; x.cpuHero = (int)ch;
+        x.myMove = (MoveType)mm; x.cpuMove = (MoveType)cm;
+        x.outcome = res;
+        x.thinkMs = (int)think;
+        x.timedOut = expect(":T");
+        r.rounds.push_back(x);
+    }
+    return r.rounds.size() <= 255;
+}
+
+static int cmdImport(const string& textPath, const QueryOptions& opt) {
+    MappedFile text;
+    if(!text.open(textPath)) {
+        cout << "无法打开 " << textPath << endl;
+        return 1;
+    }
+    remove(opt.file.c_str());
+    HistoryStoreWriter store;
+    if(!store.open(opt.file)) {
+        cout << "无法写入 " << opt.file << endl;
+        return 1;
+    }
+    long long imported = 0, skipped = 0;
+    MatchRecord r;
+    for(const char* p = text.data(), *end = p + text.size(); p < end; ) {
+        const char* eol = (const char*)memchr(p, '\n', end - p);
+        if(!eol) eol = end;
+        if(parseGameLine(p, eol, r)) {
+            store.add(r.username, r.myLineup, r.cpuLineup, r.rounds, r.startMs, r.endMs, r.myScore, r.cpuScore);
+            imported++;
+        } else if(eol > p + 1) {
+            skipped++;
+        }
+        p = eol + 1;
+    }
+    if(!store.flush() || fflush(store.handle()) != 0 || !syncFile(store.handle())) {
+        cout << "写入失败: " << opt.file << endl;
+        return 1;
+    }
+    cout << "导入 " << imported << " 局, 跳过 " << skipped << " 行 (旧格式或无法解析) -> " << opt.file << endl;
+    return 0;
+}
+
+// ========== generate ==========
+static int cmdGenerate(long long games, const QueryOptions& opt, vector<Hero>& roster) {
+    const uint32_t CHUNK = 4096; // 每个工作项生成的局数：各块种子固定，结果与线程数无关
+    remove(opt.file.c_str());
+    HistoryStoreWriter store;
+    if(!store.open(opt.file)) {
+        cout << "无法写入 " << opt.file << endl;
+        return 1;
+    }
+    int days = opt.days > 0 ? opt.days : 30;
+    long long endMs = epochMillis(), spanMs = days * DAY_MS;
+    long long chunks = (games + CHUNK - 1) / CHUNK;
+    int threads = max(opt.threads, 1);
+    vector<vector<MatchRecord>> batch(threads * 2);
+
+    for(long long first = 0; first < chunks; first += batch.size()) {
+        uint32_t n = (uint32_t)min<long long>(batch.size(), chunks - first);
+        parallelForStealing(threads, n, [&](int, uint32_t j) {
+            long long chunk = first + j;
+            BattleEngine engine(roster, opt.seed, (uint64_t)chunk);
+            long long begin = chunk * CHUNK, count = min<long long>(CHUNK, games - begin);
+            vector<int> pool(roster.size());
+            for(size_t i=0; i<pool.size(); ++i) pool[i] = i;
+            vector<MatchRecord>& out = batch[j];
+            out.resize(count);
+            for(long long g=0; g<count; ++g) {
+                vector<int> lineups[2];
+                for(auto& l : lineups) {
+                    for(int i=0; i<TEAM_SIZE; ++i) swap(pool[i], pool[i + engine.rng.below(pool.size() - i)]);
+                    l.assign(pool.begin(), pool.begin() + TEAM_SIZE);
+                }
+                engine.playAutoGame(lineups[0], lineups[1]);
+                long long startMs = endMs - spanMs + spanMs * (begin + g) / games;
+                MatchRecord& r = out[g];
+                r = MatchRecord::fromEngine(engine, "player" + to_string(engine.rng.below(opt.users)), startMs);
+                r.endMs = startMs + 30000 + engine.rng.below(270000);
+                for(auto& x : r.rounds) x.thinkMs = engine.rng.below(10000);
+            }
+        });
+        for(uint32_t j=0; j<n; ++j) {
+            for(const MatchRecord& r : batch[j]) store.add(r.username, r.myLineup, r.cpuLineup, r.rounds, r.startMs, r.endMs, r.myScore, r.cpuScore);
+        }
+    }
+    if(!store.flush() || fflush(store.handle()) != 0) {
+        cout << "写入失败: " << opt.file << endl;
+        return 1;
+    }
+    cout << "生成 " << games << " 局 (" << opt.users << " 个玩家, 最近 " << days << " 天) -> " << opt.file << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    QueryOptions opt;
+    vector<string> args;
+    for(int i=1; i<argc; ++i) {
+        string a = argv[i];
+        bool value = i + 1 < argc;
+        if(a == "--file" && value) opt.file = argv[++i];
+        else if(a == "--threads" && value) opt.threads = atoi(argv[++i]);
+        else if(a == "--days" && value) opt.days = atoi(argv[++i]);
+        else if(a == "--top" && value) opt.top = atoi(argv[++i]);
+        else if(a == "--min" && value) opt.minGames = atoll(argv[++i]);
+        else if(a == "--user" && value) opt.user = argv[++i];
+        else if(a == "--users" && value) opt.users = max(atoi(argv[++i]), 1);
+        else if(a == "--seed" && value) opt.seed = strtoull(argv[++i], nullptr, 10);
+        else args.push_back(a);
+    }
+    if(opt.threads <= 0) opt.threads = 1;
+    if(opt.days > 0) opt.sinceMs = epochMillis() - opt.days * DAY_MS;
+    string cmd = args.empty() ? "info" : args[0];
+
+    vector<Hero> roster = DataManager::loadHeroRoster();
+    if(cmd == "import") {
+        if(args.size() < 2) { cout << "用法: history_query import <gamedata.txt>" << endl; return 1; }
+        return cmdImport(args[1], opt);
+    }
+    if(cmd == "generate") {
+        long long games = args.size() > 1 ? atoll(args[1].c_str()) : 1000000;
+        if(games <= 0) return 1;
+        if(!opt.seed) opt.seed = GameRng::freshSeed();
+        return cmdGenerate(games, opt, roster);
+    }
+
+    HistoryStore store;
+    if(!store.open(opt.file)) {
+        cout << "无法打开列式记录 " << opt.file << endl;
+        return 1;
+    }
+    auto t0 = chrono::steady_clock::now();
+    int rc;
+    if(cmd == "info") rc = cmdInfo(store, opt);
+    else if(cmd == "lineups") rc = cmdLineups(store, opt, roster);
+    else if(cmd == "moves") rc = cmdMoves(store, opt);
+    else if(cmd == "user" && (args.size() > 1 || !opt.user.empty())) {
+        if(args.size() > 1) opt.user = args[1];
+        rc = cmdUser(store, opt);
+    } else {
+        cout << "未知命令: " << cmd << " (可用: info lineups user moves import generate)" << endl;
+        return 1;
+    }
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    cout << fixed << setprecision(3) << "文件共 " << store.totalMatches() << " 局 / " << store.totalRounds() << " 回合, "
+         << opt.threads << " 个线程, 耗时 " << secs << " 秒" << endl;
+    return rc;
+}
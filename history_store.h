@@ -0,0 +1,390 @@
+/**
+ * 文件名: history_store.h
+ * 描述: 列式对战记录 - 对战记录按列存进 history.kpc，供 history_query 做统计 (阵容胜率、玩家走势、出招分布)。
+ * 文件布局: [文件头 "KOPC" + 版本][块 x N]。每块最多 BLOCK_MATCHES 局，块内按列存放，
+ *       块头记下本块的局数、回合数、时间范围和每一列的偏移。统计只读用得到的列，其余列的页面根本不会读进内存；
+ *       整个文件内存映射后逐块扫描，占用的内存与文件大小无关。
+ * 列编码:
+ *       用户   每块一张用户名字典，每局存 16 位字典编号
+ *       阵容   每块一张阵容字典 (三个 16 位英雄下标，按选人顺序)，双方阵容各存 16 位字典编号
+ *       时间   帧参考编码：块头存本块最早的开局时间 (毫秒)，每局存相对它的 32 位秒数；时长另存 32 位毫秒
+ *       比分   双方得分各 4 位，合成 1 字节
+ *       回合数 每局 1 字节；回合列按局首尾相接，第 i 局的回合从前面各局回合数之和开始
+ *       出招   每回合 16 位，见 HistoryRound
+ *       思考   每回合思考毫秒 16 位 (超过 65535 记 65535)
+ * 注意: 只追加。写块失败时立即截回写之前的长度；进程被杀时写到一半的最后一块在下次打开写入时截掉，读取时忽略。gamedata.txt 仍是完整的文本记录，
+ *       列存文件缺了 (例如进程被杀时还没写出的最后一块) 可以用 history_query import 从它重建。
+ *       英雄下标与 gamedata.txt 一样是写入时 heroes.txt 中的下标。纯逻辑头文件，不依赖 Qt。
+ */
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include "battle_engine.h"
+#include "mapped_file.h"
+
+const uint32_t HISTORY_STORE_VERSION = 1;
+
+struct HistoryFileHeader {
+    char magic[4];    // "KOPC"
+    uint32_t version; // HISTORY_STORE_VERSION
+};
+
+// 块内的列 (块头里按这个顺序记偏移)
+enum HistoryColumn {
+    HCOL_USER,        // uint16 x 局数
+    HCOL_MY_LINEUP,   // uint16 x 局数
+    HCOL_CPU_LINEUP,  // uint16 x 局数
+    HCOL_START,       // uint32 x 局数：开局时间 - baseMs，秒
+    HCOL_DURATION,    // uint32 x 局数：毫秒
+    HCOL_SCORE,       // uint8 x 局数：我方分 << 4 | 电脑分
+    HCOL_ROUND_COUNT, // uint8 x 局数
+    HCOL_ROUNDS,      // uint16 x 回合数 (HistoryRound)
+    HCOL_THINK,       // uint16 x 回合数
+    HCOL_USER_INDEX,  // uint32 x (用户数 + 1)：各用户名在字符串区中的起止偏移
+    HCOL_USER_NAMES,  // 字符串区
+    HCOL_LINEUPS,     // uint16 x 3 x 阵容数
+    HCOL_COUNT
+};
+
+struct HistoryBlockHeader {
+    char magic[4];                // "KOPB"
+    uint32_t matches;
+    uint32_t rounds;
+    uint32_t users;               // 用户字典大小
+    uint32_t lineups;             // 阵容字典大小
+    uint32_t reserved;
+    int64_t baseMs;               // 本块最早的开局时间
+    int64_t lastMs;               // 本块最晚的开局时间 (按时间范围查询时整块跳过)
+    uint64_t size;                // 整块字节数 (含块头，8 字节对齐)
+    uint64_t offset[HCOL_COUNT];  // 各列相对块头的偏移 (8 字节对齐)
+};
+
+// 一个回合的 16 位编码：位 0-1 我方招，2-3 电脑招，4-5 结果 (OUTCOME_*)，6 超时，
+// 7-8 我方出战英雄在阵容中的位置，9-10 电脑的
+struct HistoryRound {
+    static uint16_t pack(int myMove, int cpuMove, int outcome, bool timedOut, int mySlot, int cpuSlot) {
+        return (uint16_t)((myMove & 3) | (cpuMove & 3) << 2 | (outcome & 3) << 4 | (int)timedOut << 6
+                          | (mySlot & 3) << 7 | (cpuSlot & 3) << 9);
+    }
+    static int myMove(uint16_t r) { return r & 3; }
+    static int cpuMove(uint16_t r) { return r >> 2 & 3; }
+    static int outcome(uint16_t r) { return r >> 4 & 3; }
+    static bool timedOut(uint16_t r) { return r >> 6 & 1; }
+    static int mySlot(uint16_t r) { return r >> 7 & 3; }
+    static int cpuSlot(uint16_t r) { return r >> 9 & 3; }
+};
+
+// ==========================================
+// 类: HistoryBlock (只读的一块)
+// 描述: 指向映射内存中的一块，按列取数组
+// ==========================================
+class HistoryBlock {
+public:
+    explicit HistoryBlock(const HistoryBlockHeader* header) : h(header) {}
+
+    uint32_t matches() const { return h->matches; }
+    uint32_t rounds() const { return h->rounds; }
+    uint32_t users() const { return h->users; }
+    uint32_t lineups() const { return h->lineups; }
+    long long baseMs() const { return h->baseMs; }
+    long long lastMs() const { return h->lastMs; }
+
+    const uint16_t* userCodes() const { return col<uint16_t>(HCOL_USER); }
+    const uint16_t* myLineups() const { return col<uint16_t>(HCOL_MY_LINEUP); }
+    const uint16_t* cpuLineups() const { return col<uint16_t>(HCOL_CPU_LINEUP); }
+    const uint32_t* startSec() const { return col<uint32_t>(HCOL_START); }
+    const uint32_t* durationMs() const { return col<uint32_t>(HCOL_DURATION); }
+    const uint8_t* scores() const { return col<uint8_t>(HCOL_SCORE); }
+    const uint8_t* roundCounts() const { return col<uint8_t>(HCOL_ROUND_COUNT); }
+    const uint16_t* roundCodes() const { return col<uint16_t>(HCOL_ROUNDS); }
+    const uint16_t* thinkMs() const { return col<uint16_t>(HCOL_THINK); }
+
+    string_view userName(uint32_t code) const {
+        const uint32_t* index = col<uint32_t>(HCOL_USER_INDEX);
+        return string_view(col<char>(HCOL_USER_NAMES) + index[code], index[code + 1] - index[code]);
+    }
+
+    // 用户在本块字典里的编号，不在本块返回 -1
+    int findUser(string_view name) const {
+        for(uint32_t u=0; u<h->users; ++u) if(userName(u) == name) return (int)u;
+        return -1;
+    }
+
+    // 阵容字典第 code 项的三个英雄下标
+    const uint16_t* lineup(uint32_t code) const { return col<uint16_t>(HCOL_LINEUPS) + code * TEAM_SIZE; }
+
+    // 检查块头里的偏移和长度都落在块内，以及查询直接拿来当下标的内容：用户、阵容编号都在字典内，
+    // 用户名索引不递减，各局回合数之和等于块头的回合数 (打开文件时每块调用一次)
+    bool valid() const {
+        uint64_t need[HCOL_COUNT] = {
+            h->matches * 2ull, h->matches * 2ull, h->matches * 2ull, h->matches * 4ull, h->matches * 4ull,
+            h->matches * 1ull, h->matches * 1ull, h->rounds * 2ull, h->rounds * 2ull, (h->users + 1) * 4ull, 0,
+            h->lineups * 2ull * TEAM_SIZE
+        };
+        for(int c=0; c<HCOL_COUNT; ++c) {
+            if(h->offset[c] < sizeof(HistoryBlockHeader) || h->offset[c] % 8 != 0
+               || h->offset[c] > h->size || need[c] > h->size - h->offset[c]) return false;
+        }
+        const uint32_t* index = col<uint32_t>(HCOL_USER_INDEX);
+        for(uint32_t u=0; u<h->users; ++u) if(index[u] > index[u + 1]) return false;
+        if(index[h->users] > h->size - h->offset[HCOL_USER_NAMES]) return false;
+
+        const uint16_t* user = userCodes();
+        const uint16_t* mine = myLineups();
+        const uint16_t* cpu = cpuLineups();
+        const uint8_t* count = roundCounts();
+        uint32_t bad = 0;
+        uint64_t rounds = 0;
+        for(uint32_t i=0; i<h->matches; ++i) { // 不提前退出，编译器可以向量化
+            bad |= (user[i] >= h->users) | (mine[i] >= h->lineups) | (cpu[i] >= h->lineups);
+            rounds += count[i];
+        }
+        return !bad && rounds == h->rounds;
+    }
+
+private:
+    const HistoryBlockHeader* h;
+
+    template <class T>
+    const T* col(int c) const { return (const T*)((const char*)h + h->offset[c]); }
+};
+
+// ==========================================
+// 类: HistoryStore (列式记录文件，只读)
+// 描述: 映射整个文件，open 时逐块检查块头，并扫一遍每块的用户、阵容、回合数三列 (每局 7 字节)，
+//       坏块之后的内容一概不用；其余列要到查询时才读
+// ==========================================
+class HistoryStore {
+public:
+    // 映射文件；不存在或文件头不对返回 false。末尾写了一半的块忽略
+    bool open(const string& path) {
+        blockList.clear();
+        if(!file.open(path) || file.size() < sizeof(HistoryFileHeader)) return false;
+        const HistoryFileHeader* fh = (const HistoryFileHeader*)file.data();
+        if(memcmp(fh->magic, "KOPC", 4) != 0 || fh->version != HISTORY_STORE_VERSION) { file.close(); return false; }
+        validEnd = sizeof(HistoryFileHeader);
+        while(file.size() - validEnd >= sizeof(HistoryBlockHeader)) {
+            const HistoryBlockHeader* h = (const HistoryBlockHeader*)(file.data() + validEnd);
+            if(memcmp(h->magic, "KOPB", 4) != 0 || h->size > file.size() - validEnd || h->size % 8 != 0
+               || !HistoryBlock(h).valid()) break;
+            blockList.push_back(h);
+            validEnd += h->size;
+        }
+        return true;
+    }
+
+    size_t blocks() const { return blockList.size(); }
+    HistoryBlock block(size_t i) const { return HistoryBlock(blockList[i]); }
+
+    // 最后一个完整块的末尾 (之后的内容是写了一半的块)
+    size_t completeSize() const { return validEnd; }
+
+    uint64_t totalMatches() const {
+        uint64_t n = 0;
+        for(const auto* h : blockList) n += h->matches;
+        return n;
+    }
+
+    uint64_t totalRounds() const {
+        uint64_t n = 0;
+        for(const auto* h : blockList) n += h->rounds;
+        return n;
+    }
+
+private:
+    MappedFile file;
+    vector<const HistoryBlockHeader*> blockList;
+    size_t validEnd = 0;
+};
+
+// ==========================================
+// 类: HistoryStoreWriter (列式记录追加写入)
+// 描述: add 把一局放进内存中的当前块，攒满 BLOCK_MATCHES 局 (或字典满了) 就写出一块；
+//       flush 把不满的当前块也写出 (退出前调用)。不是线程安全的，由对战记录写线程独占
+// ==========================================
+class HistoryStoreWriter {
+public:
+    // 每块最多的局数：双方阵容字典合计最多 2 * BLOCK_MATCHES 项，正好用 16 位编号
+    static const uint32_t BLOCK_MATCHES = 32768;
+
+    ~HistoryStoreWriter() { close(); }
+
+    // 文件不存在时新建；文件头不对时改名为 <路径>.old 后新建；末尾写了一半的块截掉后接着写
+    bool open(const string& path) {
+        close();
+        this->path = path;
+        size_t end = 0;
+        {
+            HistoryStore existing;
+            if(existing.open(path)) end = existing.completeSize();
+        }
+        error_code ec;
+        if(end > 0) {
+            if(filesystem::file_size(path, ec) != end) filesystem::resize_file(path, end, ec);
+            file = fopen(path.c_str(), "r+b");
+            if(file) fseek(file, 0, SEEK_END);
+            written = end;
+            return file != nullptr;
+        }
+        if(filesystem::exists(path, ec) && filesystem::file_size(path, ec) > 0) {
+            string old = path + ".old";
+            remove(old.c_str());
+            rename(path.c_str(), old.c_str());
+        }
+        file = fopen(path.c_str(), "wb");
+        if(!file) return false;
+        HistoryFileHeader h;
+        memcpy(h.magic, "KOPC", 4);
+        h.version = HISTORY_STORE_VERSION;
+        written = sizeof(h);
+        return fwrite(&h, sizeof(h), 1, file) == 1;
+    }
+
+    void close() {
+        if(!file) return;
+        flush();
+        fclose(file);
+        file = nullptr;
+    }
+
+    FILE* handle() const { return file; }
+    uint32_t pending() const { return (uint32_t)score.size(); }
+
+    // 加入一局。阵容和回合里的英雄都是英雄表下标，回合里的英雄必须在对应一方的阵容中
+    void add(const string& user, const vector<int>& myLineup, const vector<int>& cpuLineup,
+             const vector<RoundResult>& rounds, long long startMs, long long endMs, int myScore, int cpuScore) {
+        if(score.size() >= BLOCK_MATCHES || userDict.size() >= 65535) flush();
+        if(score.empty()) baseMs = lastMs = startMs;
+        baseMs = min(baseMs, startMs);
+        lastMs = max(lastMs, startMs);
+
+        auto it = userDict.find(user);
+        if(it == userDict.end()) {
+            it = userDict.emplace(user, (uint16_t)(userIndex.size() - 1)).first;
+            userNames += user;
+            userIndex.push_back(userNames.size());
+        }
+        userCol.push_back(it->second);
+        myLineupCol.push_back(lineupCode(myLineup));
+        cpuLineupCol.push_back(lineupCode(cpuLineup));
+        startCol.push_back(startMs);
+        durationCol.push_back((uint32_t)max(0LL, endMs - startMs));
+        score.push_back((uint8_t)(min(myScore, 15) << 4 | min(cpuScore, 15)));
+        roundCount.push_back((uint8_t)rounds.size());
+        for(const RoundResult& r : rounds) {
+            roundCol.push_back(HistoryRound::pack(r.myMove, r.cpuMove, r.outcome, r.timedOut,
+                                                  slotOf(myLineup, r.myHero), slotOf(cpuLineup, r.cpuHero)));
+            thinkCol.push_back((uint16_t)min(max(r.thinkMs, 0), 65535));
+        }
+    }
+
+    // 把当前块写出 (不满也写)，返回是否成功
+    bool flush() {
+        if(score.empty()) return true;
+        bool ok = file && writeBlock();
+        clearBlock();
+        return ok;
+    }
+
+private:
+    FILE* file = nullptr;
+    string path;
+    uint64_t written = 0; // 已完整写出的字节数 (文件头 + 各完整块)，写块失败时截回这里
+
+    // 当前块 (列)
+    vector<uint16_t> userCol, myLineupCol, cpuLineupCol, roundCol, thinkCol;
+    vector<long long> startCol; // 写出时才换成相对 baseMs 的秒数
+    vector<uint32_t> durationCol;
+    vector<uint8_t> score, roundCount;
+    long long baseMs = 0, lastMs = 0;
+    // 当前块的字典
+    unordered_map<string, uint16_t> userDict;
+    string userNames;
+    vector<uint32_t> userIndex = { 0 };
+    unordered_map<uint64_t, uint16_t> lineupDict;
+    vector<uint16_t> lineupHeroes;
+
+    uint16_t lineupCode(const vector<int>& lineup) {
+        uint64_t key = 0;
+        for(int i=0; i<TEAM_SIZE; ++i) key = key << 16 | (uint16_t)lineup[i];
+        auto it = lineupDict.find(key);
+        if(it != lineupDict.end()) return it->second;
+        uint16_t code = (uint16_t)lineupDict.size();
+        lineupDict.emplace(key, code);
+        for(int i=0; i<TEAM_SIZE; ++i) lineupHeroes.push_back((uint16_t)lineup[i]);
+        return code;
+    }
+
+    static int slotOf(const vector<int>& lineup, int hero) {
+        for(int i=0; i<(int)lineup.size(); ++i) if(lineup[i] == hero) return i;
+        return 3; // 不在阵容中 (不应发生)
+    }
+
+    void clearBlock() {
+        userCol.clear(); myLineupCol.clear(); cpuLineupCol.clear(); roundCol.clear(); thinkCol.clear();
+        startCol.clear(); durationCol.clear(); score.clear(); roundCount.clear();
+        userDict.clear(); userNames.clear(); userIndex.assign(1, 0);
+        lineupDict.clear(); lineupHeroes.clear();
+    }
+
+    bool writeBlock() {
+        vector<uint32_t> startSec(startCol.size());
+        for(size_t i=0; i<startCol.size(); ++i) startSec[i] = (uint32_t)((startCol[i] - baseMs) / 1000);
+
+        HistoryBlockHeader h = {};
+        memcpy(h.magic, "KOPB", 4);
+        h.matches = score.size();
+        h.rounds = roundCol.size();
+        h.users = userDict.size();
+        h.lineups = lineupDict.size();
+        h.baseMs = baseMs;
+        h.lastMs = lastMs;
+
+        string buf(sizeof(h), '\0');
+        auto put = [&](int c, const void* data, size_t bytes) {
+            buf.resize((buf.size() + 7) & ~(size_t)7, '\0');
+            h.offset[c] = buf.size();
+            buf.append((const char*)data, bytes);
+        };
+        put(HCOL_USER, userCol.data(), userCol.size() * 2);
+        put(HCOL_MY_LINEUP, myLineupCol.data(), myLineupCol.size() * 2);
+        put(HCOL_CPU_LINEUP, cpuLineupCol.data(), cpuLineupCol.size() * 2);
+        put(HCOL_START, startSec.data(), startSec.size() * 4);
+        put(HCOL_DURATION, durationCol.data(), durationCol.size() * 4);
+        put(HCOL_SCORE, score.data(), score.size());
+        put(HCOL_ROUND_COUNT, roundCount.data(), roundCount.size());
+        put(HCOL_ROUNDS, roundCol.data(), roundCol.size() * 2);
+        put(HCOL_THINK, thinkCol.data(), thinkCol.size() * 2);
+        put(HCOL_USER_INDEX, userIndex.data(), userIndex.size() * 4);
+        put(HCOL_USER_NAMES, userNames.data(), userNames.size());
+        put(HCOL_LINEUPS, lineupHeroes.data(), lineupHeroes.size() * 2);
+        buf.resize((buf.size() + 7) & ~(size_t)7, '\0');
+        h.size = buf.size();
+        memcpy(&buf[0], &h, sizeof(h));
+        if(fwrite(buf.data(), 1, buf.size(), file) == buf.size() && fflush(file) == 0) {
+            written += buf.size();
+            return true;
+        }
+        // 写了一半的块 (例如磁盘满) 留在文件里，读取时会停在它那里，之后追加的块全都看不到：
+        // 关掉文件 (缓冲区里剩下的内容也落在截断位置之后)，截回写之前的长度，再接着追加；
+        // 截不回去就不再写列存文件，缺的对局可以之后用 history_query import 从 gamedata.txt 补上
+        fclose(file);
+        file = nullptr;
+        error_code ec;
+        filesystem::resize_file(path, written, ec);
+        if(ec) return false;
+        file = fopen(path.c_str(), "r+b");
+        if(file) fseek(file, 0, SEEK_END);
+        return false;
+    }
+};
+
+#endif
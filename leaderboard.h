@@ -0,0 +1,163 @@
+/**
+ * 文件名: leaderboard.h
+ * 描述: 增量维护的排行榜 - 胜场或胜率变化时只调整一个条目，
+ *       “前 N 名”和“我排第几”都不需要复制、重排整张表。
+ */
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <set>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+
+using namespace std;
+
+// ==========================================
+// 类: RankIndex (分桶排名索引)
+// 描述: 按分数分桶，用树状数组 (Fenwick Tree) 记录每个分数上的人数，
+//       “比我分高的有多少人”是一次前缀和查询，O(log 最高分)
+// ==========================================
+class RankIndex {
+public:
+    void add(int score, int delta) {
+        if(score >= (int)counts.size()) grow(score + 1);
+        counts[score] += delta;
+        total += delta;
+        for(int i = score + 1; i < (int)tree.size(); i += i & -i) tree[i] += delta;
+    }
+
+    // 分数不低于 score 的人数
+    int countAtLeast(int score) const {
+        if(score <= 0) return total;
+        return total - prefix(min(score, (int)counts.size()));
+    }
+
+    // 并列按同一名次计算 (1 + 比我分高的人数)
+    int rankOf(int score) const { return countAtLeast(score + 1) + 1; }
+
+private:
+    vector<int> counts; // counts[s] = 分数恰好为 s 的人数
+    vector<int> tree;   // 树状数组，tree[i] 对应 counts 的下标 i-1
+    int total = 0;
+
+    // 分数在 [0, n) 内的人数
+    int prefix(int n) const {
+        int sum = 0;
+        for(int i = n; i > 0; i -= i & -i) sum += tree[i];
+        return sum;
+    }
+
+    // 容量翻倍并重建树状数组 (O(容量)，均摊到每次更新是常数)
+    void grow(int need) {
+        int cap = max(16, (int)counts.size());
+        while(cap < need) cap *= 2;
+        counts.resize(cap, 0);
+        tree.assign(cap + 1, 0);
+        for(int i = 1; i <= cap; ++i) {
+            tree[i] += counts[i - 1];
+            int j = i + (i & -i);
+            if(j <= cap) tree[j] += tree[i];
+        }
+    }
+};
+
+// ==========================================
+// 类: PlayerLeaderboard (玩家榜)
+// 描述: 有序集合负责“前 N 名”和分页，RankIndex 负责“我排第几”；
+//       分数可以是胜场，也可以是积分 (DataManager 各建一个)
+// ==========================================
+class PlayerLeaderboard {
+public:
+    // 一次性建榜：scores[id] 为第 id 号玩家的分数
+    // 先排好序再整体构造有序集合 (线性时间)，比逐个 insert 快得多，百万玩家的排行榜打开时不卡
+    void assign(const vector<int>& scores) {
+        vector<pair<int, int>> keys(scores.size());
+        for(int id=0; id<(int)scores.size(); ++id) keys[id] = { -scores[id], id };
+        sort(keys.begin(), keys.end());
+        order = set<pair<int, int>>(keys.begin(), keys.end());
+        score = scores;
+        ranks = RankIndex();
+        for(int s : scores) ranks.add(s, 1);
+    }
+
+    // 新玩家上榜 (id 为玩家在 DataManager::players 中的下标)
+    void insert(int id, int wins) {
+        if(id >= (int)score.size()) score.resize(id + 1, -1);
+        score[id] = wins;
+        order.insert({ -wins, id });
+        ranks.add(wins, 1);
+    }
+
+    // 胜场变化：先摘掉旧条目再插入新条目
+    void update(int id, int wins) {
+        if(id >= (int)score.size() || score[id] < 0) { insert(id, wins); return; }
+        order.erase({ -score[id], id });
+        ranks.add(score[id], -1);
+        score[id] = wins;
+        order.insert({ -wins, id });
+        ranks.add(wins, 1);
+    }
+
+    // 胜场最多的前 n 名 (胜场相同按注册先后)，返回玩家下标
+    vector<int> top(int n) const {
+        vector<int> ids;
+        for(auto it = order.begin(); it != order.end() && (int)ids.size() < n; ++it) ids.push_back(it->second);
+        return ids;
+    }
+
+    // 分页：紧接在 (afterScore, afterId) 这一条之后取 n 个，afterId < 0 表示从第一名 (或最后一名) 开始
+    // descending 为 true 时从高到低，否则从低到高；按位置“游标”续取，不需要从头数
+    vector<int> page(int afterScore, int afterId, int n, bool descending) const {
+        vector<int> ids;
+        if(descending) {
+            auto it = afterId < 0 ? order.begin() : order.upper_bound({ -afterScore, afterId });
+            for(; it != order.end() && (int)ids.size() < n; ++it) ids.push_back(it->second);
+        } else {
+            auto it = afterId < 0 ? order.rbegin() : make_reverse_iterator(order.lower_bound({ -afterScore, afterId }));
+            for(; it != order.rend() && (int)ids.size() < n; ++it) ids.push_back(it->second);
+        }
+        return ids;
+    }
+
+    int scoreOf(int id) const { return score[id]; }
+    int rankOf(int id) const { return ranks.rankOf(score[id]); }
+    int size() const { return order.size(); }
+
+private:
+    set<pair<int, int>> order; // (-分数, 下标)，从头遍历就是从高到低
+    vector<int> score;         // 每个玩家当前在榜上的分数，用于定位旧条目
+    RankIndex ranks;
+};
+
+// ==========================================
+// 类: HeroLeaderboard (英雄胜率榜)
+// 描述: 每回合结算后只更新出场的两个英雄
+// ==========================================
+class HeroLeaderboard {
+public:
+    void update(int id, double winRate) {
+        if(id >= (int)rate.size()) { rate.resize(id + 1, 0.0); present.resize(id + 1, false); }
+        if(present[id]) order.erase({ -rate[id], id });
+        rate[id] = winRate;
+        present[id] = true;
+        order.insert({ -winRate, id });
+    }
+
+    // 胜率最高的前 n 个英雄，返回英雄下标
+    vector<int> top(int n) const {
+        vector<int> ids;
+        for(auto it = order.begin(); it != order.end() && (int)ids.size() < n; ++it) ids.push_back(it->second);
+        return ids;
+    }
+
+    int size() const { return order.size(); }
+
+private:
+    set<pair<double, int>> order; // (-胜率, 下标)
+    vector<double> rate;
+    vector<bool> present;
+};
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * 文件名: leaderboard_model.cpp
+ * 描述: 玩家排行榜表格模型的实现。
+ */
+#include "leaderboard_model.h"
+#include <QFont>
+
+PlayerRankModel::PlayerRankModel(DataManager& dm, QObject* parent) : QAbstractTableModel(parent), dm(dm) {}
+
+int PlayerRankModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : (int)rows.size();
+}
+
+int PlayerRankModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : COL_COUNT;
+}
+
+QVariant PlayerRankModel::data(const QModelIndex& index, int role) const {
+    if(!index.isValid() || index.row() >= (int)rows.size()) return QVariant();
+    const DataManager::RankEntry& r = rows[index.row()];
+    if(role == Qt::DisplayRole) {
+        switch(index.column()) {
+            case COL_RANK:   return r.rank;
+            case COL_NAME:   return QString::fromStdString(r.username);
+            case COL_WINS:   return r.wins;
+            case COL_RATING: return r.rating;
+        }
+    } else if(role == Qt::TextAlignmentRole && index.column() != COL_NAME) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    } else if(role == Qt::FontRole && dm.currentUser && r.id == dm.currentUserId()) {
+        QFont f; // 高亮自己
+        f.setBold(true);
+        return f;
+    }
+    return QVariant();
+}
+
+QVariant PlayerRankModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if(role != Qt::DisplayRole) return QVariant();
+    if(orientation == Qt::Vertical) return QVariant(); // 名次已经单独成列
+    switch(section) {
+        case COL_RANK:   return QString(order == DataManager::BY_RATING ? "积分名次" : "名次");
+        case COL_NAME:   return QString("用户名");
+        case COL_WINS:   return QString("胜场");
+        case COL_RATING: return QString("积分");
+    }
+    return QVariant();
+}
+
+bool PlayerRankModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !exhausted;
+}
+
+void PlayerRankModel::fetchMore(const QModelIndex& parent) {
+    if(parent.isValid() || exhausted) return;
+    vector<DataManager::RankEntry> page = dm.rankPage(order, descending, rows.empty() ? nullptr : &rows.back(),
+                                                      PAGE_SIZE, prefix);
+    if((int)page.size() < PAGE_SIZE) exhausted = true;
+    if(page.empty()) return;
+    beginInsertRows(QModelIndex(), rows.size(), rows.size() + page.size() - 1);
+    rows.insert(rows.end(), page.begin(), page.end());
+    endInsertRows();
+}
+
+void PlayerRankModel::sort(int column, Qt::SortOrder sortOrder) {
+    if(column == COL_RATING) order = DataManager::BY_RATING;
+    else if(column == COL_NAME) order = DataManager::BY_NAME;
+    else order = DataManager::BY_WINS;
+    // 名次列升序 = 胜场降序 (第 1 名在最上面)
+    descending = (column == COL_RANK) ? (sortOrder == Qt::AscendingOrder) : (sortOrder == Qt::DescendingOrder);
+    reload();
+    emit headerDataChanged(Qt::Horizontal, COL_RANK, COL_RANK);
+}
+
+void PlayerRankModel::setSearch(const QString& text) {
+    prefix = text.trimmed().toStdString();
+    reload();
+}
+
+void PlayerRankModel::reload() {
+    beginResetModel();
+    rows.clear();
+    exhausted = false;
+    endResetModel();
+    fetchMore(QModelIndex()); // 先取第一页，其余的等视图滚动时再取
+}
+
+int PlayerRankModel::rowOfPlayer(int id) const {
+    for(int i=0; i<(int)rows.size(); ++i) if(rows[i].id == id) return i;
+    return -1;
+}
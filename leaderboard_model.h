@@ -0,0 +1,55 @@
+/**
+ * 文件名: leaderboard_model.h
+ * 描述: 玩家排行榜的表格模型 - 给 QTableView 用的 QAbstractTableModel。
+ * 注意: 模型只保存已经滚动到过的那几页 (fetchMore 每次向 DataManager 要一页)，
+ *       打开排行榜时只取第一页，与玩家总数无关；排序和搜索都交给 DataManager 的有序索引，
+ *       模型本身从不对全部玩家排序。
+ */
+#ifndef LEADERBOARD_MODEL_H
+#define LEADERBOARD_MODEL_H
+
+#include <QAbstractTableModel>
+#include <QString>
+#include "game_data.h"
+
+class PlayerRankModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { COL_RANK, COL_NAME, COL_WINS, COL_RATING, COL_COUNT };
+
+    explicit PlayerRankModel(DataManager& dm, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    // 视图滚动到底部时调用：还有下一页就再取一页
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    // 点击表头排序：名次/胜场列按胜场，积分列按积分，用户名列按用户名
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // 按用户名前缀搜索 (空字符串表示不过滤)
+    void setSearch(const QString& prefix);
+
+    // 丢掉已取的行，从第一页重新开始 (数据有变化时调用)
+    void reload();
+
+    // 某个玩家在已取出的行中的位置，没有取到返回 -1
+    int rowOfPlayer(int id) const;
+
+private:
+    static const int PAGE_SIZE = 200;
+
+    DataManager& dm;
+    vector<DataManager::RankEntry> rows; // 已取出的行
+    bool exhausted = false;              // 已经取到最后一页
+    DataManager::RankOrder order = DataManager::BY_WINS;
+    bool descending = true;
+    string prefix;
+};
+
+#endif // LEADERBOARD_MODEL_H
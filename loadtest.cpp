@@ -0,0 +1,305 @@
+/**
+ * 文件名: loadtest.cpp
+ * 描述: 对战服务器压测 - 开若干连接，每个连接上保持固定数量的对局同时进行 (请求流水线发送)，
+ *       随机出招直到对局结束再开新局；统计每秒出招数、每秒完成对局数，以及出招的往返延迟分位数。
+ * 用法: loadtest [地址=127.0.0.1] [端口=7700] [连接数=4] [每连接并发对局=64] [秒数=5]
+ *       loadtest --local [连接数] [每连接并发对局] [秒数]   在本进程内启动服务器 (系统分配端口) 再压测
+ *       loadtest --local --rated [玩家数=64] [连接数=4] [秒数=5]   积分赛：在临时目录注册玩家，开积分赛的本地服务器，
+ *           各连接替自己的玩家排队、查询、随机出招，打完再排；统计完成局数、排队等待分位数和最后的积分分布
+ */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include "game_server.h"
+
+namespace fs = std::filesystem;
+
+typedef chrono::steady_clock Clock;
+
+// 从应答里我方还剩的招中随机挑一个 (按招计数加权)
+static MoveType randomMove(const Reply& r, mt19937& rng) {
+    int count[3] = { 0, 0, 0 };
+    for(int i=0; i<TEAM_SIZE; ++i) for(int m=SCISSORS; m<=PAPER; ++m) count[m] += movesCount(r.myMoves[i], (MoveType)m);
+    int x = rng() % max(1, count[0] + count[1] + count[2]);
+    return (MoveType)((x >= count[0]) + (x >= count[0] + count[1]));
+}
+
+struct ConnStats {
+    long long moves = 0, matches = 0, errors = 0;
+    vector<float> latencyUs; // 每次出招的往返延迟 (微秒)
+};
+
+// 一个连接：先发出 inflight 个开局请求，之后每收到一个应答就补发一个请求，始终保持 inflight 个在路上
+static void runConnection(const string& host, int port, int inflight, double seconds, unsigned seed, ConnStats& st) {
+    socket_t fd = netConnect(host, port);
+    if(fd == INVALID_SOCK) { st.errors++; return; }
+    mt19937 rng(seed);
+    vector<Clock::time_point> sentAt(inflight);
+    static const int heroCount = DataManager::loadHeroRoster().size(); // 所有连接共用，只读一次名单
+
+    // tag 就是“第几个并发槽位”，应答带回 tag 即可找到对应的发送时间
+    auto newMatch = [&](uint32_t slot) {
+        Request q = {};
+        q.type = REQ_NEW_MATCH;
+        q.flags = REQ_FLAG_SOLVER;
+        q.tag = slot;
+        int picked = 0;
+        while(picked < TEAM_SIZE) {
+            int h = rng() % heroCount;
+            bool dup = false;
+            for(int i=0; i<picked; ++i) if(q.heroes[i] == h) dup = true;
+            if(!dup) q.heroes[picked++] = (uint16_t)h;
+        }
+        sentAt[slot] = Clock::now();
+        return netSendAll(fd, &q, sizeof(q));
+    };
+    auto sendMove = [&](const Reply& r) {
+        Request q = {};
+        q.type = REQ_MOVE;
+        q.move = (uint8_t)randomMove(r, rng);
+        q.matchId = r.matchId;
+        q.tag = r.tag;
+        sentAt[r.tag] = Clock::now();
+        return netSendAll(fd, &q, sizeof(q));
+    };
+
+    for(int i=0; i<inflight; ++i) if(!newMatch(i)) { st.errors++; netClose(fd); return; }
+
+    auto deadline = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double>(seconds));
+    int outstanding = inflight;
+    bool draining = false;
+    Reply r;
+    while(outstanding > 0 && netRecvAll(fd, &r, sizeof(r))) {
+        outstanding--;
+        auto now = Clock::now();
+        if(r.status != REPLY_OK) { st.errors++; continue; }
+        if(r.type == REQ_MOVE) {
+            st.moves++;
+            st.latencyUs.push_back(chrono::duration<float, micro>(now - sentAt[r.tag]).count());
+        }
+        if(!draining && now >= deadline) draining = true; // 到时间后不再发新请求，只收完在路上的应答
+        if(draining) continue;
+        bool ok;
+        if(r.over()) { st.matches++; ok = newMatch(r.tag); }
+        else ok = sendMove(r);
+        if(!ok) { st.errors++; break; }
+        outstanding++;
+    }
+    netClose(fd);
+}
+
+struct RatedStats {
+    long long matches = 0, errors = 0;
+    vector<float> waitMs; // 每次排队到配上对手的等待 (毫秒)
+};
+
+// 积分赛的一个连接：轮流替 players 中的每名玩家发一个请求 (一问一答)：没排队就排队，排着队就查询，
+// 在对局中就出招，出了招等对手就查询；一轮下来谁都没有进展就歇 1 毫秒
+static void runRatedConnection(const string& host, int port, vector<int> players, double seconds, unsigned seed, RatedStats& st) {
+    socket_t fd = netConnect(host, port);
+    if(fd == INVALID_SOCK) { st.errors++; return; }
+    mt19937 rng(seed);
+    static const int heroCount = DataManager::loadHeroRoster().size();
+
+    enum State { IDLE, QUEUED, PLAYING };
+    struct Seat {
+        State state = IDLE;
+        Clock::time_point queuedAt;
+        Reply last = {};     // 对局中最近一次应答
+        int movedRound = 0;  // 已经出过招、正在等对手的回合
+    };
+    vector<Seat> seats(players.size());
+
+    auto call = [&](Request& q, Reply& r) {
+        return netSendAll(fd, &q, sizeof(q)) && netRecvAll(fd, &r, sizeof(r));
+    };
+    // 对局中的应答：打完就回到没排队，否则记下状态
+    auto update = [&](Seat& s, const Reply& r) {
+        if(r.status == REPLY_WAITING) { s.movedRound = r.round; return; }
+        if(r.status != REPLY_OK && r.status != REPLY_ROUND_EXPIRED) { st.errors++; s.state = IDLE; return; }
+        if(r.over()) { st.matches++; s.state = IDLE; return; }
+        s.last = r;
+    };
+
+    auto deadline = Clock::now() + chrono::duration_cast<Clock::duration>(chrono::duration<double>(seconds));
+    bool ok = true;
+    while(ok && Clock::now() < deadline) {
+        bool progress = false;
+        for(size_t i=0; i<players.size() && ok; ++i) {
+            Seat& s = seats[i];
+            Request q = {};
+            Reply r;
+            q.matchId = (uint32_t)players[i];
+            q.tag = (uint32_t)i;
+            if(s.state == IDLE) {
+                q.type = REQ_RATED_QUEUE;
+                int picked = 0;
+                while(picked < TEAM_SIZE) {
+                    int h = rng() % heroCount;
+                    bool dup = false;
+                    for(int j=0; j<picked; ++j) if(q.heroes[j] == h) dup = true;
+                    if(!dup) q.heroes[picked++] = (uint16_t)h;
+                }
+                if(!(ok = call(q, r))) break;
+                if(r.status != REPLY_QUEUED) { st.errors++; continue; }
+                s.state = QUEUED;
+                s.queuedAt = Clock::now();
+                progress = true;
+            } else if(s.state == QUEUED) {
+                q.type = REQ_RATED_POLL;
+                if(!(ok = call(q, r))) break;
+                if(r.status == REPLY_QUEUED) continue;
+                st.waitMs.push_back(chrono::duration<float, milli>(Clock::now() - s.queuedAt).count());
+                s.state = PLAYING;
+                s.movedRound = 0;
+                update(s, r);
+                progress = true;
+            } else if(s.movedRound == s.last.round) {
+                q.type = REQ_RATED_POLL;
+                if(!(ok = call(q, r))) break;
+                if(r.round != s.last.round || r.over()) { update(s, r); progress = true; }
+            } else {
+                q.type = REQ_RATED_MOVE;
+                q.move = (uint8_t)randomMove(s.last, rng);
+                q.round = s.last.round;
+                if(!(ok = call(q, r))) break;
+                update(s, r);
+                progress = true;
+            }
+        }
+        if(!progress) this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    if(!ok) st.errors++;
+    // 到时间后还在排队的取消掉 (打到一半的对局留给服务器按时限代出)
+    for(size_t i=0; ok && i<players.size(); ++i) {
+        if(seats[i].state != QUEUED) continue;
+        Request q = {};
+        Reply r;
+        q.type = REQ_RATED_CANCEL;
+        q.matchId = (uint32_t)players[i];
+        ok = call(q, r);
+    }
+    netClose(fd);
+}
+
+// 积分赛压测：在临时目录里注册玩家 (不碰当前目录的玩家数据)，开积分赛的本地服务器
+static int runRated(const vector<string>& args) {
+    int playerCount = args.size() > 2 ? max(2, atoi(args[2].c_str())) : 64;
+    int conns = args.size() > 3 ? max(1, atoi(args[3].c_str())) : 4;
+    double seconds = args.size() > 4 ? atof(args[4].c_str()) : 5.0;
+
+    fs::path old = fs::current_path();
+    fs::path dir = fs::temp_directory_path() / ("kop_loadtest_" + to_string(Clock::now().time_since_epoch().count()));
+    fs::create_directories(dir);
+    fs::current_path(dir);
+
+    GameServer local;
+    GameServer::Config cfg;
+    cfg.port = 0;
+    cfg.rated = true;
+    if(!local.start(cfg)) { cerr << "无法启动本地服务器" << endl; return 1; }
+    vector<vector<int>> owned(conns);
+    for(int i=0; i<playerCount; ++i) {
+        string name = "loadtest" + to_string(i);
+        local.players()->registerUser(name, "pw");
+        owned[i % conns].push_back(local.players()->playerId(name));
+    }
+
+    netInit();
+    cout << "积分赛压测 127.0.0.1:" << local.port() << ", " << playerCount << " 名玩家, " << conns << " 个连接, "
+         << seconds << " 秒" << endl;
+    vector<RatedStats> stats(conns);
+    vector<thread> threads;
+    auto t0 = Clock::now();
+    for(int i=0; i<conns; ++i) {
+        threads.emplace_back(runRatedConnection, "127.0.0.1", local.port(), owned[i], seconds, 12345u + i, ref(stats[i]));
+    }
+    for(auto& t : threads) t.join();
+    double secs = chrono::duration<double>(Clock::now() - t0).count();
+
+    vector<int> ratings;
+    for(int i=0; i<playerCount; ++i) ratings.push_back(local.players()->ratingOf(i));
+    long long finished = local.ratedFinished;
+    local.stop();
+    fs::current_path(old);
+    error_code ec;
+    fs::remove_all(dir, ec);
+
+    RatedStats total;
+    for(auto& st : stats) {
+        total.matches += st.matches; total.errors += st.errors;
+        total.waitMs.insert(total.waitMs.end(), st.waitMs.begin(), st.waitMs.end());
+    }
+    sort(total.waitMs.begin(), total.waitMs.end());
+    sort(ratings.begin(), ratings.end());
+    auto pct = [&](double p) {
+        if(total.waitMs.empty()) return 0.0f;
+        return total.waitMs[min(total.waitMs.size() - 1, (size_t)(p * total.waitMs.size()))];
+    };
+
+    cout << fixed << setprecision(0);
+    cout << "结算积分赛 " << finished << " 局 (" << finished / secs << "/秒), 玩家看到结果 " << total.matches
+         << " 次, 错误 " << total.errors << endl;
+    cout << setprecision(1);
+    cout << "排队等待 (毫秒): p50 " << pct(0.50) << ", p90 " << pct(0.90) << ", p99 " << pct(0.99)
+         << ", 最大 " << pct(1.0) << endl;
+    cout << "积分: 最低 " << ratings.front() << ", 中位 " << ratings[ratings.size() / 2] << ", 最高 " << ratings.back() << endl;
+    return total.errors > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> args(argv + 1, argv + argc);
+    if(args.size() > 1 && args[0] == "--local" && args[1] == "--rated") return runRated(args);
+    GameServer local;
+    string host = "127.0.0.1";
+    int port = DEFAULT_SERVER_PORT;
+    size_t k = 0;
+    if(!args.empty() && args[0] == "--local") {
+        GameServer::Config cfg;
+        cfg.port = 0;
+        if(!local.start(cfg)) { cerr << "无法启动本地服务器" << endl; return 1; }
+        port = local.port();
+        k = 1;
+    } else {
+        if(args.size() > 0) host = args[0];
+        if(args.size() > 1) port = atoi(args[1].c_str());
+        k = 2;
+    }
+    int conns = args.size() > k ? max(1, atoi(args[k].c_str())) : 4;
+    int inflight = args.size() > k + 1 ? max(1, atoi(args[k + 1].c_str())) : 64;
+    double seconds = args.size() > k + 2 ? atof(args[k + 2].c_str()) : 5.0;
+
+    netInit();
+    cout << "压测 " << host << ":" << port << ", " << conns << " 个连接 x " << inflight << " 局并发, "
+         << seconds << " 秒" << endl;
+
+    vector<ConnStats> stats(conns);
+    vector<thread> threads;
+    auto t0 = Clock::now();
+    for(int i=0; i<conns; ++i) {
+        threads.emplace_back(runConnection, host, port, inflight, seconds, 12345u + i, ref(stats[i]));
+    }
+    for(auto& t : threads) t.join();
+    double secs = chrono::duration<double>(Clock::now() - t0).count();
+    local.stop();
+
+    ConnStats total;
+    for(auto& st : stats) {
+        total.moves += st.moves; total.matches += st.matches; total.errors += st.errors;
+        total.latencyUs.insert(total.latencyUs.end(), st.latencyUs.begin(), st.latencyUs.end());
+    }
+    sort(total.latencyUs.begin(), total.latencyUs.end());
+    auto pct = [&](double p) {
+        if(total.latencyUs.empty()) return 0.0f;
+        return total.latencyUs[min(total.latencyUs.size() - 1, (size_t)(p * total.latencyUs.size()))];
+    };
+
+    cout << fixed << setprecision(0);
+    cout << "出招 " << total.moves / secs << "/秒, 完成对局 " << total.matches / secs << "/秒, 错误 " << total.errors << endl;
+    cout << setprecision(1);
+    cout << "出招往返延迟 (微秒): p50 " << pct(0.50) << ", p90 " << pct(0.90) << ", p99 " << pct(0.99)
+         << ", p99.9 " << pct(0.999) << ", 最大 " << pct(1.0) << endl;
+    return total.errors > 0 ? 1 : 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * 文件名: lockfree_queue.h
+ * 描述: 有界无锁队列 (Dmitry Vyukov 的环形 MPMC 队列)，多个生产者、多个消费者都不需要加锁。
+ * 注意: 每个槽位带一个序号，生产者/消费者各自用一次 CAS 抢占位置；队列满时 push 立即返回 false，
+ *       调用方永远不会被阻塞。
+ */
+#ifndef LOCKFREE_QUEUE_H
+#define LOCKFREE_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+template <class T>
+class BoundedQueue {
+public:
+    // 容量会向上取整为 2 的幂
+    explicit BoundedQueue(size_t capacity) {
+        size_t cap = 2;
+        while(cap < capacity) cap *= 2;
+        mask = cap - 1;
+        cells.reset(new Cell[cap]);
+        for(size_t i=0; i<cap; ++i) cells[i].seq.store(i, std::memory_order_relaxed);
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // 入队；队列已满返回 false (不等待)
+    bool push(T&& value) {
+        Cell* cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for(;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+            if(diff == 0) {
+                if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if(diff < 0) {
+                return false; // 满了
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 出队；队列为空返回 false
+    bool pop(T& out) {
+        Cell* cell;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        for(;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if(diff == 0) {
+                if(dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if(diff < 0) {
+                return false; // 空了
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->data);
+        cell->seq.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    // 生产者和消费者的游标放在不同的缓存行，避免互相干扰
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) std::atomic<size_t> dequeuePos;
+};
+
+#endif
@@ -4,19 +4,44 @@
  */
 
 #include <QApplication>
+#include <QMessageBox>
 #include "main_window.h"
 
 int main(int argc, char *argv[]) {
         // 创建 Qt 应用程序核心对象
     // 它负责管理应用程序的控制流和主要设置
     QApplication a(argc, argv);
+    QStringList args = a.arguments();
+
+    // 命令行带 --trace [文件] 时记录性能追踪 (Chrome 追踪格式，默认 trace.json)，每 10 秒往控制台打印一次耗时摘要
+    // 要在创建主窗口之前打开，这样数据管理器的写线程也能记上名字
+    int traceAt = args.indexOf("--trace");
+    if(traceAt >= 0) {
+        bool hasPath = traceAt + 1 < args.size() && !args[traceAt + 1].startsWith("--");
+        Trace::start(hasPath ? args[traceAt + 1].toStdString() : "trace.json");
+        Trace::nameThread("界面");
+    }
     
     // 创建并显示主窗口
     // 这里并没有使用 new (堆内存)，而是直接在栈上创建，main 函数结束时自动销毁
     MainWindow w;
+
+    // 命令行带 --server 地址:端口 时作为瘦客户端连接对战服务器 (见 server.cpp)
+    int at = args.indexOf("--server");
+    if(at >= 0 && at + 1 < args.size()) {
+        QString addr = args[at + 1];
+        int colon = addr.lastIndexOf(':');
+        QString host = colon >= 0 ? addr.left(colon) : addr;
+        int port = colon >= 0 ? addr.mid(colon + 1).toInt() : DEFAULT_SERVER_PORT;
+        if(!w.connectServer(host.toStdString(), port)) {
+            QMessageBox::warning(nullptr, "提示", "无法连接对战服务器 " + addr + "，将进行本地对战");
+        }
+    }
     w.show(); // 必须调用 show() 窗口才会显示出来
     
     // 进入 Qt 的事件循环 (Event Loop)
     // 程序会在这里“暂停”，等待用户的点击、键盘输入等事件，直到调用 quit()
-    return a.exec(); 
+    int code = a.exec();
+    Trace::stop(); // 写出追踪文件 (没有开启时什么都不做)
+    return code;
 }
\ No newline at end of file
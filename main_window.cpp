@@ -7,13 +7,58 @@
 #include <QHeaderView>
 
 // 构造函数：初始化界面并设置窗口大小
-MainWindow::MainWindow(QWidget *parent) : QWidget(parent) {
+MainWindow::MainWindow(QWidget *parent) : QWidget(parent), battle(dataMgr.heroes), odds(solver) {
+    battle.solver = &solver; // 电脑使用最优策略，而不是简单的加权随机
+    battle.heroBoard = &dataMgr.heroBoard; // 回合结算时同步更新英雄胜率榜
+    refreshMatchups(); // 通常由 build_matchups 在编译后生成；名单已经改过时在后台重建
     initUI();
+
+    catalogReloadTimer = new QTimer(this);
+    catalogReloadTimer->setSingleShot(true);
+    catalogReloadTimer->setInterval(300);
+    connect(catalogReloadTimer, &QTimer::timeout, this, &MainWindow::onHeroCatalogChanged);
+    catalogWatcher = new QFileSystemWatcher(QStringList{ DataManager::HERO_CATALOG_FILE }, this);
+    connect(catalogWatcher, &QFileSystemWatcher::fileChanged, catalogReloadTimer, QOverload<>::of(&QTimer::start));
     resize(800, 600); // 设置窗口默认大小
     setWindowTitle("王者农药");
 }
 
-MainWindow::~MainWindow() {}
+MainWindow::~MainWindow() {
+    matchupCancel = true;
+    if(matchupBuilder.joinable()) matchupBuilder.join();
+}
+
+// 打开对阵表；英雄名单 (内容哈希) 与表不符时在后台线程重建，建好前界面照常可玩，只是不显示评分和克制建议。
+// 返回对阵表现在是否可用
+bool MainWindow::refreshMatchups() {
+    if(matchups.open(MATCHUP_FILE, dataMgr.heroes)) return true;
+    if(!MatchupTable::supports(dataMgr.heroes.size())) return false; // 名单太大，不建表
+    if(matchupBuilding) return false; // 正在重建：建好后 onMatchupsBuilt 会再检查一次名单
+    if(matchupBuilder.joinable()) matchupBuilder.join(); // 上一次的线程已经结束，回收
+    matchupBuilding = true;
+    vector<Hero> roster = dataMgr.heroes; // 后台线程用副本，界面线程可以随时再换名单
+    int threads = max(1, (int)thread::hardware_concurrency() - 1); // 留一个核心给界面
+    matchupBuilder = thread([this, roster, threads]() {
+        bool ok = MatchupTable::build(roster, MATCHUP_FILE, threads, &matchupCancel);
+        matchupBuilding = false;
+        if(!matchupCancel) QMetaObject::invokeMethod(this, [this, ok]() { onMatchupsBuilt(ok); }, Qt::QueuedConnection);
+    });
+    return false;
+}
+
+void MainWindow::onMatchupsBuilt(bool ok) {
+    if(!ok) {
+        labelHeroCatalog->setText(QString("共 %1 个英雄 (阵容对阵表重建失败)").arg(dataMgr.heroes.size()));
+        return;
+    }
+    if(!refreshMatchups()) return; // 重建期间名单又变了：这里打不开，已经开始再建一次
+    heroModel->sync(); // 补上选取评分
+    labelHeroCatalog->setText(QString("共 %1 个英雄 (阵容对阵表已更新)").arg(dataMgr.heroes.size()));
+}
+
+bool MainWindow::connectServer(const string& host, int port) {
+    return remote.connect(host, port);
+}
 
 // 初始化 UI 框架
 void MainWindow::initUI() {
@@ -23,6 +68,15 @@ void MainWindow::initUI() {
     // 就像一副扑克牌，我们通过 setCurrentIndex 来切牌
     stackedWidget = new QStackedWidget(this);
     mainLayout->addWidget(stackedWidget);
+    // 追踪页面切换：从切换开始，到事件循环处理完随之而来的布局和重绘为止
+    connect(stackedWidget, &QStackedWidget::currentChanged, this, [](int) {
+        if(!Trace::on()) return;
+        uint64_t t0 = Trace::now();
+        QTimer::singleShot(0, [t0] {
+            static TraceSite site("MainWindow::switchPage");
+            Trace::span(site, t0, Trace::now());
+        });
+    });
 
     // 按顺序创建 5 个页面，索引分别是 0, 1, 2, 3, 4
     createLoginPage();      // Index 0
@@ -81,7 +135,8 @@ void MainWindow::onBtnLoginClicked() {
     QString p = inputPass->text();
     // 调用逻辑层 DataManager 进行验证
     if(dataMgr.login(u.toStdString(), p.toStdString())) {
-        labelWelcome->setText("欢迎回来，召唤师: " + u);
+        labelWelcome->setText(QString("欢迎回来，召唤师: %1 (积分 %2)").arg(u).arg(dataMgr.currentUser->rating));
+        playerModel = dataMgr.loadMoveModel();
         stackedWidget->setCurrentIndex(1); // 登录成功，跳转到大厅(Index 1)
     } else {
         QMessageBox::warning(this, "错误", "用户名或密码错误");
@@ -131,7 +186,7 @@ void MainWindow::createLobbyPage() {
 }
 
 void MainWindow::onBtnStartGameClicked() {
-    refreshHeroList(); // 加载最新英雄数据
+    if(catalogPending) reloadHeroCatalog(); // 对局中名单文件被改过
     myHeroIndices.clear();
     listSelected->clear();
     stackedWidget->setCurrentIndex(2); // 跳转到选人页
@@ -142,12 +197,23 @@ void MainWindow::createHeroSelectPage() {
     QWidget *page = new QWidget;
     QHBoxLayout *mainLayout = new QHBoxLayout(page); // 左右布局
 
-    // 左边：所有英雄列表
+    // 左边：所有英雄列表 (模型/视图，名单变化时只更新变化的行)
     QGroupBox *grpLeft = new QGroupBox("所有英雄 (双击添加)");
     QVBoxLayout *leftLayout = new QVBoxLayout(grpLeft);
-    listAllHeroes = new QListWidget;
-    connect(listAllHeroes, &QListWidget::itemDoubleClicked, this, &MainWindow::onBtnHeroSelectAddClicked);
-    leftLayout->addWidget(listAllHeroes);
+    inputHeroFilter = new QLineEdit;
+    inputHeroFilter->setPlaceholderText("筛选: 名字 / rock-heavy / 石头型 / 均衡 / r>=3");
+    heroModel = new HeroListModel(dataMgr.heroes, matchups, this);
+    heroFilter = new HeroFilterProxy(heroModel, this);
+    connect(inputHeroFilter, &QLineEdit::textChanged, heroFilter, &HeroFilterProxy::setQuery);
+    heroListView = new QListView;
+    heroListView->setModel(heroFilter);
+    heroListView->setUniformItemSizes(true); // 上千行时不必逐行计算高度
+    heroListView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    connect(heroListView, &QListView::doubleClicked, this, &MainWindow::onBtnHeroSelectAddClicked);
+    labelHeroCatalog = new QLabel;
+    leftLayout->addWidget(inputHeroFilter);
+    leftLayout->addWidget(heroListView);
+    leftLayout->addWidget(labelHeroCatalog);
 
     // 右边：已选阵容
     QGroupBox *grpRight = new QGroupBox("已选阵容 (最多3个)");
@@ -162,29 +228,54 @@ void MainWindow::createHeroSelectPage() {
     mainLayout->addWidget(grpLeft);
     mainLayout->addWidget(grpRight);
 
+    labelHeroCatalog->setText(dataMgr.heroCatalogError.empty()
+            ? QString("共 %1 个英雄").arg(dataMgr.heroes.size())
+            : QString("英雄名单有误，使用内置名单: %1").arg(QString::fromStdString(dataMgr.heroCatalogError)));
+
     stackedWidget->addWidget(page);
 }
 
-// 刷新左侧英雄列表
-void MainWindow::refreshHeroList() {
-    listAllHeroes->clear();
-    for(int i=0; i<dataMgr.heroes.size(); ++i) {
-        const auto& h = dataMgr.heroes[i];
-        QString info = QString::fromStdString(h.name) + 
-                       QString(" (剪%1/石%2/布%3)").arg(h.s).arg(h.r).arg(h.p);
-        QListWidgetItem *item = new QListWidgetItem(info);
-        // 使用 UserRole 存储该英雄在 vector 中的原始索引，方便后续查找
-        item->setData(Qt::UserRole, i); 
-        listAllHeroes->addItem(item);
+// 名单文件变化 (已合并连续的多次通知)
+void MainWindow::onHeroCatalogChanged() {
+    // 编辑器“写临时文件再改名”保存时，原来的文件被替换，需要重新监视
+    if(!catalogWatcher->files().contains(DataManager::HERO_CATALOG_FILE)) catalogWatcher->addPath(DataManager::HERO_CATALOG_FILE);
+    // 对局进行中英雄按下标引用，不能换名单，等下次进选人页再载入
+    if(stackedWidget->currentIndex() == 3) catalogPending = true;
+    else reloadHeroCatalog();
+}
+
+// 重新载入英雄名单：列表只更新变化的行，已选的英雄按名字保留
+void MainWindow::reloadHeroCatalog() {
+    TRACE_SCOPE("MainWindow::reloadHeroCatalog");
+    catalogPending = false;
+    vector<string> picked;
+    for(int i : myHeroIndices) picked.push_back(dataMgr.heroes[i].name);
+    if(!dataMgr.reloadHeroes()) {
+        labelHeroCatalog->setText(QString("英雄名单有误，继续使用原名单: %1").arg(QString::fromStdString(dataMgr.heroCatalogError)));
+        return;
+    }
+    bool ready = refreshMatchups(); // 名单内容变了，旧表失效，在后台重建
+    heroModel->sync();
+    labelHeroCatalog->setText(QString("共 %1 个英雄 (已重新载入%2)").arg(dataMgr.heroes.size())
+            .arg(ready || !matchupBuilding ? "" : "，正在重建阵容对阵表"));
+
+    myHeroIndices.clear();
+    listSelected->clear();
+    for(const string& name : picked) {
+        for(int i=0; i<(int)dataMgr.heroes.size(); ++i) {
+            if(dataMgr.heroes[i].name != name) continue;
+            myHeroIndices.push_back(i);
+            listSelected->addItem(heroModel->data(heroModel->index(i)).toString());
+            break;
+        }
     }
 }
 
 // 双击添加英雄
-void MainWindow::onBtnHeroSelectAddClicked() {
+void MainWindow::onBtnHeroSelectAddClicked(const QModelIndex& index) {
     if(myHeroIndices.size() >= 3) return; // 最多选3个
     
-    QListWidgetItem *item = listAllHeroes->currentItem();
-    int idx = item->data(Qt::UserRole).toInt();
+    int idx = index.data(Qt::UserRole).toInt(); // 视图里是筛选后的行，英雄下标从源模型取
 
     // 查重：防止选择同一个英雄
     for(int i : myHeroIndices) if(i == idx) {
@@ -193,7 +284,7 @@ void MainWindow::onBtnHeroSelectAddClicked() {
     }
 
     myHeroIndices.push_back(idx);
-    listSelected->addItem(item->text());
+    listSelected->addItem(index.data().toString());
 }
 
 // 确认阵容，进入战斗
@@ -223,7 +314,11 @@ void MainWindow::createBattlePage() {
     labelTimer->setAlignment(Qt::AlignCenter);
 
     // 初始化定时器
+    // 截止时刻按本回合开始时的单调时钟 (roundClock) 计算，每次触发后只定到下一个整秒，
+    // 不会像每秒减一那样越走越慢，到期也精确到毫秒
     battleTimer = new QTimer(this);
+    battleTimer->setSingleShot(true);
+    battleTimer->setTimerType(Qt::PreciseTimer);
     // 连接信号：每当定时器“响”一次，就执行 onBattleTimerTick
     connect(battleTimer, &QTimer::timeout, this, &MainWindow::onBattleTimerTick);
     // === 【新增代码结束】 ===
@@ -264,131 +359,138 @@ void MainWindow::createBattlePage() {
 
 // 游戏初始化
 void MainWindow::startNewGame() {
-    currentRound = 1;
-    myScore = 0; cpuScore = 0;
+    TRACE_SCOPE("MainWindow::startNewGame");
     battleLog->clear();
     battleLog->append("=== 战斗开始 ===");
 
-    // 重置我方选中的英雄状态 (满血复活)
-    for(int idx : myHeroIndices) dataMgr.heroes[idx].reset();
-
-    // 电脑随机选 3 个不同的英雄
-    cpuHeroIndices.clear();
-    vector<int> pool;
-    for(int i=0; i<dataMgr.heroes.size(); ++i) pool.push_back(i);
-    // 随机打乱索引数组
-    shuffle(pool.begin(), pool.end(), mt19937(time(0))); 
-    for(int i=0; i<3; ++i) {
-        cpuHeroIndices.push_back(pool[i]);
-        dataMgr.heroes[pool[i]].reset(); // 重置电脑英雄状态
+    // 引擎负责重置双方英雄状态，并让电脑随机选 3 个不同的英雄
+    // 连着服务器时由服务器开局，结果写进 battle 镜像；连接已断开则退回本地对战
+    // 出招模型只在本地对战时使用 (服务器上的电脑看不到它)，但两种模式下都照样学习
+    playerModel.startGame();
+    battle.model = nullptr;
+    if(!remote.isConnected() || !remote.startMatch(battle, myHeroIndices, battle.solver != nullptr)) {
+        if(!remote.isConnected()) battleLog->append("(本地对战)");
+        battle.model = &playerModel;
+        battle.startNewGame(myHeroIndices);
+        if(playerModel.observed() >= BattleEngine::MODEL_MIN_OBSERVED) battleLog->append("电脑已经摸清了你的出招习惯……");
     }
+    matchStartMs = epochMillis();
     
     QString cpuNames;
-    for(int idx : cpuHeroIndices) cpuNames += QString::fromStdString(dataMgr.heroes[idx].name) + " ";
+    for(int idx : battle.cpuHeroIndices) cpuNames += QString::fromStdString(dataMgr.heroes[idx].name) + " ";
     battleLog->append("电脑选择了: " + cpuNames);
+    battleLog->append(QString("本局种子: %1 (对局结束后连同出招一起存入回放文件)").arg(battle.matchSeed));
+
+    // 查表给出克制电脑阵容的最佳阵容，以及我方阵容对它的优势
+    if(matchups.isOpen()) {
+        int cpuLineup = MatchupTable::lineupId(battle.cpuHeroIndices);
+        int counter = matchups.bestCounter(cpuLineup);
+        QString counterNames;
+        for(int idx : MatchupTable::lineupHeroes(counter)) counterNames += QString::fromStdString(dataMgr.heroes[idx].name) + " ";
+        battleLog->append(QString("克制该阵容的最佳选择: %1(优势 %2)，你的阵容优势: %3")
+                .arg(counterNames)
+                .arg(matchups.value(counter, cpuLineup), 0, 'f', 3)
+                .arg(matchups.value(MatchupTable::lineupId(myHeroIndices), cpuLineup), 0, 'f', 3));
+    }
 
     startRound(); // 开始第1回合
 }
 
 // 回合开始逻辑
 void MainWindow::startRound() {
-    if(currentRound > 9) { // 超过9回合，游戏结束
+    TRACE_SCOPE("MainWindow::startRound");
+    if(battle.isOver()) { // 超过9回合，游戏结束
         endGame();
         return;
     }
 
-    labelRoundInfo->setText(QString("--- 第 %1 回合 ---").arg(currentRound));
+    labelRoundInfo->setText(QString("--- 第 %1 回合 ---").arg(battle.currentRound));
 
-    // 1. 电脑选人 (必须有招可用)
-    vector<int> cpuValid;
-    for(int i=0; i<3; ++i) if(dataMgr.heroes[cpuHeroIndices[i]].hasMoves()) cpuValid.push_back(i);
-    
-    if(cpuValid.empty()) {
+    // 1. 电脑选人并预先出招 (此时不告诉玩家出了什么，只记录在引擎中)
+    // 服务器模式下电脑已经在上一次应答之前选好人、出好招，镜像中 currentCpuHeroIndex < 0 表示电脑无牌可出
+    bool cpuReady = remote.isConnected() ? battle.currentCpuHeroIndex >= 0 : battle.prepareRound();
+    if(!cpuReady) {
         battleLog->append("电脑无牌可出，提前认输！");
         endGame();
         return;
     }
     
-    // 电脑随机选一个可用的英雄
-    static mt19937 rng(time(0));
-    currentCpuHeroIndex = cpuValid[rng() % cpuValid.size()];
-    int realCpuIdx = cpuHeroIndices[currentCpuHeroIndex];
-    
-    // 电脑预先出招 (此时不告诉玩家出了什么，只记录在 cpuNextMove)
-    cpuNextMove = dataMgr.heroes[realCpuIdx].makeRandomMove();
-    
-    labelCpuStatus->setText(QString("电脑派出: %1 (已出招)").arg(QString::fromStdString(dataMgr.heroes[realCpuIdx].name)));
+    const Hero& cpuHero = dataMgr.heroes[battle.cpuHeroIndices[battle.currentCpuHeroIndex]];
+    labelCpuStatus->setText(QString("电脑派出: %1 (已出招)").arg(QString::fromStdString(cpuHero.name)));
 
     // 2. 更新我方按钮状态 (UI 交互优化)
-    // 检查我方选中的3个英雄中，是否有剪刀/石头/布
-    bool hasS = false, hasR = false, hasP = false;
-    for(int idx : myHeroIndices) {
-        if(dataMgr.heroes[idx].canUse(SCISSORS)) hasS = true;
-        if(dataMgr.heroes[idx].canUse(ROCK)) hasR = true;
-        if(dataMgr.heroes[idx].canUse(PAPER)) hasP = true;
-    }
-    // 如果没有任何英雄有“剪刀”，则禁用“剪刀”按钮，防止误操作
-    btnScissors->setEnabled(hasS);
-    btnRock->setEnabled(hasR);
-    btnPaper->setEnabled(hasP);
+    updateMoveButtons();
 
     battleLog->append("请出招...");
     // === 【新增代码】 ===
     remainingTime = TIME_LIMIT; // 重置时间
     labelTimer->setText(QString("剩余时间: %1 秒").arg(remainingTime));
-    battleTimer->start(1000); // 启动定时器，参数 1000 代表每 1000毫秒 (1秒) 触发一次
+    roundClock.start();
+    battleTimer->start(1000); // 1 秒后倒计时跳到下一个整秒
+}
+
+// 如果没有任何英雄有“剪刀”，则禁用“剪刀”按钮，防止误操作；
+// 能出的招在按钮上标出“现在出这一招，最终赢下本局的概率” (第一回合之后只是查表，见 win_odds.h)；
+// 本回合按看到电脑派出的英雄之后电脑实际的出招分布算，之后各回合只能估计，标成“约”
+void MainWindow::updateMoveButtons() {
+    TRACE_SCOPE("MainWindow::updateMoveButtons");
+    double p[3], mix[3];
+    bool revealed = battle.revealedCpuMix(mix);
+    if(revealed) odds.moveOdds(battle.publicState(), mix, p);
+    else odds.moveOdds(battle.publicState(), p);
+    QPushButton* buttons[3] = { btnScissors, btnRock, btnPaper };
+    for(int m=SCISSORS; m<=PAPER; ++m) {
+        QString name = QString::fromStdString(moveToString((MoveType)m));
+        buttons[m]->setEnabled(battle.canUse((MoveType)m));
+        buttons[m]->setText(p[m] < 0 ? name : QString(revealed ? "%1 (胜率约 %2%)" : "%1 (胜率 %2%)").arg(name).arg(100 * p[m], 0, 'f', 1));
+    }
 }
 
 // 结算回合逻辑
-void MainWindow::endRound(MoveType myMove) {
+void MainWindow::endRound(MoveType myMove, bool timedOut) {
+    TRACE_SCOPE("MainWindow::endRound");
     // === 【新增代码】 ===
     battleTimer->stop(); // 玩家已操作，停止计时！
-    // 1. 玩家出招：系统自动寻找我方第一个拥有该招数的英雄 (简化逻辑)
-    int realMyIdx = -1;
-    for(int idx : myHeroIndices) {
-        if(dataMgr.heroes[idx].canUse(myMove)) {
-            realMyIdx = idx;
-            break;
+    // 结算后到下一回合开始前有 1 秒停顿，这期间按钮不能再点 (startRound 里 updateMoveButtons 重新启用)
+    btnScissors->setEnabled(false);
+    btnRock->setEnabled(false);
+    btnPaper->setEnabled(false);
+    // 1. 引擎负责：寻找我方第一个拥有该招数的英雄、扣库存、胜负判定、更新榜单数据
+    RoundResult r;
+    if(remote.isConnected()) {
+        // 超时时 myMove 为 NONE，由服务器用本局的随机数代出
+        if(!remote.playRound(battle, myMove, timedOut, r)) {
+            QMessageBox::warning(this, "错误", "与对战服务器的连接已断开，本局作废");
+            stackedWidget->setCurrentIndex(1);
+            return;
         }
+    } else {
+        r = battle.playRound(myMove);
     }
-    
-    Hero& myHero = dataMgr.heroes[realMyIdx];
-    myHero.useMove(myMove); // 扣除库存
-
-    Hero& cpuHero = dataMgr.heroes[cpuHeroIndices[currentCpuHeroIndex]];
+    if(r.round == 0) return; // 引擎没有结算 (本回合已经结算过，或本局已打完)，没有回合记录可写
+    // 思考时长和是否超时只有界面知道，补进引擎的回合记录里
+    battle.rounds.back().thinkMs = (int)roundClock.elapsed();
+    timedOut = timedOut || r.timedOut; // 服务器可能已经按它的出招时限代出
+    battle.rounds.back().timedOut = timedOut;
+    playerModel.record(r.myMove, timedOut);
+    dataMgr.recordHeroRound(r.myHero, r.cpuHero, r.myMove, r.cpuMove, r.outcome); // 英雄战绩 (累计 + 滚动窗口) 写盘
 
-    // 2. 胜负判定算法
-    // (0-2=-2 -> +3=1 -> %3=1)
-    int res = (myMove - cpuNextMove + 3) % 3;
     QString resultStr;
-    
-    // 更新局内数据和全局榜单数据
-    myHero.totalMatches++;
-    cpuHero.totalMatches++;
-
-    if(res == 1) { // 胜
-        resultStr = "胜";
-        myScore++;
-        myHero.winMatches++;
-    } else if (res == 2) { // 负
-        resultStr = "负";
-        cpuScore++;
-    } else {
-        resultStr = "平";
-    }
+    if(r.outcome == OUTCOME_WIN) resultStr = "胜";
+    else if(r.outcome == OUTCOME_LOSS) resultStr = "负";
+    else resultStr = "平";
 
-    // 3. 记录日志
+    // 2. 记录日志
     QString log = QString("我方[%1]出%2 vs 电脑[%3]出%4 -> %5")
-            .arg(QString::fromStdString(myHero.name))
-            .arg(QString::fromStdString(moveToString(myMove)))
-            .arg(QString::fromStdString(cpuHero.name))
-            .arg(QString::fromStdString(moveToString(cpuNextMove)))
+            .arg(QString::fromStdString(dataMgr.heroes[r.myHero].name))
+            .arg(QString::fromStdString(moveToString(r.myMove)))
+            .arg(QString::fromStdString(dataMgr.heroes[r.cpuHero].name))
+            .arg(QString::fromStdString(moveToString(r.cpuMove)))
             .arg(resultStr);
     
     battleLog->append(log);
 
-    // 4. 准备下一回合
-    currentRound++;
+    // 3. 准备下一回合
     // 使用 QTimer 延迟 1秒 进入下一回合，给玩家看清楚结果的时间
     QTimer::singleShot(1000, this, &MainWindow::startRound);
 }
@@ -399,11 +501,12 @@ void MainWindow::onUsePaper() { endRound(PAPER); }
 
 // 游戏结束结算
 void MainWindow::endGame() {
+    TRACE_SCOPE("MainWindow::endGame");
+    int myScore = battle.myScore, cpuScore = battle.cpuScore;
     QString finalMsg = QString("游戏结束！\n比分 %1 : %2\n").arg(myScore).arg(cpuScore);
     if(myScore > cpuScore) {
         finalMsg += "你赢了！";
-        dataMgr.currentUser->totalWins++; // 增加玩家胜场
-        dataMgr.savePlayers(); // 立即存盘
+        dataMgr.recordWin(); // 增加玩家胜场 (追加一条日志，立即落盘)
     } else if(myScore < cpuScore) {
         finalMsg += "你输了。";
     } else {
@@ -411,9 +514,9 @@ void MainWindow::endGame() {
     }
     QMessageBox::information(this, "结果", finalMsg);
     
-    // 记录对战历史到文件
-    ofstream file("gamedata.txt", ios::app);
-    file << "Game: " << dataMgr.currentUser->username << " " << myScore << ":" << cpuScore << endl;
+    // 记录对战历史：只把完整记录交给写线程，写文件不阻塞界面
+    history.submit(MatchRecord::fromEngine(battle, dataMgr.currentUser->username, matchStartMs));
+    dataMgr.saveMoveModel(playerModel);
     
     stackedWidget->setCurrentIndex(1); // 回大厅
 }
@@ -423,41 +526,75 @@ void MainWindow::createRankPage() {
     QWidget *page = new QWidget;
     QVBoxLayout *layout = new QVBoxLayout(page);
     
-    textRank = new QTextEdit;
-    textRank->setReadOnly(true);
-    
+    // 玩家榜：表格视图 + 分页模型，滚到底才去取下一页
+    inputRankSearch = new QLineEdit;
+    inputRankSearch->setPlaceholderText("搜索用户名 (前缀)");
+    rankModel = new PlayerRankModel(dataMgr, this);
+    connect(inputRankSearch, &QLineEdit::textChanged, rankModel, &PlayerRankModel::setSearch);
+
+    rankView = new QTableView;
+    rankView->setModel(rankModel);
+    rankView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    rankView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    rankView->verticalHeader()->hide();
+    rankView->horizontalHeader()->setStretchLastSection(true);
+    rankView->horizontalHeader()->setSortIndicator(PlayerRankModel::COL_RANK, Qt::AscendingOrder);
+
+    labelMyRank = new QLabel;
+
+    // 英雄榜
+    heroRankTable = new QTableWidget(0, 4);
+    heroRankTable->setHorizontalHeaderLabels({ "英雄", "胜率", "出场回合", "近 7 天" });
+    heroRankTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    heroRankTable->verticalHeader()->hide();
+    heroRankTable->horizontalHeader()->setStretchLastSection(true);
+
     QPushButton *btnBack = new QPushButton("返回大厅");
     connect(btnBack, &QPushButton::clicked, this, &MainWindow::onBtnBackToLobbyClicked);
 
-    layout->addWidget(new QLabel("排行榜"));
-    layout->addWidget(textRank);
+    QHBoxLayout *tables = new QHBoxLayout;
+    QVBoxLayout *playerCol = new QVBoxLayout;
+    playerCol->addWidget(new QLabel("玩家榜 (点击表头排序)"));
+    playerCol->addWidget(inputRankSearch);
+    playerCol->addWidget(rankView);
+    playerCol->addWidget(labelMyRank);
+    QVBoxLayout *heroCol = new QVBoxLayout;
+    heroCol->addWidget(new QLabel("英雄胜率榜"));
+    heroCol->addWidget(heroRankTable);
+    tables->addLayout(playerCol, 2);
+    tables->addLayout(heroCol, 1);
+
+    layout->addLayout(tables);
     layout->addWidget(btnBack);
     
     stackedWidget->addWidget(page);
 }
 
 void MainWindow::onBtnRankClicked() {
-    stringstream ss;
-    ss << "=== 玩家胜场榜 ===\n";
-    
-    // 复制并排序玩家列表
-    vector<Player> sortedP = dataMgr.players;
-    sort(sortedP.begin(), sortedP.end(), [](const Player& a, const Player& b){
-        return a.totalWins > b.totalWins;
-    });
-    for(auto& p : sortedP) ss << p.username << "\t" << p.totalWins << "胜\n";
+    TRACE_SCOPE("MainWindow::onBtnRankClicked");
+    // 玩家榜只重新取第一页 (胜场可能刚变过)，其余页等滚动时再取
+    // 第一次打开时才启用排序：启用时视图会按表头指示立即排序取数，排行索引也在这时才建立
+    if(!rankView->isSortingEnabled()) rankView->setSortingEnabled(true); // 之后点击表头时调用模型的 sort()
+    else rankModel->reload();
+    if(dataMgr.currentUser) {
+        labelMyRank->setText(QString("你的排名: 第 %1 名 / 共 %2 人，积分 %3")
+                .arg(dataMgr.rankOf(dataMgr.currentUserId()))
+                .arg(dataMgr.playerCount())
+                .arg(dataMgr.currentUser->rating));
+    }
 
-    ss << "\n=== 英雄胜率榜 ===\n";
-    // 复制并排序英雄列表
-    vector<Hero> sortedH = dataMgr.heroes;
-    sort(sortedH.begin(), sortedH.end(), [](const Hero& a, const Hero& b){
-        return a.getWinRate() > b.getWinRate();
-    });
-    for(auto& h : sortedH) {
-        ss << h.name << "\t" << (int)h.getWinRate() << "% (" << h.totalMatches << "场)\n"; 
+    vector<int> heroIds = dataMgr.heroBoard.top(HERO_RANK_ROWS);
+    heroRankTable->setRowCount(heroIds.size());
+    for(int row=0; row<(int)heroIds.size(); ++row) {
+        const Hero& h = dataMgr.heroes[heroIds[row]];
+        heroRankTable->setItem(row, 0, new QTableWidgetItem(QString::fromStdString(h.name)));
+        heroRankTable->setItem(row, 1, new QTableWidgetItem(QString("%1%").arg(h.getWinRate(), 0, 'f', 1)));
+        heroRankTable->setItem(row, 2, new QTableWidgetItem(QString::number(h.totalMatches)));
+        HeroTally week = dataMgr.heroRecord(heroIds[row], HeroLedger::LAST_WEEK); // 只加 7 个天桶
+        heroRankTable->setItem(row, 3, new QTableWidgetItem(week.rounds
+                ? QString("%1% (%2 回合)").arg(week.winRate(), 0, 'f', 1).arg(week.rounds) : QString("-")));
     }
 
-    textRank->setText(QString::fromStdString(ss.str()));
     stackedWidget->setCurrentIndex(4);
 }
 
@@ -466,32 +603,27 @@ void MainWindow::onBtnBackToLobbyClicked() {
 }
 
 void MainWindow::onBattleTimerTick() {
-    remainingTime--; // 时间减 1
+    TRACE_SCOPE("MainWindow::onBattleTimerTick");
+    qint64 leftMs = TIME_LIMIT * 1000LL - roundClock.elapsed(); // 离截止时刻还有多少毫秒
+    remainingTime = (int)max<qint64>(0, (leftMs + 999) / 1000);
     labelTimer->setText(QString("剩余时间: %1 秒").arg(remainingTime));
+    if (leftMs > 0) battleTimer->start((int)(leftMs - (remainingTime - 1) * 1000LL)); // 定到下一个整秒 (最后一秒就是截止时刻)
 
     // 如果时间到了 0 (或小于0)
-    if (remainingTime <= 0) {
-        battleTimer->stop(); // 停止计时
+    if (leftMs <= 0) {
         battleLog->append(">>> ⚠ 思考超时！系统自动为您随机出招！");
 
-        // --- 随机替玩家选一个可用的招数 ---
-        vector<MoveType> validMoves;
-        // 检查我方选中的3个英雄，把所有能用的招数都收集起来
-        for (int idx : myHeroIndices) {
-            if (dataMgr.heroes[idx].canUse(SCISSORS)) validMoves.push_back(SCISSORS);
-            if (dataMgr.heroes[idx].canUse(ROCK))     validMoves.push_back(ROCK);
-            if (dataMgr.heroes[idx].canUse(PAPER))    validMoves.push_back(PAPER);
+        if (remote.isConnected()) {
+            endRound(NONE, true); // 服务器模式：随机代出也在服务器上完成
+            return;
         }
 
-        // 理论上 validMoves 不会为空，因为 startRound 检查过是否有招
-        if (!validMoves.empty()) {
-            // 随机选一个索引
-            static mt19937 rng(time(0));
-            int randIndex = rng() % validMoves.size();
-            MoveType randomMove = validMoves[randIndex];
-            
+        // --- 随机替玩家选一个可用的招数 ---
+        // 理论上一定有招可出，因为 startRound 检查过是否有招
+        MoveType randomMove = battle.randomAvailableMove();
+        if (randomMove != NONE) {
             // 就像玩家自己点了一样，调用 endRound
-            endRound(randomMove);
+            endRound(randomMove, true);
         } else {
             // 极端情况（不应该发生）：无招可出
             battleLog->append("错误：无招可出。");
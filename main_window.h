@@ -13,11 +13,24 @@
 #include <QLineEdit>
 #include <QStackedWidget> // 用于实现多页面切换
 #include <QListWidget>
+#include <QListView>
+#include <QFileSystemWatcher>
 #include <QMessageBox>
 #include <QTextEdit>
 #include <QGroupBox>
 #include <QTimer>
+#include <QTableView>
+#include <QTableWidget>
+#include <QElapsedTimer>
 #include "game_data.h" // 引入逻辑层
+#include "battle_engine.h" // 对战规则
+#include "matchup_table.h" // 阵容对阵表
+#include "match_history.h" // 对战记录 (后台线程写盘)
+#include "game_client.h" // 对战服务器客户端
+#include "leaderboard_model.h" // 排行榜表格模型
+#include "hero_list_model.h" // 选人列表模型 (带筛选索引)
+#include "trace.h" // 性能追踪 (--trace 时开启)
+#include "win_odds.h" // 出招胜率
 
 class MainWindow : public QWidget {
     Q_OBJECT // [核心] 必须加上这个宏，才能使用 Qt 的信号与槽机制 (Signal & Slot)
@@ -26,17 +39,30 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // 连接对战服务器：连上后对局在服务器上进行，本窗口只负责显示和输入
+    bool connectServer(const string& host, int port);
+
 private:
     // --- 数据模型 ---
     DataManager dataMgr;       // 数据管理器实例
     vector<int> myHeroIndices; // 玩家选中的3个英雄在 allHeroes 中的索引
-    vector<int> cpuHeroIndices; // 电脑选中的3个英雄的索引
     
     // --- 游戏运行时状态 ---
-    int currentRound;          // 当前回合数 (1-9)
-    int myScore, cpuScore;     // 双方得分
-    int currentCpuHeroIndex;   // 电脑当前派出的是第几个英雄
-    MoveType cpuNextMove;      // 电脑本回合预先决定出的招 (作弊防止：先算好，后展示)
+    // 回合数、比分、电脑预先出的招等都保存在对战引擎中，界面只负责展示
+    BattleEngine battle;
+    GameSolver solver;         // 博弈求解器：电脑按均衡策略出招，置换表在多局之间复用
+    WinOdds odds;              // 出招胜率 (显示在出招按钮上)，与电脑共用求解器，结果跨回合、跨对局复用
+    MoveModel playerModel;     // 当前玩家的出招习惯：登录时读出，每回合更新，每局结束存回；本地对战时电脑据此针对性出招
+    MatchupTable matchups;     // 离线算好的阵容对阵表 (内存映射，文件缺失或过期时不可用)
+    // 名单变化后在后台线程重建对阵表 (同一时刻最多一个)，建好后回到界面线程打开；关闭窗口时取消并等它结束
+    thread matchupBuilder;
+    atomic<bool> matchupBuilding{false};
+    atomic<bool> matchupCancel{false};
+    static constexpr const char* MATCHUP_FILE = "matchups.bin";
+    HistoryWriter history;     // 对战记录写线程：结算时只入队，不等磁盘
+    GameClient remote;         // 连接了对战服务器时使用；battle 此时只是服务器对局状态的镜像
+    long long matchStartMs = 0; // 本局开始时间 (Unix 毫秒)
+    QElapsedTimer roundClock;  // 本回合从“请出招”开始计时，记录玩家思考时长
 
     // --- UI 组件 (指针) ---
     // 使用指针是为了在堆上管理内存，并在不同函数间访问这些控件
@@ -49,8 +75,17 @@ private:
     QLabel *labelWelcome;
 
     // Page 3: 英雄选择
-    QListWidget *listAllHeroes; // 左侧列表
-    QListWidget *listSelected;  // 右侧已选列表
+    QLineEdit *inputHeroFilter;   // 边输入边筛选 (名字 / rock-heavy / r>=3 ...)
+    QListView *heroListView;      // 左侧列表
+    HeroListModel *heroModel;
+    HeroFilterProxy *heroFilter;
+    QLabel *labelHeroCatalog;     // 英雄数量，或名单文件的错误
+    QListWidget *listSelected;    // 右侧已选列表
+
+    // 英雄名单文件 (heroes.txt) 的热更新：文件一变就重新载入，对局进行中则等到下次进选人页
+    QFileSystemWatcher *catalogWatcher;
+    QTimer *catalogReloadTimer;   // 编辑器保存时可能连续触发好几次，合并成一次载入
+    bool catalogPending = false;
     
     // Page 4: 战斗界面
     QTextEdit *battleLog;       // 战斗日志显示框
@@ -60,14 +95,19 @@ private:
     QPushButton *btnScissors, *btnRock, *btnPaper; // 出招按钮
     
     // Page 5: 排行榜
-    QTextEdit *textRank;
+    QLineEdit *inputRankSearch;     // 按用户名前缀搜索
+    QTableView *rankView;           // 玩家榜：只显示模型取出的那几页
+    PlayerRankModel *rankModel;
+    QLabel *labelMyRank;            // 我的名次
+    QTableWidget *heroRankTable;    // 英雄胜率榜 (只显示前 HERO_RANK_ROWS 名，直接填表)
+    static const int HERO_RANK_ROWS = 100;
 
 
     // === 【新增】定时器相关变量 ===
-    QTimer *battleTimer;    // 定时器对象
-    int remainingTime;      // 剩余秒数
+    QTimer *battleTimer;    // 定时器对象 (单次、精确定时，每次只定到下一个整秒或截止时刻)
+    int remainingTime;      // 剩余秒数 (向上取整，仅用于显示)
     QLabel *labelTimer;     // 用于在界面显示倒计时的文字
-    const int TIME_LIMIT = 10; // 设定超时时间，例如 10 秒
+    const int TIME_LIMIT = TURN_TIME_LIMIT; // 超时时间 (秒)，与服务器的出招时限一致
 
     // --- 界面构建函数 (将UI代码拆分，保持整洁) ---
     void initUI();
@@ -78,10 +118,13 @@ private:
     void createRankPage();
 
     // --- 游戏流程逻辑 ---
-    void refreshHeroList();         // 刷新选人列表
+    void reloadHeroCatalog();       // 重新载入英雄名单并增量更新选人列表
+    bool refreshMatchups();         // 打开对阵表；与当前名单不符时在后台重建
+    void onMatchupsBuilt(bool ok);  // 后台重建结束 (界面线程)
     void startNewGame();            // 初始化新游戏数据
     void startRound();              // 开始一个新的回合
-    void endRound(MoveType myMove); // 结算当前回合
+    void updateMoveButtons();       // 刷新出招按钮：能否点击、每招的胜率
+    void endRound(MoveType myMove, bool timedOut = false); // 结算当前回合 (timedOut: 超时由系统代出)
     void endGame();                 // 9回合结束，结算胜负
 
 private slots: 
@@ -89,7 +132,8 @@ private slots:
     void onBtnLoginClicked();
     void onBtnRegisterClicked();
     void onBtnStartGameClicked();       // 大厅点击开始游戏
-    void onBtnHeroSelectAddClicked();   // 双击添加英雄
+    void onBtnHeroSelectAddClicked(const QModelIndex& index); // 双击添加英雄
+    void onHeroCatalogChanged();        // 名单文件被修改
     void onBtnHeroSelectConfirmClicked(); // 确认阵容
     void onBtnRankClicked();            // 查看排行
     void onBtnBackToLobbyClicked();     // 返回大厅
@@ -98,7 +142,7 @@ private slots:
     void onUseScissors();
     void onUseRock();
     void onUsePaper();
-    void onBattleTimerTick(); // 每秒触发一次，用于更新倒计时和判断超时
+    void onBattleTimerTick(); // 倒计时跳到下一个整秒或到达截止时刻时触发，用于更新倒计时和判断超时
 };
 
 #endif // MAIN_WINDOW_H
\ No newline at end of file
@@ -0,0 +1,107 @@
+/**
+ * 文件名: mapped_file.h
+ * 描述: 只读内存映射文件 - 把整个文件映射进地址空间，按指针直接访问，不做任何解析。
+ * 注意: Windows 下使用 CreateFileMapping / MapViewOfFile，其他平台使用 mmap。
+ *       文件末尾另有两个写文件用的小工具：落盘 (fsync) 和原子替换 (写临时文件再改名)。
+ */
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+#include <cstdio>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+class MappedFile {
+public:
+    MappedFile() {}
+    ~MappedFile() { close(); }
+
+    // 禁止拷贝：映射只能有一个所有者
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 映射文件，失败 (文件不存在、为空等) 返回 false
+    bool open(const std::string& path) {
+        close();
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if(file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        if(!GetFileSizeEx(file, &sz) || sz.QuadPart == 0) { CloseHandle(file); return false; }
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        CloseHandle(file); // 映射对象持有文件引用，句柄可以先关
+        if(!mapping) return false;
+        void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if(!p) return false;
+        ptr = (const char*)p;
+        len = (size_t)sz.QuadPart;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) return false;
+        struct stat st;
+        if(fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+        void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // 映射建立后文件描述符就不再需要了
+        if(p == MAP_FAILED) return false;
+        ptr = (const char*)p;
+        len = (size_t)st.st_size;
+#endif
+        return true;
+    }
+
+    void close() {
+        if(!ptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(ptr);
+#else
+        munmap((void*)ptr, len);
+#endif
+        ptr = nullptr;
+        len = 0;
+    }
+
+    bool isOpen() const { return ptr != nullptr; }
+    const char* data() const { return ptr; }
+    size_t size() const { return len; }
+
+private:
+    const char* ptr = nullptr;
+    size_t len = 0;
+};
+
+// 把已写入的内容真正写到磁盘上 (断电也不丢)，调用前应先 fflush
+inline bool syncFile(FILE* f) {
+    if(!f) return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// 用 from 原子地替换 to：任何时刻 to 要么是旧文件，要么是完整的新文件
+// (POSIX rename 本身可以覆盖；Windows 的 rename 不能覆盖已存在的文件，改用 MoveFileEx)
+inline bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+#endif
@@ -0,0 +1,217 @@
+/**
+ * 文件名: match_history.h
+ * 描述: 对战记录 - 每局比赛的完整结构化记录，以及把记录异步写入 gamedata.txt 的后台线程。
+ * 注意: 游戏线程只做一次无锁入队，永远不会等待磁盘；写线程把记录攒成大块顺序写入，
+ *       按大小或时间刷盘，退出时 fsync。
+ * 格式: 每局一行，开头保持旧格式 "Game: 用户名 我方分:电脑分"，后面追加结构化字段：
+ *       t=开始时间(毫秒) d=时长(毫秒) my=我方阵容 cpu=电脑阵容 rounds=回合;回合;...
+ *       回合 = 我方英雄:招-电脑英雄:招:结果:思考毫秒[:T]  (招为 S/R/P，结果为 W/L/D，T 表示超时)
+ *       同时把每局的回放记录 (种子 + 玩家输入，见 replay.h) 追加到回放文件，
+ *       并写入列式记录 (见 history_store.h) 供 history_query 统计。列式记录按块写出，
+ *       进程被杀时最后不满一块的部分会丢失，gamedata.txt 是完整记录，可用 history_query import 重建。
+ */
+#ifndef MATCH_HISTORY_H
+#define MATCH_HISTORY_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include "battle_engine.h"
+#include "lockfree_queue.h"
+#include "replay.h"
+#include "history_store.h"
+
+// 当前时间 (Unix 毫秒)
+inline long long epochMillis() {
+    return chrono::duration_cast<chrono::milliseconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// 一局比赛的完整记录
+struct MatchRecord {
+    string username;
+    vector<int> myLineup, cpuLineup;
+    vector<RoundResult> rounds;
+    long long startMs = 0, endMs = 0;
+    int myScore = 0, cpuScore = 0;
+    ReplayRecord replay = {};  // 同一局的回放记录
+
+    // 从引擎当前 (已结束) 的对局生成记录
+    static MatchRecord fromEngine(const BattleEngine& e, const string& user, long long startMs) {
+        MatchRecord r;
+        r.username = user;
+        r.myLineup = e.myHeroIndices;
+        r.cpuLineup = e.cpuHeroIndices;
+        r.rounds.assign(e.rounds.begin(), e.rounds.begin() + min(e.rounds.size(), (size_t)MAX_ROUNDS)); // 与回放记录一致
+        r.startMs = startMs;
+        r.endMs = epochMillis();
+        r.myScore = e.myScore;
+        r.cpuScore = e.cpuScore;
+        r.replay = ReplayRecord::fromEngine(e);
+        return r;
+    }
+
+    // 序列化为一行文本 (追加到 out 末尾)
+    void appendTo(string& out) const {
+        static const char MOVE_CHAR[] = { 'S', 'R', 'P' };
+        static const char RESULT_CHAR[] = { 'D', 'W', 'L' };
+        char buf[64];
+        out += "Game: ";
+        out += username;
+        snprintf(buf, sizeof(buf), " %d:%d t=%lld d=%lld", myScore, cpuScore, startMs, endMs - startMs);
+        out += buf;
+        auto lineup = [&](const char* key, const vector<int>& ids) {
+            out += key;
+            for(size_t i=0; i<ids.size(); ++i) {
+                if(i) out += ',';
+                out += to_string(ids[i]);
+            }
+        };
+        lineup(" my=", myLineup);
+        lineup(" cpu=", cpuLineup);
+        out += " rounds=";
+        for(size_t i=0; i<rounds.size(); ++i) {
+            const RoundResult& r = rounds[i];
+            snprintf(buf, sizeof(buf), "%s%d:%c-%d:%c:%c:%d%s", i ? ";" : "",
+                     r.myHero, MOVE_CHAR[r.myMove], r.cpuHero, MOVE_CHAR[r.cpuMove],
+                     RESULT_CHAR[r.outcome], r.thinkMs, r.timedOut ? ":T" : "");
+            out += buf;
+        }
+        out += '\n';
+    }
+};
+
+// ==========================================
+// 类: HistoryWriter (对战记录写线程)
+// 描述: submit 只做一次无锁入队；后台线程攒批写入，满 flushBytes 或距上次刷盘超过 flushIntervalMs 就写出
+// ==========================================
+class HistoryWriter {
+public:
+    struct Config {
+        string path = "gamedata.txt";
+        string replayPath = "replays.bin"; // 为空则不写回放
+        string columnarPath = "history.kpc"; // 为空则不写列式记录
+        size_t flushBytes = 1 << 20;   // 缓冲区攒到这么多字节就写出
+        int flushIntervalMs = 1000;    // 最长多久写出一次
+        size_t queueCapacity = 1 << 16;
+    };
+
+    atomic<long long> written{0};  // 已写出的记录数
+    atomic<long long> dropped{0};  // 队列满时丢弃的记录数
+    atomic<long long> flushes{0};  // 实际写文件的次数
+
+    HistoryWriter() : HistoryWriter(Config()) {}
+
+    explicit HistoryWriter(const Config& c) : config(c), queue(c.queueCapacity) {
+        worker = thread(&HistoryWriter::run, this);
+    }
+
+    ~HistoryWriter() { stop(); }
+
+    // 提交一条记录，不阻塞；队列满时丢弃并计数，返回 false
+    bool submit(MatchRecord&& r) {
+        if(!queue.push(move(r))) { dropped++; return false; }
+        if(pending.fetch_add(1, memory_order_relaxed) == 0) cv.notify_one();
+        return true;
+    }
+
+    // 批量工具 (模拟器等) 用：队列满时让出 CPU 等待写线程，不丢记录
+    void submitWait(MatchRecord&& r) {
+        while(!queue.push(move(r))) {
+            cv.notify_one();
+            this_thread::yield();
+        }
+        if(pending.fetch_add(1, memory_order_relaxed) == 0) cv.notify_one();
+    }
+
+    // 写完队列中剩余的记录，fsync 后结束写线程 (可以重复调用)
+    void stop() {
+        if(!worker.joinable()) return;
+        {
+            lock_guard<mutex> lk(mtx);
+            stopping = true;
+        }
+        cv.notify_one();
+        worker.join();
+    }
+
+private:
+    Config config;
+    BoundedQueue<MatchRecord> queue;
+    atomic<long long> pending{0}; // 已入队但还没被写线程取走的记录数 (只用于唤醒)
+    thread worker;
+    mutex mtx;                    // 只用于条件变量等待，生产者从不持有
+    condition_variable cv;
+    bool stopping = false;
+
+    void run() {
+        FILE* file = fopen(config.path.c_str(), "ab");
+        ReplayLog replayLog;
+        bool replays = !config.replayPath.empty() && replayLog.open(config.replayPath);
+        HistoryStoreWriter store;
+        bool columnar = !config.columnarPath.empty() && store.open(config.columnarPath);
+        string buffer;
+        buffer.reserve(config.flushBytes + 4096);
+        vector<ReplayRecord> replayBuffer;
+        auto lastFlush = chrono::steady_clock::now();
+
+        auto flush = [&]() {
+            if(!buffer.empty() && file) {
+                fwrite(buffer.data(), 1, buffer.size(), file);
+                fflush(file);
+                flushes++;
+            }
+            if(!replayBuffer.empty() && replays) {
+                replayLog.append(replayBuffer.data(), replayBuffer.size());
+                fflush(replayLog.handle());
+            }
+            buffer.clear();
+            replayBuffer.clear();
+            lastFlush = chrono::steady_clock::now();
+        };
+        auto append = [&](const MatchRecord& r) {
+            r.appendTo(buffer);
+            if(replays) replayBuffer.push_back(r.replay);
+            if(columnar) store.add(r.username, r.myLineup, r.cpuLineup, r.rounds, r.startMs, r.endMs, r.myScore, r.cpuScore);
+        };
+
+        for(;;) {
+            MatchRecord r;
+            long long n = 0;
+            while(queue.pop(r)) {
+                append(r);
+                n++;
+                if(buffer.size() >= config.flushBytes) flush();
+            }
+            if(n) { written += n; pending.fetch_sub(n, memory_order_relaxed); }
+
+            auto interval = chrono::milliseconds(config.flushIntervalMs);
+            if(chrono::steady_clock::now() - lastFlush >= interval) flush();
+
+            unique_lock<mutex> lk(mtx);
+            if(stopping) {
+                lk.unlock();
+                while(queue.pop(r)) { append(r); written++; }
+                break;
+            }
+            // 生产者不持锁通知，可能错过一次唤醒，所以等待设置超时上限
+            cv.wait_for(lk, min(interval, chrono::milliseconds(50)),
+                        [this]{ return stopping || pending.load(memory_order_relaxed) > 0; });
+        }
+
+        flush();
+        syncFile(file);
+        if(file) fclose(file);
+        if(replays) syncFile(replayLog.handle());
+        if(columnar) {
+            store.flush();
+            syncFile(store.handle());
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,203 @@
+/**
+ * 文件名: matchmaking.h
+ * 描述: 积分与匹配 - Elo 积分计算，以及按积分分桶的匹配队列。
+ * 匹配规则: 每名排队玩家有一个可接受的积分差 (窗口)，初始较窄，随排队时间线性放宽到上限；
+ *       从排队最久的玩家开始，在他的窗口内挑积分最接近的桶里排队最久的人配对。
+ * 结构: 积分按 bucketWidth 分桶，每个桶是一条先进先出的链表；另有一条按入队时间串起所有人的链表。
+ *       入队、出队都是 O(1)，找对手只看窗口覆盖的那几个桶：整个落在窗口内的桶取队头即可，
+ *       窗口边上的桶要顺着链表找第一个在窗口内的人 (最多走完这一个桶)。
+ *       桶按距离由近到远查看，同一个桶内按排队先后取，所以配到的对手积分差可能比最优的多出最多一个桶宽。
+ */
+#ifndef MATCHMAKING_H
+#define MATCHMAKING_H
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include "player_store.h"
+
+using namespace std;
+
+// ==========================================
+// Elo 积分
+// ==========================================
+const int ELO_PROVISIONAL_GAMES = 30; // 前 30 场为定级赛，积分变化更快
+
+// a 对 b 的期望得分 (0~1)
+inline double eloExpected(int ratingA, int ratingB) {
+    return 1.0 / (1.0 + pow(10.0, (ratingB - ratingA) / 400.0));
+}
+
+inline int eloK(const Player& p) {
+    return p.ratedGames < ELO_PROVISIONAL_GAMES ? 40 : 20;
+}
+
+// 结算一场积分赛：scoreA 为 a 的得分 (胜 1，平 0.5，负 0)
+inline void eloApply(Player& a, Player& b, double scoreA) {
+    double ea = eloExpected(a.rating, b.rating);
+    int da = (int)lround(eloK(a) * (scoreA - ea));
+    int db = (int)lround(eloK(b) * ((1.0 - scoreA) - (1.0 - ea)));
+    a.rating = max(0, a.rating + da);
+    b.rating = max(0, b.rating + db);
+    a.ratedGames++;
+    b.ratedGames++;
+}
+
+// 一次配对的结果
+struct MatchPair {
+    int a, b;                 // 玩家编号 (a 是先排队的一方)
+    int ratingA, ratingB;
+    long long waitA, waitB;   // 双方各排了多久 (毫秒)
+};
+
+// ==========================================
+// 类: MatchmakingQueue (匹配队列)
+// 注意: 本类不加锁，由调用方串行化访问 (例如只在服务器的一个线程里使用)
+// ==========================================
+class MatchmakingQueue {
+public:
+    struct Config {
+        int bucketWidth = 25;    // 每个桶覆盖的积分范围
+        int maxRating = 4000;    // 超过的积分都放进最后一个桶
+        int baseWindow = 50;     // 刚入队时可接受的积分差
+        int widenPerSec = 25;    // 每排队 1 秒窗口放宽多少
+        int maxWindow = 400;     // 窗口上限
+    };
+
+    MatchmakingQueue() : MatchmakingQueue(Config()) {}
+
+    explicit MatchmakingQueue(const Config& c) : config(c) {
+        buckets.assign(c.maxRating / c.bucketWidth + 1, Bucket());
+    }
+
+    size_t size() const { return slotOf.size(); }
+
+    // 预先按人数分配空间，避免排队高峰时扩容造成单次入队的停顿
+    void reserve(size_t n) {
+        pool.reserve(n);
+        slotOf.reserve(n);
+    }
+
+    bool contains(int playerId) const { return slotOf.count(playerId) > 0; }
+
+    // 排队 waitedMs 毫秒后的可接受积分差
+    int window(long long waitedMs) const {
+        return (int)min<long long>(config.maxWindow, config.baseWindow + waitedMs * config.widenPerSec / 1000);
+    }
+
+    // 入队；已经在队列中返回 false
+    bool enqueue(int playerId, int rating, long long nowMs) {
+        if(slotOf.count(playerId)) return false;
+        int s;
+        if(!freeSlots.empty()) { s = freeSlots.back(); freeSlots.pop_back(); }
+        else { s = pool.size(); pool.push_back(Entry()); }
+        Entry& e = pool[s];
+        e.playerId = playerId;
+        e.rating = rating;
+        e.enqueuedMs = nowMs;
+        e.bucket = bucketOf(rating);
+        link(s);
+        slotOf[playerId] = s;
+        return true;
+    }
+
+    // 取消排队；不在队列中返回 false
+    bool cancel(int playerId) {
+        auto it = slotOf.find(playerId);
+        if(it == slotOf.end()) return false;
+        int s = it->second;
+        slotOf.erase(it);
+        unlink(s);
+        freeSlots.push_back(s);
+        return true;
+    }
+
+    // 为一名排队玩家找对手 (不出队)，找不到返回 -1
+    int findOpponent(int playerId, long long nowMs) const {
+        auto it = slotOf.find(playerId);
+        if(it == slotOf.end()) return -1;
+        int s = findSlot(it->second, nowMs);
+        return s < 0 ? -1 : pool[s].playerId;
+    }
+
+    // 从排队最久的玩家开始依次配对，配上的双方出队；最多配 maxPairs 对
+    vector<MatchPair> matchAll(long long nowMs, size_t maxPairs = SIZE_MAX) {
+        vector<MatchPair> pairs;
+        int s = oldest;
+        while(s >= 0 && pairs.size() < maxPairs) {
+            int o = findSlot(s, nowMs);
+            int next = pool[s].nextAll;
+            if(o < 0) { s = next; continue; }
+            if(next == o) next = pool[o].nextAll; // 对手正好是下一个，跳过它
+            const Entry& a = pool[s];
+            const Entry& b = pool[o];
+            pairs.push_back({ a.playerId, b.playerId, a.rating, b.rating, nowMs - a.enqueuedMs, nowMs - b.enqueuedMs });
+            cancel(a.playerId);
+            cancel(b.playerId);
+            s = next;
+        }
+        return pairs;
+    }
+
+private:
+    struct Entry {
+        int playerId = -1, rating = 0, bucket = 0;
+        long long enqueuedMs = 0;
+        int prev = -1, next = -1;       // 同一个桶内 (按入队先后)
+        int prevAll = -1, nextAll = -1; // 全部排队玩家 (按入队先后)
+    };
+    struct Bucket { int head = -1, tail = -1; };
+
+    Config config;
+    vector<Entry> pool;              // 条目池，空出来的位置记在 freeSlots 里复用
+    vector<int> freeSlots;
+    vector<Bucket> buckets;
+    unordered_map<int, int> slotOf;  // 玩家编号 -> 条目下标
+    int oldest = -1, newest = -1;
+
+    int bucketOf(int rating) const {
+        return min((int)buckets.size() - 1, max(0, rating) / config.bucketWidth);
+    }
+
+    // 在 s 的窗口内找对手：桶按与 s 的距离由近到远查看，每个桶取窗口内排队最久的人
+    int findSlot(int s, long long nowMs) const {
+        const Entry& e = pool[s];
+        int w = window(nowMs - e.enqueuedMs);
+        int reach = w / config.bucketWidth + 1; // 最远要看多少个桶
+        for(int d=0; d<=reach; ++d) {
+            for(int side=0; side<2; ++side) {
+                if(d == 0 && side == 1) break;
+                int b = side == 0 ? e.bucket - d : e.bucket + d;
+                if(b < 0 || b >= (int)buckets.size()) continue;
+                for(int c=buckets[b].head; c>=0; c=pool[c].next) {
+                    if(c != s && abs(pool[c].rating - e.rating) <= w) return c;
+                }
+            }
+        }
+        return -1;
+    }
+
+    void link(int s) {
+        Entry& e = pool[s];
+        Bucket& b = buckets[e.bucket];
+        e.prev = b.tail; e.next = -1;
+        if(b.tail >= 0) pool[b.tail].next = s; else b.head = s;
+        b.tail = s;
+        e.prevAll = newest; e.nextAll = -1;
+        if(newest >= 0) pool[newest].nextAll = s; else oldest = s;
+        newest = s;
+    }
+
+    void unlink(int s) {
+        Entry& e = pool[s];
+        Bucket& b = buckets[e.bucket];
+        if(e.prev >= 0) pool[e.prev].next = e.next; else b.head = e.next;
+        if(e.next >= 0) pool[e.next].prev = e.prev; else b.tail = e.prev;
+        if(e.prevAll >= 0) pool[e.prevAll].nextAll = e.nextAll; else oldest = e.nextAll;
+        if(e.nextAll >= 0) pool[e.nextAll].prevAll = e.prevAll; else newest = e.prevAll;
+    }
+};
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * 文件名: matchmaking_stress.cpp
+ * 描述: 匹配队列压力测试 (无界面)
+ *       1. 队列中已有大量玩家时，单次入队 / 取消 / 找对手的耗时；
+ *       2. 按模拟时钟持续有玩家来排队，每 100 毫秒配对一次，统计排队时长 (配对延迟)、
+ *          双方积分差 (匹配质量)、每次配对的耗时，并用隐藏的真实水平决定胜负，观察 Elo 积分是否收敛。
+ * 用法: matchmaking_stress [排队人数=100000] [每秒来排队人数=5000] [模拟秒数=300] [随机种子=当前时间]
+ */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <ctime>
+#include "matchmaking.h"
+
+typedef chrono::steady_clock Clock;
+
+static double elapsedUs(Clock::time_point t0) {
+    return chrono::duration<double, micro>(Clock::now() - t0).count();
+}
+
+// 排序后取分位数
+template <class T>
+static T percentile(vector<T>& v, double p) {
+    if(v.empty()) return T();
+    sort(v.begin(), v.end());
+    return v[min(v.size() - 1, (size_t)(p * v.size()))];
+}
+
+template <class T>
+static void report(const char* name, vector<T> v, const char* unit) {
+    double sum = 0;
+    for(T x : v) sum += x;
+    cout << name << ": 平均 " << (v.empty() ? 0.0 : sum / v.size())
+         << ", p50 " << percentile(v, 0.50) << ", p90 " << percentile(v, 0.90)
+         << ", p99 " << percentile(v, 0.99) << ", 最大 " << percentile(v, 1.0) << " " << unit << endl;
+}
+
+int main(int argc, char* argv[]) {
+    int queued = argc > 1 ? atoi(argv[1]) : 100000;
+    int arrivalsPerSec = argc > 2 ? atoi(argv[2]) : 5000;
+    int simSeconds = argc > 3 ? atoi(argv[3]) : 300;
+    unsigned seed = argc > 4 ? (unsigned)atoll(argv[4]) : (unsigned)time(0);
+    mt19937 rng(seed);
+    normal_distribution<double> skillDist(1500.0, 300.0);
+    cout << fixed << setprecision(2);
+
+    // ---------- 1. 单次操作耗时 ----------
+    {
+        MatchmakingQueue q;
+        q.reserve(queued);
+        vector<int> ratings(queued);
+        for(int i=0; i<queued; ++i) ratings[i] = max(0, (int)skillDist(rng));
+        vector<double> enqueueUs, cancelUs, findUs;
+        for(int i=0; i<queued; ++i) {
+            auto t0 = Clock::now();
+            q.enqueue(i, ratings[i], 0);
+            enqueueUs.push_back(elapsedUs(t0));
+        }
+        const int OPS = 100000;
+        long long now = 5000;
+        int found = 0;
+        for(int k=0; k<OPS; ++k) {
+            int id = rng() % queued;
+            auto t0 = Clock::now();
+            found += q.findOpponent(id, now) >= 0;
+            findUs.push_back(elapsedUs(t0));
+            t0 = Clock::now();
+            q.cancel(id);
+            cancelUs.push_back(elapsedUs(t0));
+            q.enqueue(id, ratings[id], now);
+        }
+        cout << "== 队列中有 " << q.size() << " 人时的单次操作 ==" << endl;
+        report("入队", enqueueUs, "微秒");
+        report("取消", cancelUs, "微秒");
+        report("找对手", findUs, "微秒");
+        cout << "找对手成功率 " << found * 100.0 / OPS << "%" << endl;
+    }
+
+    // ---------- 2. 持续排队与配对 ----------
+    {
+        const int TICK_MS = 100;
+        int population = max(queued, arrivalsPerSec * 20);
+        vector<Player> players;
+        vector<double> skill(population);
+        for(int i=0; i<population; ++i) {
+            players.emplace_back("p" + to_string(i), "", 0);
+            skill[i] = skillDist(rng);
+        }
+        auto ratingError = [&]() {
+            double sum = 0;
+            for(int i=0; i<population; ++i) sum += fabs(players[i].rating - skill[i]);
+            return sum / population;
+        };
+        double errorBefore = ratingError();
+
+        MatchmakingQueue q;
+        vector<long long> waitMs;
+        vector<int> diff;
+        vector<double> tickUs;
+        size_t maxQueue = 0;
+        poisson_distribution<int> arrivals(arrivalsPerSec * TICK_MS / 1000.0);
+        uniform_real_distribution<double> coin(0.0, 1.0);
+
+        for(long long now=0; now < simSeconds * 1000LL; now += TICK_MS) {
+            for(int n = arrivals(rng); n > 0; --n) {
+                int id = rng() % population;
+                q.enqueue(id, players[id].rating, now); // 已经在排队的会被忽略
+            }
+            maxQueue = max(maxQueue, q.size());
+            auto t0 = Clock::now();
+            vector<MatchPair> pairs = q.matchAll(now);
+            tickUs.push_back(elapsedUs(t0));
+            for(const MatchPair& m : pairs) {
+                waitMs.push_back(m.waitA);
+                waitMs.push_back(m.waitB);
+                diff.push_back(abs(m.ratingA - m.ratingB));
+                // 按真实水平的 Elo 期望决定胜负
+                double scoreA = coin(rng) < eloExpected((int)skill[m.a], (int)skill[m.b]) ? 1.0 : 0.0;
+                eloApply(players[m.a], players[m.b], scoreA);
+            }
+        }
+
+        cout << "\n== 模拟 " << simSeconds << " 秒, 每秒 " << arrivalsPerSec << " 人来排队, "
+             << population << " 名玩家 ==" << endl;
+        cout << "配成 " << diff.size() << " 对, 结束时仍在排队 " << q.size() << " 人, 队列最长 " << maxQueue << " 人" << endl;
+        report("配对延迟 (排队时长)", waitMs, "毫秒");
+        report("双方积分差", diff, "分");
+        report("每次配对耗时", tickUs, "微秒");
+        cout << "积分与真实水平的平均偏差: 开始 " << errorBefore << ", 结束 " << ratingError() << endl;
+    }
+    return 0;
+}
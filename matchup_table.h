@@ -0,0 +1,245 @@
+/**
+ * 文件名: matchup_table.h
+ * 描述: 阵容对阵表 - 离线求出任意两套三英雄阵容之间的博弈值，写成带版本号的二进制文件；
+ *       游戏启动时直接内存映射使用，不做任何解析，“最佳克制阵容”“英雄选取评分”都是 O(1) 查询。
+ * 注意: 文件头记录英雄名单的内容哈希，名单 (initHeroes) 一旦变化，旧文件自动失效并需要重建。
+ */
+#ifndef MATCHUP_TABLE_H
+#define MATCHUP_TABLE_H
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <map>
+#include "game_solver.h"
+#include "mapped_file.h"
+
+const uint32_t MATCHUP_FILE_VERSION = 1;
+
+// 文件布局: [文件头][博弈值 float x L*L][最佳克制阵容 uint32 x L][英雄评分 float x H]
+// L 为阵容数 C(H,3)，阵容编号见 MatchupTable::lineupId
+struct MatchupFileHeader {
+    char magic[4];          // "KOPM"
+    uint32_t version;       // MATCHUP_FILE_VERSION
+    uint64_t rosterHash;    // 英雄名单的内容哈希
+    uint32_t heroCount;
+    uint32_t lineupCount;
+    uint64_t valuesOffset;
+    uint64_t countersOffset;
+    uint64_t ratingsOffset;
+};
+
+// ==========================================
+// 类: MatchupTable (阵容对阵表)
+// 描述: 只读访问映射进内存的对阵表，并提供离线构建函数
+// ==========================================
+class MatchupTable {
+public:
+    // 映射对阵表文件；文件不存在、版本不符或英雄名单已变化时返回 false
+    bool open(const string& path, const vector<Hero>& heroes) {
+        close();
+        if(!file.open(path)) return false;
+        if(file.size() < sizeof(MatchupFileHeader)) { close(); return false; }
+        header = (const MatchupFileHeader*)file.data();
+        uint32_t L = lineupCount((int)heroes.size());
+        if(memcmp(header->magic, "KOPM", 4) != 0 || header->version != MATCHUP_FILE_VERSION
+           || header->rosterHash != rosterHash(heroes) || header->heroCount != heroes.size()
+           || header->lineupCount != L
+           || !section(header->valuesOffset, (uint64_t)L * L * sizeof(float))
+           || !section(header->countersOffset, (uint64_t)L * sizeof(uint32_t))
+           || !section(header->ratingsOffset, heroes.size() * sizeof(float))) {
+            close();
+            return false;
+        }
+        values = (const float*)(file.data() + header->valuesOffset);
+        counters = (const uint32_t*)(file.data() + header->countersOffset);
+        ratings = (const float*)(file.data() + header->ratingsOffset);
+        for(uint32_t x=0; x<L; ++x) {
+            if(counters[x] >= L) { close(); return false; } // 克制阵容编号越界：文件损坏
+        }
+        return true;
+    }
+
+    void close() {
+        file.close();
+        header = nullptr; values = nullptr; counters = nullptr; ratings = nullptr;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+    int lineups() const { return header ? (int)header->lineupCount : 0; }
+
+    // 阵容 a 对阵容 b 的博弈值 (a 的视角，胜=1 平=0 负=-1 的期望)
+    float value(int a, int b) const { return values[(size_t)a * header->lineupCount + b]; }
+
+    // 对阵容 x 博弈值最高的阵容
+    int bestCounter(int x) const { return counters[x]; }
+
+    // 英雄选取评分：包含该英雄的所有阵容对全部阵容的平均博弈值
+    float heroRating(int hero) const { return ratings[hero]; }
+
+    // 文件是否存在且与当前英雄名单一致 (构建工具用它判断是否需要重建)
+    static bool isUpToDate(const string& path, const vector<Hero>& heroes) {
+        MatchupTable t;
+        return t.open(path, heroes);
+    }
+
+    // ---------- 阵容编号 ----------
+    // 三个不同英雄按 a < b < c 排序后，编号 = C(c,3) + C(b,2) + C(a,1) (组合数系统)
+    // 编号与英雄总数无关，且恰好覆盖 [0, C(H,3))
+    static int lineupId(int a, int b, int c) {
+        if(a > b) swap(a, b);
+        if(b > c) swap(b, c);
+        if(a > b) swap(a, b);
+        return choose3(c) + choose2(b) + a;
+    }
+
+    static int lineupId(const vector<int>& lineup) { return lineupId(lineup[0], lineup[1], lineup[2]); }
+
+    // 编号还原成三个英雄索引 (从小到大)
+    static vector<int> lineupHeroes(int id) {
+        int c = 2;
+        while(choose3(c + 1) <= id) c++;
+        id -= choose3(c);
+        int b = 1;
+        while(choose2(b + 1) <= id) b++;
+        id -= choose2(b);
+        return { id, b, c };
+    }
+
+    static uint32_t lineupCount(int heroCount) { return (uint32_t)choose3(heroCount); }
+
+    // 对阵表有 L*L 个博弈值，30 个英雄 (4060 套阵容) 时约 66 MB；名单更大就不建表，
+    // 界面照常可玩，只是不显示选取评分和克制建议
+    static const uint64_t MAX_LINEUPS = 4060;
+
+    static bool supports(int heroCount) {
+        return heroCount >= 3 && (uint64_t)heroCount * (heroCount - 1) * (heroCount - 2) / 6 <= MAX_LINEUPS;
+    }
+
+    // 英雄名单的内容哈希 (FNV-1a)：名字和三种招数的初始数量都参与计算
+    static uint64_t rosterHash(const vector<Hero>& heroes) {
+        uint64_t h = 1469598103934665603ull;
+        auto mix = [&h](unsigned char byte) { h ^= byte; h *= 1099511628211ull; };
+        for(const auto& hero : heroes) {
+            for(unsigned char ch : hero.name) mix(ch);
+            mix(0);
+            mix((unsigned char)hero.s); mix((unsigned char)hero.r); mix((unsigned char)hero.p);
+        }
+        return h;
+    }
+
+    // ---------- 离线构建 ----------
+    // 博弈值只取决于双方三种招数的总数，所以先把阵容按总数去重，
+    // 再把不同的“总数对”分给多个线程求解 (每个线程一个求解器，置换表在线程内复用)。
+    // 规则对双方对称，value(b, a) = -value(a, b)，只需求一半。
+    // cancel 不为空且被置位时尽快放弃 (每求完一行检查一次)，返回 false，不改动已有的文件
+    static bool build(const vector<Hero>& heroes, const string& path, int threads, const atomic<bool>* cancel = nullptr) {
+        int H = heroes.size();
+        if(!supports(H)) return false;
+        int L = lineupCount(H);
+        if(threads <= 0) threads = 1;
+
+        // 1. 阵容 -> 三种招数总数，去重
+        vector<int> group(L);
+        vector<MatchState> totals; // 每组的开局状态 (只用其中的 my[])
+        map<uint64_t, int> seen;
+        for(int id=0; id<L; ++id) {
+            vector<int> lu = lineupHeroes(id);
+            MatchState s = {};
+            for(int i : lu) { s.my[SCISSORS] += heroes[i].s; s.my[ROCK] += heroes[i].r; s.my[PAPER] += heroes[i].p; }
+            uint64_t key = (uint64_t)s.my[0] << 32 | (uint64_t)s.my[1] << 16 | (uint64_t)s.my[2];
+            auto it = seen.find(key);
+            if(it == seen.end()) { it = seen.emplace(key, (int)totals.size()).first; totals.push_back(s); }
+            group[id] = it->second;
+        }
+
+        // 2. 并行求解各组之间的博弈值 (按行动态分配，行越靠前工作越多)
+        int G = totals.size();
+        vector<float> groupValue((size_t)G * G, 0.0f);
+        atomic<int> nextRow(0);
+        auto worker = [&]() {
+            GameSolver solver;
+            for(int a; (a = nextRow++) < G; ) {
+                if(cancel && cancel->load(memory_order_relaxed)) break;
+                for(int b=a; b<G; ++b) {
+                    MatchState s = {};
+                    for(int m=0; m<3; ++m) { s.my[m] = totals[a].my[m]; s.cpu[m] = totals[b].my[m]; }
+                    s.round = 1;
+                    float v = (float)solver.solve(s).value;
+                    groupValue[(size_t)a * G + b] = v;
+                    groupValue[(size_t)b * G + a] = -v;
+                }
+                solver.table.clear(); // 控制内存：下一行的开局与本行几乎不共享子局面
+            }
+        };
+        vector<thread> pool;
+        for(int t=0; t<threads; ++t) pool.emplace_back(worker);
+        for(auto& t : pool) t.join();
+        if(cancel && cancel->load()) return false;
+
+        // 3. 展开成完整的 L x L 表，并预先算好每个阵容的最佳克制阵容
+        vector<float> values((size_t)L * L);
+        vector<uint32_t> counters(L);
+        for(int a=0; a<L; ++a) {
+            for(int b=0; b<L; ++b) values[(size_t)a * L + b] = groupValue[(size_t)group[a] * G + group[b]];
+        }
+        for(int x=0; x<L; ++x) {
+            int best = 0;
+            for(int a=1; a<L; ++a) if(values[(size_t)a * L + x] > values[(size_t)best * L + x]) best = a;
+            counters[x] = best;
+        }
+
+        // 4. 英雄评分：包含该英雄的阵容对全部阵容的平均博弈值
+        vector<float> ratings(H, 0.0f);
+        vector<int> appear(H, 0);
+        for(int a=0; a<L; ++a) {
+            double sum = 0;
+            for(int b=0; b<L; ++b) sum += values[(size_t)a * L + b];
+            for(int i : lineupHeroes(a)) { ratings[i] += (float)(sum / L); appear[i]++; }
+        }
+        for(int i=0; i<H; ++i) if(appear[i]) ratings[i] /= appear[i];
+
+        // 5. 先写临时文件再改名，构建中途失败不会留下半个文件
+        MatchupFileHeader hdr = {};
+        memcpy(hdr.magic, "KOPM", 4);
+        hdr.version = MATCHUP_FILE_VERSION;
+        hdr.rosterHash = rosterHash(heroes);
+        hdr.heroCount = H;
+        hdr.lineupCount = L;
+        hdr.valuesOffset = sizeof(MatchupFileHeader);
+        hdr.countersOffset = hdr.valuesOffset + values.size() * sizeof(float);
+        hdr.ratingsOffset = hdr.countersOffset + counters.size() * sizeof(uint32_t);
+
+        string tmp = path + ".tmp";
+        FILE* f = fopen(tmp.c_str(), "wb");
+        if(!f) return false;
+        bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1
+               && fwrite(values.data(), sizeof(float), values.size(), f) == values.size()
+               && fwrite(counters.data(), sizeof(uint32_t), counters.size(), f) == counters.size()
+               && fwrite(ratings.data(), sizeof(float), ratings.size(), f) == ratings.size();
+        ok = ok && fflush(f) == 0 && syncFile(f);
+        ok = (fclose(f) == 0) && ok;
+        if(!ok) { remove(tmp.c_str()); return false; }
+        return replaceFile(tmp, path); // 原子替换：任何时刻 path 要么是旧表，要么是完整的新表
+    }
+
+private:
+    MappedFile file;
+    const MatchupFileHeader* header = nullptr;
+    const float* values = nullptr;
+    const uint32_t* counters = nullptr;
+    const float* ratings = nullptr;
+
+    // 文件中 [offset, offset + bytes) 在文件头之后、文件之内且 4 字节对齐
+    bool section(uint64_t offset, uint64_t bytes) const {
+        return offset >= sizeof(MatchupFileHeader) && offset % 4 == 0
+            && offset <= file.size() && bytes <= file.size() - offset;
+    }
+
+    static int choose3(int n) { return n < 3 ? 0 : n * (n - 1) * (n - 2) / 6; }
+    static int choose2(int n) { return n < 2 ? 0 : n * (n - 1) / 2; }
+};
+
+#endif
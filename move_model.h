@@ -0,0 +1,99 @@
+/**
+ * 文件名: move_model.h
+ * 描述: 玩家出招模型 - 按玩家统计“前两回合出了什么 -> 这回合出什么”的 n 元组次数 (0/1/2 阶)，
+ *       超时 (系统代出) 也作为一种结果计入，电脑据此预测玩家下一招并针对性出招 (见 BattleEngine::model)。
+ * 结构: 所有计数都在一个定长 256 字节的结构里，每回合更新只改三个计数器 (O(1))，
+ *       某个上下文的次数攒满 COUNT_LIMIT 就整体减半，越近的习惯权重越大，历史再长也不会变慢、变大。
+ *       结构可以原样写进文件 (DataManager 按玩家编号保存在 models.dat)，checksum 用来识别写了一半的记录。
+ * 注意: 纯逻辑头文件，不依赖 Qt；招用 0-2 的整数表示 (与 MoveType 一致)，这样 game_data.h 也能直接包含它。
+ */
+#ifndef MOVE_MODEL_H
+#define MOVE_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// ==========================================
+// 结构: MoveModel (玩家出招模型)
+// 描述: 历史符号 0-2 为玩家出的招 (按 MoveType 排列)，3 为超时，4 为“本局开始” (前面没有回合)；
+//       预测结果 0-2 为三种招，3 为超时
+// ==========================================
+struct MoveModel {
+    enum { TIMEOUT = 3, START = 4, SYMBOLS = 5, OUTCOMES = 4 };
+    static const int COUNT_LIMIT = 256; // 某个上下文的总次数达到它就整体减半
+    static const int BACKOFF = 2;       // 高阶统计样本少时向低阶靠拢的先验强度
+
+    uint16_t order0[OUTCOMES];                   // 不看上下文
+    uint16_t order1[SYMBOLS][OUTCOMES];          // [上回合]
+    uint16_t order2[SYMBOLS][SYMBOLS][OUTCOMES]; // [上上回合][上回合]
+    uint8_t prev2, prev1;                        // 本局上上回合、上回合的符号
+    uint16_t reserved;
+    uint32_t checksum;                           // 只在写盘前/读盘后使用
+
+    MoveModel() { clear(); }
+
+    void clear() {
+        memset(this, 0, sizeof(*this));
+        prev2 = prev1 = START;
+    }
+
+    // 新的一局开始：上下文回到“本局开始”
+    void startGame() { prev2 = prev1 = START; }
+
+    // 记录玩家本回合的出招 (MoveType)；timedOut 为 true 时 m 是系统代出的，只记作一次超时
+    void record(int m, bool timedOut) {
+        int o = timedOut ? TIMEOUT : m;
+        if(o < 0) return;
+        bump(order0, o);
+        bump(order1[prev1], o);
+        bump(order2[prev2][prev1], o);
+        prev2 = prev1;
+        prev1 = (uint8_t)o;
+    }
+
+    // 已记录的回合数 (减半之后是近似值)，用来判断模型是否可信
+    int observed() const { return total(order0); }
+
+    // 预测玩家下一回合的结果分布 p[0..3] (三种招 + 超时)，逐阶平滑：
+    // 0 阶加一平滑，高一阶以低一阶的分布为先验，上下文见得少时结果接近低阶
+    void predict(double p[OUTCOMES]) const {
+        const uint16_t* rows[3] = { order0, order1[prev1], order2[prev2][prev1] };
+        for(int o=0; o<OUTCOMES; ++o) p[o] = 1.0 / OUTCOMES;
+        for(int k=0; k<3; ++k) {
+            double w = k == 0 ? OUTCOMES : BACKOFF;
+            double n = total(rows[k]);
+            for(int o=0; o<OUTCOMES; ++o) p[o] = (rows[k][o] + w * p[o]) / (n + w);
+        }
+    }
+
+    // 写盘前调用，计算校验值
+    void seal() { checksum = hash(); }
+
+    // 从文件读出后调用：校验值不对 (没写过或写到一半) 时返回 false
+    bool valid() const { return checksum == hash() && prev1 < SYMBOLS && prev2 < SYMBOLS; }
+
+private:
+    static int total(const uint16_t* row) {
+        return row[0] + row[1] + row[2] + row[3];
+    }
+
+    static void bump(uint16_t* row, int o) {
+        row[o]++;
+        if(total(row) >= COUNT_LIMIT) {
+            for(int i=0; i<OUTCOMES; ++i) row[i] = (uint16_t)((row[i] + 1) / 2);
+        }
+    }
+
+    // 除 checksum 以外所有字节的 FNV-1a 哈希
+    uint32_t hash() const {
+        const unsigned char* b = (const unsigned char*)this;
+        uint32_t h = 2166136261u;
+        for(size_t i=0; i<offsetof(MoveModel, checksum); ++i) { h ^= b[i]; h *= 16777619u; }
+        return h;
+    }
+};
+
+static_assert(sizeof(MoveModel) == 256, "MoveModel 必须是定长 256 字节");
+
+#endif // MOVE_MODEL_H
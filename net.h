@@ -0,0 +1,150 @@
+/**
+ * 文件名: net.h
+ * 描述: 极薄的套接字封装 - 只包一层 Winsock / BSD socket 的差异，让服务器和客户端的代码两边通用。
+ * 注意: 事件循环使用 poll (Windows 下为 WSAPoll)，两者接口几乎一致；
+ *       所有连接都关闭 Nagle 算法 (TCP_NODELAY)，小包请求/应答不会被攒起来延迟发送。
+ */
+#ifndef NET_H
+#define NET_H
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET socket_t;
+typedef WSAPOLLFD pollfd_t;
+const socket_t INVALID_SOCK = INVALID_SOCKET;
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+typedef int socket_t;
+typedef struct pollfd pollfd_t;
+const socket_t INVALID_SOCK = -1;
+#endif
+
+// 进程内调用一次即可 (重复调用无害)
+inline void netInit() {
+#ifdef _WIN32
+    static bool done = false;
+    if(!done) { WSADATA d; WSAStartup(MAKEWORD(2, 2), &d); done = true; }
+#else
+    signal(SIGPIPE, SIG_IGN); // 对端断开后继续写不应该让整个进程退出
+#endif
+}
+
+inline void netClose(socket_t s) {
+#ifdef _WIN32
+    closesocket(s);
+#else
+    ::close(s);
+#endif
+}
+
+inline void netSetNonBlocking(socket_t s) {
+#ifdef _WIN32
+    u_long on = 1;
+    ioctlsocket(s, FIONBIO, &on);
+#else
+    fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+inline void netSetNoDelay(socket_t s) {
+    int on = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+}
+
+// 上一次非阻塞调用是否只是“暂时没有数据 / 缓冲区满”
+inline bool netWouldBlock() {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+inline int netPoll(pollfd_t* fds, size_t n, int timeoutMs) {
+#ifdef _WIN32
+    return WSAPoll(fds, (ULONG)n, timeoutMs);
+#else
+    return ::poll(fds, (nfds_t)n, timeoutMs);
+#endif
+}
+
+// 监听 TCP 端口 (port 为 0 时由系统分配)，失败返回 INVALID_SOCK
+inline socket_t netListen(const std::string& host, int port) {
+    socket_t s = socket(AF_INET, SOCK_STREAM, 0);
+    if(s == INVALID_SOCK) return INVALID_SOCK;
+    int on = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+    if(bind(s, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(s, SOMAXCONN) != 0) {
+        netClose(s);
+        return INVALID_SOCK;
+    }
+    return s;
+}
+
+// 已绑定套接字的实际端口
+inline int netLocalPort(socket_t s) {
+    sockaddr_in addr = {};
+    socklen_t len = sizeof(addr);
+    getsockname(s, (sockaddr*)&addr, &len);
+    return ntohs(addr.sin_port);
+}
+
+// 阻塞方式连接服务器，失败返回 INVALID_SOCK
+inline socket_t netConnect(const std::string& host, int port) {
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if(getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0) return INVALID_SOCK;
+    socket_t s = socket(AF_INET, SOCK_STREAM, 0);
+    if(s != INVALID_SOCK && connect(s, res->ai_addr, (int)res->ai_addrlen) != 0) {
+        netClose(s);
+        s = INVALID_SOCK;
+    }
+    freeaddrinfo(res);
+    if(s != INVALID_SOCK) netSetNoDelay(s);
+    return s;
+}
+
+// 阻塞方式发送 / 接收恰好 n 字节，连接断开返回 false
+inline bool netSendAll(socket_t s, const void* buf, size_t n) {
+    const char* p = (const char*)buf;
+    while(n > 0) {
+        int k = send(s, p, (int)n, 0);
+        if(k <= 0) return false;
+        p += k; n -= k;
+    }
+    return true;
+}
+
+inline bool netRecvAll(socket_t s, void* buf, size_t n) {
+    char* p = (char*)buf;
+    while(n > 0) {
+        int k = recv(s, p, (int)n, 0);
+        if(k <= 0) return false;
+        p += k; n -= k;
+    }
+    return true;
+}
+
+#endif
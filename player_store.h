@@ -0,0 +1,269 @@
+/**
+ * 文件名: player_store.h
+ * 描述: 玩家存储 - 二进制快照 users.dat 通过内存映射直接使用，启动时不逐条解析；
+ *       只有被访问或修改过的玩家才会展开成 Player 对象。
+ * 文件布局: [文件头][定长记录 x N][哈希索引 (记录编号) x 容量][字符串区]
+ *       记录里只存字符串在字符串区中的偏移和长度；哈希索引按用户名定位记录，登录不需要先建索引。
+ * 版本: 1 - 记录 20 字节 (没有积分)；2 - 记录 24 字节，增加积分和积分场次。
+ *       两种版本都能直接映射读取 (版本 1 的玩家积分按初始积分计)，写出的快照总是最新版本。
+ */
+#ifndef PLAYER_STORE_H
+#define PLAYER_STORE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include "mapped_file.h"
+
+using namespace std;
+
+const uint32_t PLAYER_FILE_VERSION = 2;
+const uint32_t EMPTY_SLOT = 0xFFFFFFFFu;
+const int DEFAULT_RATING = 1500;     // 新玩家的初始积分 (Elo)
+const size_t PLAYER_RECORD_V1_SIZE = 20;
+
+struct PlayerFileHeader {
+    char magic[4];          // "KOPU"
+    uint32_t version;       // PLAYER_FILE_VERSION
+    uint32_t count;         // 记录数
+    uint32_t indexCapacity; // 哈希索引槽数 (2 的幂)
+    uint64_t recordsOffset;
+    uint64_t indexOffset;
+    uint64_t arenaOffset;
+    uint64_t arenaSize;
+};
+
+// 定长记录：玩家编号就是记录下标
+struct PlayerRecord {
+    uint32_t nameOffset;  // 用户名在字符串区中的偏移
+    uint32_t passOffset;  // 密码在字符串区中的偏移
+    uint16_t nameLength;
+    uint16_t passLength;
+    int32_t totalWins;
+    // 以下为版本 2 新增 (版本 1 的记录在这里是一个值为 0 的保留字段，之后就是下一条记录)
+    int32_t rating;       // 积分
+    uint32_t ratedGames;  // 已打的积分场次
+};
+
+static_assert(sizeof(PlayerRecord) == 24, "PlayerRecord 必须是 24 字节");
+
+// ==========================================
+// 类: Player (玩家)
+// 描述: 简单的用户账户结构
+// ==========================================
+class Player {
+public:
+    string username;
+    string password;
+    int totalWins; // 累计胜场
+    int rating;     // 积分 (Elo)
+    int ratedGames; // 积分场次 (新玩家前若干场积分变化更快)
+    Player(string u, string p, int w, int rt = DEFAULT_RATING, int games = 0)
+        : username(u), password(p), totalWins(w), rating(rt), ratedGames(games) {}
+};
+
+// ==========================================
+// 类: PlayerStore (玩家存储)
+// 描述: 映射中的快照记录 + 内存中的“覆盖层” (本次运行中读过、改过或新注册的玩家)
+// 注意: 本类不加锁，由 DataManager 负责串行化访问
+// ==========================================
+class PlayerStore {
+public:
+    // 映射快照文件；文件不存在或格式不对返回 false (此时存储为空，仍可正常注册)
+    bool open(const string& path) {
+        close();
+        if(!file.open(path)) return false;
+        if(file.size() < sizeof(PlayerFileHeader)) { file.close(); return false; }
+        const PlayerFileHeader* h = (const PlayerFileHeader*)file.data();
+        size_t stride = h->version == 1 ? PLAYER_RECORD_V1_SIZE : sizeof(PlayerRecord);
+        if(memcmp(h->magic, "KOPU", 4) != 0 || h->version < 1 || h->version > PLAYER_FILE_VERSION
+           || (h->indexCapacity & (h->indexCapacity - 1)) != 0
+           || file.size() < h->arenaOffset + h->arenaSize
+           || h->recordsOffset + (uint64_t)h->count * stride > h->indexOffset
+           || h->indexOffset + (uint64_t)h->indexCapacity * sizeof(uint32_t) > h->arenaOffset) {
+            file.close();
+            return false;
+        }
+        header = h;
+        records = file.data() + h->recordsOffset;
+        recordStride = stride;
+        slots = (const uint32_t*)(file.data() + h->indexOffset);
+        arena = file.data() + h->arenaOffset;
+        baseCount = h->count;
+        if(count < baseCount) count = baseCount;
+        return true;
+    }
+
+    // 解除映射 (覆盖层保留，里面的玩家对象地址不变)
+    void close() {
+        file.close();
+        header = nullptr; records = nullptr; slots = nullptr; arena = nullptr;
+        recordStride = sizeof(PlayerRecord);
+        baseCount = 0;
+    }
+
+    int size() const { return count; }
+
+    // 按用户名查找玩家编号，找不到返回 -1
+    int find(const string& name) const {
+        auto it = addedIndex.find(name);
+        if(it != addedIndex.end()) return it->second;
+        if(!header || header->indexCapacity == 0) return -1;
+        uint32_t mask = header->indexCapacity - 1;
+        for(uint32_t i = hashName(name.data(), name.size()) & mask; ; i = (i + 1) & mask) {
+            uint32_t id = slots[i];
+            if(id == EMPTY_SLOT || id >= (uint32_t)baseCount) return -1; // 越界的编号只会来自损坏的文件
+            PlayerRecord r = record(id);
+            if(r.nameLength == name.size() && memcmp(arena + r.nameOffset, name.data(), name.size()) == 0) return id;
+        }
+    }
+
+    // 取得可修改的玩家对象：第一次访问时从快照记录展开到覆盖层
+    // 覆盖层是基于节点的哈希表，返回的引用在之后的插入中保持有效
+    Player& at(int id) {
+        auto it = overlay.find(id);
+        if(it != overlay.end()) return it->second;
+        return overlay.emplace(id, recordPlayer(id)).first->second;
+    }
+
+    // 只读访问，不展开
+    Player get(int id) const {
+        auto it = overlay.find(id);
+        return it != overlay.end() ? it->second : recordPlayer(id);
+    }
+
+    string username(int id) const {
+        auto it = overlay.find(id);
+        if(it != overlay.end()) return it->second.username;
+        PlayerRecord r = record(id);
+        return string(arena + r.nameOffset, r.nameLength);
+    }
+
+    // 用户名的只读视图，不复制字符串 (排序大量玩家时使用)；在下一次 open/close 之前有效
+    string_view nameView(int id) const {
+        auto it = overlay.find(id);
+        if(it != overlay.end()) return it->second.username;
+        PlayerRecord r = record(id);
+        return string_view(arena + r.nameOffset, r.nameLength);
+    }
+
+    int wins(int id) const {
+        auto it = overlay.find(id);
+        if(it != overlay.end()) return it->second.totalWins;
+        return record(id).totalWins;
+    }
+
+    int rating(int id) const {
+        auto it = overlay.find(id);
+        if(it != overlay.end()) return it->second.rating;
+        return record(id).rating;
+    }
+
+    // 新注册一名玩家，返回编号
+    int add(const string& u, const string& p, int w) {
+        int id = count++;
+        overlay.emplace(id, Player(u, p, w));
+        addedIndex[u] = id;
+        return id;
+    }
+
+    // 覆盖层的副本 (压缩时在锁内复制，锁外写文件)
+    unordered_map<int, Player> overlaySnapshot() const { return overlay; }
+
+    // 把 [0, total) 号玩家写成新快照：覆盖层里有的用覆盖层，其余直接搬运当前快照的记录
+    bool writeSnapshot(const string& path, int total, const unordered_map<int, Player>& changed) const {
+        return writeSnapshotFile(path, total, [&](int id) {
+            auto it = changed.find(id);
+            return it != changed.end() ? it->second : recordPlayer(id);
+        });
+    }
+
+    // 通用快照写入：get(id) 返回第 id 号玩家
+    template <class F>
+    static bool writeSnapshotFile(const string& path, int total, F get) {
+        uint32_t cap = 16;
+        while(cap < (uint32_t)total * 2) cap *= 2; // 装填率不超过一半
+
+        vector<PlayerRecord> recs(total);
+        vector<uint32_t> index(cap, EMPTY_SLOT);
+        string strings;
+        for(int id=0; id<total; ++id) {
+            Player p = get(id);
+            PlayerRecord& r = recs[id];
+            r.nameOffset = strings.size(); r.nameLength = (uint16_t)p.username.size();
+            strings += p.username;
+            r.passOffset = strings.size(); r.passLength = (uint16_t)p.password.size();
+            strings += p.password;
+            r.totalWins = p.totalWins;
+            r.rating = p.rating;
+            r.ratedGames = p.ratedGames;
+            uint32_t i = hashName(p.username.data(), p.username.size()) & (cap - 1);
+            while(index[i] != EMPTY_SLOT) i = (i + 1) & (cap - 1);
+            index[i] = id;
+        }
+
+        PlayerFileHeader h = {};
+        memcpy(h.magic, "KOPU", 4);
+        h.version = PLAYER_FILE_VERSION;
+        h.count = total;
+        h.indexCapacity = cap;
+        h.recordsOffset = sizeof(PlayerFileHeader);
+        h.indexOffset = h.recordsOffset + recs.size() * sizeof(PlayerRecord);
+        h.arenaOffset = h.indexOffset + index.size() * sizeof(uint32_t);
+        h.arenaSize = strings.size();
+
+        FILE* f = fopen(path.c_str(), "wb");
+        if(!f) return false;
+        bool ok = fwrite(&h, sizeof(h), 1, f) == 1
+               && fwrite(recs.data(), sizeof(PlayerRecord), recs.size(), f) == recs.size()
+               && fwrite(index.data(), sizeof(uint32_t), index.size(), f) == index.size()
+               && fwrite(strings.data(), 1, strings.size(), f) == strings.size();
+        ok = ok && fflush(f) == 0 && syncFile(f); // 落盘后才能改名换上，否则断电后可能换上一个空文件
+        ok = (fclose(f) == 0) && ok;
+        if(!ok) remove(path.c_str());
+        return ok;
+    }
+
+    // FNV-1a 32 位哈希
+    static uint32_t hashName(const char* s, size_t n) {
+        uint32_t h = 2166136261u;
+        for(size_t i=0; i<n; ++i) { h ^= (unsigned char)s[i]; h *= 16777619u; }
+        return h;
+    }
+
+private:
+    MappedFile file;
+    const PlayerFileHeader* header = nullptr;
+    const char* records = nullptr;  // 记录区起点 (按 recordStride 步进，兼容版本 1 的 20 字节记录)
+    size_t recordStride = sizeof(PlayerRecord);
+    const uint32_t* slots = nullptr;
+    const char* arena = nullptr;
+    int baseCount = 0; // 快照中的记录数
+    int count = 0;     // 总玩家数 (快照 + 新注册)
+
+    unordered_map<int, Player> overlay;     // 展开过的玩家
+    unordered_map<string, int> addedIndex;  // 快照之后新注册玩家的用户名索引
+
+    // 按当前版本的步长复制出一条记录：版本 1 的记录只有 20 字节，不能当作 24 字节的结构体直接引用
+    // (最后一条会越过记录区)，只复制到 totalWins 为止，积分按初始积分、积分场次按 0 补齐
+    PlayerRecord record(int id) const {
+        PlayerRecord r;
+        r.rating = DEFAULT_RATING;
+        r.ratedGames = 0;
+        memcpy(&r, records + (size_t)id * recordStride, recordStride == sizeof(PlayerRecord) ? sizeof(PlayerRecord) : offsetof(PlayerRecord, rating));
+        return r;
+    }
+
+    Player recordPlayer(int id) const {
+        PlayerRecord r = record(id);
+        return Player(string(arena + r.nameOffset, r.nameLength),
+                      string(arena + r.passOffset, r.passLength), r.totalWins, r.rating, (int)r.ratedGames);
+    }
+};
+
+#endif
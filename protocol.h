@@ -0,0 +1,98 @@
+/**
+ * 文件名: protocol.h
+ * 描述: 对战服务器的线路协议 - 请求固定 20 字节，应答固定 40 字节，没有长度前缀和文本解析。
+ *       一个连接上可以同时进行任意多局，用 matchId 区分；请求可以连续发送 (流水线)，
+ *       应答按请求的顺序返回，并原样带回请求中的 tag，客户端用它配对、计算延迟。
+ * 积分赛: 服务器开了积分赛 (GameServer::Config::rated) 时，玩家可以排队与别的玩家对战，按 Elo 结算积分。
+ *       积分赛的请求都用 matchId 字段带玩家在服务器玩家数据中的编号 (同一玩家同时只有一局积分赛)；
+ *       双方同时出招，先出的一方收到 REPLY_WAITING，之后用 REQ_RATED_POLL 查询，直到回合数前进。
+ *       协议不做身份验证，只适合在可信的局域网内使用。
+ * 注意: 结构体按本机字节序直接收发 (服务器和客户端都是小端机器)。
+ */
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstdint>
+#include "battle_engine.h"
+
+const int DEFAULT_SERVER_PORT = 7700;
+
+// 请求类型
+enum RequestType : uint8_t {
+    REQ_NEW_MATCH = 1, // 开新的一局：heroes 为我方阵容，电脑阵容由服务器按本局种子抽取
+    REQ_MOVE = 2,      // 出招：move 为招；flags 带 REQ_FLAG_TIMEOUT 时由服务器随机代出
+    REQ_END = 3,       // 放弃对局 (对局正常结束后服务器会自动释放，不需要发送)
+    REQ_RATED_QUEUE = 4,  // 积分赛排队：heroes 为我方阵容
+    REQ_RATED_CANCEL = 5, // 取消排队
+    REQ_RATED_POLL = 6,   // 查询：还在排队 (REPLY_QUEUED)，或积分赛的当前状态
+    REQ_RATED_MOVE = 7    // 积分赛出招：move 为招，round 为客户端认为的当前回合
+};
+
+// 请求标志
+const uint8_t REQ_FLAG_SOLVER = 1;  // 新对局：电脑按均衡策略出招 (否则加权随机)
+const uint8_t REQ_FLAG_TIMEOUT = 2; // 出招：玩家超时
+
+// 应答状态
+enum ReplyStatus : uint8_t {
+    REPLY_OK = 0,
+    REPLY_BAD_REQUEST = 1,  // 类型未知或阵容不合法
+    REPLY_NO_MATCH = 2,     // matchId 不存在 (已结束或从未创建)
+    REPLY_ILLEGAL_MOVE = 3, // 我方已经没有这一招
+    REPLY_ROUND_EXPIRED = 4, // 出招：这一回合已超过服务器的出招时限，服务器已经随机代出 (应答即代出那一回合的结果)
+    REPLY_QUEUED = 5,        // 积分赛：还在排队
+    REPLY_WAITING = 6        // 积分赛出招：已收到，等对手出招 (应答是出招前的状态)
+};
+
+struct Request {
+    uint8_t type;
+    uint8_t move;
+    uint8_t flags;
+    uint8_t round;                // 出招：客户端认为的当前回合，与服务器不符说明那一回合已超时代出 (0 表示不检查)
+    uint16_t heroes[TEAM_SIZE];   // 英雄在名单中的下标 (16 位，名单可以有上千个英雄)
+    uint16_t reserved2;
+    uint32_t matchId;
+    uint32_t tag;
+};
+
+// 应答携带对局当前的全部公开状态，客户端不需要自己推演规则
+struct Reply {
+    uint32_t matchId;
+    uint32_t tag;
+    uint32_t seed;
+    uint16_t myMoves[TEAM_SIZE];  // 我方 3 个英雄的打包库存 (见 hero_state.h)
+    uint16_t cpuLineup[TEAM_SIZE];
+    uint16_t myHero, cpuHero;     // 刚结算的回合双方出战的英雄 (仅出招应答，下同)
+    uint8_t type;                 // 对应的请求类型
+    uint8_t status;
+    uint8_t round;                // 下一回合是第几回合，大于 MAX_ROUNDS 表示打完
+    uint8_t myScore, cpuScore;
+    int8_t cpuSlot;               // 电脑下一回合派出的英雄位置，-1 表示没有下一回合 (积分赛不预先亮出对手的英雄，未打完时为 0)
+    uint8_t myMove, cpuMove, outcome;
+    uint8_t reserved[3];
+
+    bool over() const { return cpuSlot < 0; }
+};
+
+static_assert(sizeof(Request) == 20, "Request 必须是 20 字节");
+static_assert(sizeof(Reply) == 40, "Reply 必须是 40 字节");
+
+// 用引擎当前状态填写应答
+inline void fillReply(Reply& r, const BattleEngine& e) {
+    r.seed = e.matchSeed;
+    r.round = (uint8_t)e.currentRound;
+    r.myScore = (uint8_t)e.myScore;
+    r.cpuScore = (uint8_t)e.cpuScore;
+    r.cpuSlot = (int8_t)(e.isOver() ? -1 : e.currentCpuHeroIndex);
+    for(int i=0; i<TEAM_SIZE; ++i) {
+        r.myMoves[i] = e.myMoves[i];
+        r.cpuLineup[i] = (uint16_t)e.cpuHeroIndices[i];
+    }
+    if(!e.rounds.empty()) {
+        const RoundResult& last = e.rounds.back();
+        r.myHero = (uint16_t)last.myHero; r.cpuHero = (uint16_t)last.cpuHero;
+        r.myMove = (uint8_t)last.myMove; r.cpuMove = (uint8_t)last.cpuMove;
+        r.outcome = (uint8_t)last.outcome;
+    }
+}
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ * 文件名: replay.cpp
+ * 描述: 回放执行器 - 无界面地把回放文件中的每一局重新执行一遍，检查比分和出招序列是否与记录一致，
+ *       用于定位行为变化 (可配合 git bisect run) 以及离线重放真实对局做性能分析。
+ * 用法: replay [回放文件=replays.bin] [线程数=CPU核心数] [--repeat 遍数]
+ *       replay --generate <回放文件> <局数> [随机种子] [--adaptive]   生成随机玩家输入的回放 (用于测试和压测)
+ *       --adaptive: 电脑按出招模型出招 (模型边打边学一个有固定习惯的模拟玩家)，回放中记录电脑的出招
+ * 返回值: 全部一致返回 0，有不一致或无法读取返回 1
+ */
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include "replay.h"
+
+// 生成 count 局回放：玩家随机选阵容、随机出招，约一成回合按超时处理，电脑按均衡策略出招
+// adaptive 时玩家有一半的回合重复上一招，电脑按出招模型出招
+static int generate(const string& path, long long count, unsigned seed, bool adaptive) {
+    vector<Hero> heroes = DataManager::loadHeroRoster();
+    GameSolver solver;
+    MoveModel model;
+    BattleEngine engine(heroes, seed);
+    engine.solver = &solver;
+    if(adaptive) engine.model = &model;
+    GameRng player(seed, 2); // 流 0、1 归引擎
+
+    remove(path.c_str());
+    ReplayLog log;
+    if(!log.open(path)) { cerr << "无法写入 " << path << endl; return 1; }
+
+    vector<int> pool(heroes.size());
+    for(size_t i=0; i<pool.size(); ++i) pool[i] = i;
+    for(long long g=0; g<count; ++g) {
+        shuffle(pool.begin(), pool.end(), player);
+        engine.startNewGame(vector<int>(pool.begin(), pool.begin() + TEAM_SIZE));
+        model.startGame();
+        MoveType last = NONE;
+        while(!engine.isOver() && engine.prepareRound()) {
+            bool timedOut = player.below(10) == 0;
+            MoveType m = NONE;
+            if(timedOut) {
+                m = engine.randomAvailableMove();
+            } else {
+                if(adaptive && last != NONE && engine.canUse(last) && player.below(2) == 0) m = last;
+                while(m == NONE || !engine.canUse(m)) m = (MoveType)player.below(3);
+            }
+            engine.playRound(m);
+            engine.rounds.back().timedOut = timedOut;
+            model.record(m, timedOut);
+            last = m;
+        }
+        ReplayRecord r = ReplayRecord::fromEngine(engine);
+        log.append(&r, 1);
+    }
+    cout << "已生成 " << count << " 局回放 -> " << path << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> args;
+    int repeat = 1;
+    bool adaptive = false;
+    for(int i=1; i<argc; ++i) {
+        string a = argv[i];
+        if(a == "--repeat" && i + 1 < argc) repeat = max(1, atoi(argv[++i]));
+        else if(a == "--adaptive") adaptive = true;
+        else args.push_back(a);
+    }
+    if(!args.empty() && args[0] == "--generate") {
+        if(args.size() < 3) { cerr << "用法: replay --generate <回放文件> <局数> [随机种子] [--adaptive]" << endl; return 1; }
+        return generate(args[1], atoll(args[2].c_str()), args.size() > 3 ? (unsigned)atoll(args[3].c_str()) : (unsigned)time(0), adaptive);
+    }
+
+    string path = args.size() > 0 ? args[0] : "replays.bin";
+    int threads = args.size() > 1 ? atoi(args[1].c_str()) : (int)thread::hardware_concurrency();
+    if(threads <= 0) threads = 1;
+
+    ReplayFile file;
+    if(!file.open(path)) { cerr << "无法读取回放文件 " << path << endl; return 1; }
+    vector<Hero> roster = DataManager::loadHeroRoster();
+    uint64_t expectedRoster = MatchupTable::rosterHash(roster);
+    long long total = (long long)file.size();
+
+    cout << "回放 " << total << " 局 x " << repeat << " 遍, " << threads << " 个线程" << endl;
+
+    atomic<long long> ok{0}, failed{0}, skipped{0};
+    mutex printMtx;
+    const int MAX_REPORT = 10; // 只打印前几处不一致
+    auto t0 = chrono::steady_clock::now();
+
+    // 每个线程一个引擎、一个求解器和一份英雄表，按下标分段处理
+    vector<thread> workers;
+    for(int t=0; t<threads; ++t) {
+        workers.emplace_back([&, t]() {
+            vector<Hero> heroes = roster;
+            GameSolver solver;
+            BattleEngine engine(heroes);
+            long long begin = total * t / threads, end = total * (t + 1) / threads;
+            for(int rep=0; rep<repeat; ++rep) {
+                for(long long i=begin; i<end; ++i) {
+                    ReplayRecord r = file[i];
+                    if(r.rosterHash != expectedRoster) { skipped++; continue; }
+                    engine.solver = (r.flags & REPLAY_SOLVER) ? &solver : nullptr;
+                    string why;
+                    if(runReplay(engine, r, &why)) { ok++; continue; }
+                    if(failed++ < MAX_REPORT) {
+                        lock_guard<mutex> lk(printMtx);
+                        cout << "  #" << i << " (种子 " << r.seed << "): " << why << endl;
+                    }
+                }
+            }
+        });
+    }
+    for(auto& w : workers) w.join();
+
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    long long done = ok + failed;
+    cout << fixed << setprecision(2);
+    cout << "一致 " << ok << ", 不一致 " << failed << ", 英雄名单不同而跳过 " << skipped << endl;
+    cout << "耗时 " << secs << " 秒, " << (secs > 0 ? done / secs : 0.0) << " 局/秒" << endl;
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,221 @@
+/**
+ * 文件名: replay.h
+ * 描述: 对局回放 - 一局比赛由“本局种子 + 玩家每回合的输入”完全决定，
+ *       回放文件只保存这些，再附上结果校验值；重新执行时用同样的种子和输入驱动对战引擎，
+ *       检查比分和每回合的出招是否与记录一致。
+ * 文件布局: [文件头 "KOPR" + 版本][定长记录 x N]，记录只追加，可以直接内存映射后按下标访问。
+ */
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "battle_engine.h"
+#include "matchup_table.h"
+#include "mapped_file.h"
+
+const uint32_t REPLAY_VERSION = 3; // 版本 3: 随机数改为 GameRng (rng.h)，同一种子的对局与旧版不同；版本 2: 英雄下标改为 16 位
+
+// ReplayRecord::flags
+const uint8_t REPLAY_SOLVER = 1;   // 电脑按博弈求解器的均衡策略出招 (否则为加权随机)
+const uint8_t REPLAY_ADAPTIVE = 2; // 电脑按玩家出招模型出招：重现不了，电脑每回合的出招记在 cpuInputs 中
+// ReplayRecord::inputs 的第 3 位
+const uint8_t REPLAY_TIMEOUT = 4;  // 玩家超时，由系统随机代出 (代出的招同样来自引擎的随机数)
+
+struct ReplayFileHeader {
+    char magic[4];    // "KOPR"
+    uint32_t version; // REPLAY_VERSION
+};
+
+// 一局的回放记录，定长 48 字节
+struct ReplayRecord {
+    uint64_t rosterHash;             // 英雄名单哈希 (名单变了回放就没有意义)
+    uint32_t seed;                   // 本局种子
+    uint32_t digest;                 // 各回合双方英雄和出招的哈希，用于校验
+    uint16_t myLineup[TEAM_SIZE];
+    uint16_t cpuLineup[TEAM_SIZE];   // 由种子决定，回放时校验
+    uint8_t flags;
+    uint8_t roundCount;              // 实际打了几回合
+    uint8_t myScore, cpuScore;
+    uint8_t inputs[MAX_ROUNDS];      // 每回合玩家的输入：低 2 位为招，REPLAY_TIMEOUT 表示超时
+    uint8_t cpuInputs[5];            // 仅 REPLAY_ADAPTIVE：每回合电脑的 (英雄位置 << 2 | 招)，每回合 4 位
+    uint8_t reserved[2];
+
+    // 第 round 回合 (从 0 起) 电脑的出招编码
+    uint8_t cpuInput(int round) const { return (cpuInputs[round / 2] >> (round % 2 * 4)) & 15; }
+
+    // 回合序列的 FNV-1a 哈希
+    static uint32_t digestOf(const vector<RoundResult>& rounds) {
+        uint32_t h = 2166136261u;
+        auto mix = [&h](int v) { h ^= (unsigned char)v; h *= 16777619u; };
+        size_t n = min(rounds.size(), (size_t)MAX_ROUNDS); // 与 roundCount 一致，只算记录得下的回合
+        for(size_t i=0; i<n; ++i) {
+            const RoundResult& r = rounds[i];
+            mix(r.myHero); mix(r.myHero >> 8); mix(r.cpuHero); mix(r.cpuHero >> 8);
+            mix(r.myMove); mix(r.cpuMove);
+        }
+        return h;
+    }
+
+    // 从刚结束的一局生成回放记录
+    static ReplayRecord fromEngine(const BattleEngine& e) {
+        ReplayRecord r = {};
+        r.rosterHash = MatchupTable::rosterHash(e.heroes);
+        r.seed = e.matchSeed;
+        r.digest = digestOf(e.rounds);
+        r.flags = (e.solver ? REPLAY_SOLVER : 0) | (e.model ? REPLAY_ADAPTIVE : 0);
+        // 记录是定长的，最多 MAX_ROUNDS 回合；引擎不会多打，这里再截一次，不让越界写坏记录
+        size_t n = min(e.rounds.size(), (size_t)MAX_ROUNDS);
+        r.roundCount = (uint8_t)n;
+        r.myScore = (uint8_t)e.myScore;
+        r.cpuScore = (uint8_t)e.cpuScore;
+        for(int i=0; i<TEAM_SIZE; ++i) {
+            r.myLineup[i] = (uint16_t)e.myHeroIndices[i];
+            r.cpuLineup[i] = (uint16_t)e.cpuHeroIndices[i];
+        }
+        for(size_t i=0; i<n; ++i) {
+            r.inputs[i] = (uint8_t)(e.rounds[i].myMove | (e.rounds[i].timedOut ? REPLAY_TIMEOUT : 0));
+            if(e.model) {
+                int slot = 0;
+                while(slot < TEAM_SIZE - 1 && e.cpuHeroIndices[slot] != e.rounds[i].cpuHero) slot++;
+                r.cpuInputs[i / 2] |= (uint8_t)((slot << 2 | e.rounds[i].cpuMove) << (i % 2 * 4));
+            }
+        }
+        return r;
+    }
+};
+
+static_assert(sizeof(ReplayRecord) == 48, "ReplayRecord 必须是定长 48 字节");
+
+// ==========================================
+// 函数: runReplay (重新执行一局)
+// 描述: 用记录中的种子和输入驱动引擎 (引擎的 heroes 应当是同一份英雄名单，solver 由调用方准备)，
+//       流程与界面一致：电脑无牌可出时提前结束，超时回合由 randomAvailableMove 代出；
+//       按出招模型打的对局 (REPLAY_ADAPTIVE) 照记录执行电脑的出招，只校验它合法、结果一致。
+//       结果与记录一致返回 true，否则返回 false 并在 why 中说明第一处不一致
+// ==========================================
+inline bool runReplay(BattleEngine& e, const ReplayRecord& r, string* why = nullptr) {
+    auto fail = [why](const string& msg) { if(why) *why = msg; return false; };
+
+    vector<int> mine(r.myLineup, r.myLineup + TEAM_SIZE);
+    uint8_t script[MAX_ROUNDS];
+    for(int i=0; i<MAX_ROUNDS; ++i) script[i] = r.cpuInput(i);
+    struct ScriptGuard { // 无论从哪里返回都把引擎恢复原样
+        BattleEngine& e;
+        ~ScriptGuard() { e.cpuScript = nullptr; }
+    } guard{ e };
+    e.cpuScript = (r.flags & REPLAY_ADAPTIVE) ? script : nullptr;
+    e.startNewGame(mine, r.seed);
+    for(int i=0; i<TEAM_SIZE; ++i) {
+        if(e.cpuHeroIndices[i] != r.cpuLineup[i]) return fail("电脑阵容不一致");
+    }
+
+    int n = 0;
+    while(!e.isOver()) {
+        if(!e.prepareRound()) break;
+        if(n >= r.roundCount) return fail("第 " + to_string(n + 1) + " 回合缺少玩家输入");
+        uint8_t in = r.inputs[n++];
+        MoveType m = (MoveType)(in & 3);
+        if(in & REPLAY_TIMEOUT) {
+            if(e.randomAvailableMove() != m) return fail("第 " + to_string(n) + " 回合超时代出的招不一致");
+        }
+        if(m > PAPER || !e.canUse(m)) return fail("第 " + to_string(n) + " 回合的输入无法执行");
+        e.playRound(m);
+    }
+
+    if(n != r.roundCount) return fail("回合数不一致");
+    if(e.myScore != r.myScore || e.cpuScore != r.cpuScore) {
+        return fail("比分不一致: 记录 " + to_string(r.myScore) + ":" + to_string(r.cpuScore)
+                    + ", 重放 " + to_string(e.myScore) + ":" + to_string(e.cpuScore));
+    }
+    if(ReplayRecord::digestOf(e.rounds) != r.digest) return fail("出招序列不一致");
+    return true;
+}
+
+// ==========================================
+// 类: ReplayLog (回放文件追加写入)
+// 描述: 文件不存在时新建并写文件头；已有文件的版本不对时改名为 <路径>.old 后新建
+// ==========================================
+class ReplayLog {
+public:
+    ~ReplayLog() { close(); }
+
+    bool open(const string& path) {
+        close();
+        ReplayFileHeader h = {};
+        FILE* f = fopen(path.c_str(), "rb");
+        if(f) {
+            bool valid = fread(&h, sizeof(h), 1, f) == 1 && memcmp(h.magic, "KOPR", 4) == 0
+                         && h.version == REPLAY_VERSION;
+            fseek(f, 0, SEEK_END);
+            long size = ftell(f);
+            fclose(f);
+            if(valid) {
+                // 上次写到一半的残缺记录截掉不要：从最后一条完整记录之后接着写
+                long tail = (size - (long)sizeof(h)) % (long)sizeof(ReplayRecord);
+                file = fopen(path.c_str(), "r+b");
+                if(file) fseek(file, size - tail, SEEK_SET);
+                return file != nullptr;
+            }
+            if(size > 0) {
+                string old = path + ".old";
+                remove(old.c_str());
+                rename(path.c_str(), old.c_str());
+            }
+        }
+        file = fopen(path.c_str(), "wb");
+        if(!file) return false;
+        memcpy(h.magic, "KOPR", 4);
+        h.version = REPLAY_VERSION;
+        return fwrite(&h, sizeof(h), 1, file) == 1;
+    }
+
+    bool append(const ReplayRecord* recs, size_t n) {
+        return file && fwrite(recs, sizeof(ReplayRecord), n, file) == n;
+    }
+
+    FILE* handle() const { return file; }
+
+    void close() {
+        if(file) { fclose(file); file = nullptr; }
+    }
+
+private:
+    FILE* file = nullptr;
+};
+
+// ==========================================
+// 类: ReplayFile (回放文件只读访问)
+// 描述: 内存映射后直接按下标取记录，不做解析
+// ==========================================
+class ReplayFile {
+public:
+    bool open(const string& path) {
+        count = 0;
+        if(!file.open(path)) return false;
+        const ReplayFileHeader* h = (const ReplayFileHeader*)file.data();
+        if(file.size() < sizeof(ReplayFileHeader) || memcmp(h->magic, "KOPR", 4) != 0 || h->version != REPLAY_VERSION) {
+            file.close();
+            return false;
+        }
+        count = (file.size() - sizeof(ReplayFileHeader)) / sizeof(ReplayRecord); // 末尾的残缺记录忽略
+        return true;
+    }
+
+    size_t size() const { return count; }
+
+    ReplayRecord operator[](size_t i) const {
+        ReplayRecord r;
+        memcpy(&r, file.data() + sizeof(ReplayFileHeader) + i * sizeof(ReplayRecord), sizeof(r));
+        return r;
+    }
+
+private:
+    MappedFile file;
+    size_t count = 0;
+};
+
+#endif
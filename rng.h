@@ -0,0 +1,98 @@
+/**
+ * 文件名: rng.h
+ * 描述: 游戏用随机数 - xoshiro128** 生成器 (16 字节状态，每次几条移位/乘法指令)，
+ *       按 (种子, 流编号) 播种：同一个主种子下不同编号的流互不相关，每局、每个工作线程各用一条，
+ *       结果只由主种子和编号决定，与线程调度无关。
+ *       另提供无偏的有界整数 below(n)，代替有偏差的 rng() % n。
+ * 注意: 满足标准库的 UniformRandomBitGenerator 要求 (32 位输出)，可以直接交给 shuffle、uniform_int_distribution；
+ *       但回放要跨平台重现，引擎里只用 below() 和原始输出，不用标准库的分布。
+ */
+#ifndef RNG_H
+#define RNG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+using namespace std;
+
+// SplitMix64：把任意 64 位数打散成均匀分布的 64 位数，用来从 (种子, 流编号) 展开初始状态
+inline uint64_t splitMix64(uint64_t& x) {
+    uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// ==========================================
+// 类: GameRng (xoshiro128**)
+// ==========================================
+class GameRng {
+public:
+    typedef uint32_t result_type;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    explicit GameRng(uint64_t seed = 0, uint64_t stream = 0) { this->seed(seed, stream); }
+
+    // 种子和流编号各过一遍 SplitMix64 再合起来展开成状态：相邻的种子、相邻的编号得到的状态也毫不相关
+    void seed(uint64_t seed, uint64_t stream = 0) {
+        uint64_t a = seed, b = stream ^ 0x6A09E667F3BCC909ull;
+        uint64_t x = splitMix64(a) ^ (splitMix64(b) * 0xD1342543DE82EF95ull);
+        uint64_t lo = splitMix64(x), hi = splitMix64(x);
+        s[0] = (uint32_t)lo; s[1] = (uint32_t)(lo >> 32);
+        s[2] = (uint32_t)hi; s[3] = (uint32_t)(hi >> 32);
+        if((s[0] | s[1] | s[2] | s[3]) == 0) s[0] = 1; // 全 0 状态不能用 (概率可以忽略)
+    }
+
+    result_type operator()() {
+        uint32_t result = rotl(s[1] * 5, 7) * 9;
+        uint32_t t = s[1] << 9;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 11);
+        return result;
+    }
+
+    // [0, n) 内均匀的整数 (n > 0)：乘法取高位，落在偏差区间时重抽 (Lemire 算法)，绝大多数情况不用除法
+    uint32_t below(uint32_t n) {
+        uint64_t m = (uint64_t)(*this)() * n;
+        uint32_t low = (uint32_t)m;
+        if(low < n) {
+            uint32_t threshold = (0u - n) % n;
+            while(low < threshold) {
+                m = (uint64_t)(*this)() * n;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+    // 64 位输出 (两次 32 位拼接)，用来给别的流当种子
+    uint64_t next64() {
+        uint64_t hi = (*this)();
+        return hi << 32 | (*this)();
+    }
+
+    // 派生一条子流：取本流的下一个 64 位输出作种子，编号为 stream。主流推进的方式固定，子流也就可以重现
+    GameRng split(uint64_t stream) { return GameRng(next64(), stream); }
+
+    // 不可重现的新种子：随机设备、单调时钟和进程内计数器混在一起，同一秒 (甚至同一纳秒) 内开的两局也不会相同
+    static uint64_t freshSeed() {
+        static atomic<uint64_t> counter{0};
+        uint64_t x = (uint64_t)chrono::steady_clock::now().time_since_epoch().count()
+                   ^ (uint64_t)random_device()() << 32 ^ counter.fetch_add(1, memory_order_relaxed) * 0x9E3779B97F4A7C15ull;
+        return splitMix64(x);
+    }
+
+private:
+    uint32_t s[4];
+
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+};
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * 文件名: rules.h
+ * 描述: 规则层 - 把“有哪些招、谁克谁、赢一回合得几分、库存怎么打包”从引擎里抽出来，按招数集合做成模板。
+ *       一个变体只需给出招数个数、招名和得分矩阵，胜负表、打包库存的布局都在编译期生成 (constexpr)，
+ *       运行时只剩查表和移位，没有分支。默认的三招猜拳 ClassicMoves 与原来的
+ *       (我方招 - 电脑招 + 3) % 3 完全一致 (文件末尾有编译期校验)。
+ * 注意: 纯逻辑头文件，只依赖标准库；招数在这里都是 0 起的整数，与 game_data.h 的 MoveType 取值相同。
+ */
+#ifndef RULES_H
+#define RULES_H
+
+#include <cstdint>
+#include <type_traits>
+
+// 单回合结算结果的编码 (与引擎、回放、对战记录一致)
+const int OUTCOME_DRAW = 0; // 平
+const int OUTCOME_WIN = 1;  // 我方胜
+const int OUTCOME_LOSS = 2; // 我方负
+
+// ==========================================
+// 变体: ClassicMoves (三招猜拳)
+// 变体需要提供: MOVES (招数个数), NAMES (招名), PAYOFF[a][b] (a 对上 b 时出 a 的一方得几分)
+// 得分矩阵不要求对称，例如可以让“石头砸剪刀”得 2 分；胜负按双方得分比较
+// ==========================================
+struct ClassicMoves {
+    static constexpr int MOVES = 3;
+    static constexpr const char* NAMES[MOVES] = { "剪刀", "石头", "布" };
+    static constexpr int PAYOFF[MOVES][MOVES] = {
+        // 剪刀 石头 布
+        {  0,   0,   1 }, // 剪刀剪布
+        {  1,   0,   0 }, // 石头砸剪刀
+        {  0,   1,   0 }, // 布包石头
+    };
+};
+
+// ==========================================
+// 变体: LizardSpockMoves (五招猜拳：剪刀、石头、布、蜥蜴、史波克)
+// 前三招与经典规则相同，每招克两招、被两招克
+// ==========================================
+struct LizardSpockMoves {
+    static constexpr int MOVES = 5;
+    static constexpr const char* NAMES[MOVES] = { "剪刀", "石头", "布", "蜥蜴", "史波克" };
+    static constexpr int PAYOFF[MOVES][MOVES] = {
+        // 剪刀 石头 布 蜥蜴 史波克
+        {  0,   0,   1,  1,   0 }, // 剪刀剪布、斩蜥蜴
+        {  1,   0,   0,  1,   0 }, // 石头砸剪刀、压蜥蜴
+        {  0,   1,   0,  0,   1 }, // 布包石头、驳倒史波克
+        {  0,   0,   1,  0,   1 }, // 蜥蜴吃布、毒史波克
+        {  1,   1,   0,  0,   0 }, // 史波克拆剪刀、蒸发石头
+    };
+};
+
+// ==========================================
+// 模板: PackedLayout (打包库存布局)
+// 描述: 每种招占 4 位 (最多 15 个)，按招数个数选最小的整数类型：3 招 16 位，5 招 32 位
+// ==========================================
+template <int MOVES>
+struct PackedLayout {
+    static constexpr int BITS = 4;
+    static constexpr int MASK = (1 << BITS) - 1;
+    typedef typename std::conditional<MOVES * BITS <= 16, uint16_t,
+            typename std::conditional<MOVES * BITS <= 32, uint32_t, uint64_t>::type>::type Packed;
+
+    static constexpr Packed pack(const int counts[MOVES]) {
+        Packed inv = 0;
+        for(int m=0; m<MOVES; ++m) inv |= (Packed)((Packed)(counts[m] & MASK) << (m * BITS));
+        return inv;
+    }
+
+    static constexpr int count(Packed inv, int m) { return inv >> (m * BITS) & MASK; }
+
+    // 循环次数是编译期常量，编译器会完全展开
+    static constexpr int total(Packed inv) {
+        int t = 0;
+        for(int m=0; m<MOVES; ++m) t += count(inv, m);
+        return t;
+    }
+
+    // 扣除一招库存 (调用方保证该招数量 > 0)
+    static constexpr Packed remove(Packed inv, int m) { return (Packed)(inv - ((Packed)1 << (m * BITS))); }
+
+    // 加权随机出招，u 为一个 32 位均匀随机数：把 u 映射到 [0, total) 得到 x，
+    // x 落在第几段前缀和里就是第几招 (各段比较结果相加，没有分支)；库存为空时返回 -1
+    static constexpr int sample(Packed inv, uint32_t u) {
+        uint32_t total = 0, bound[MOVES] = {};
+        for(int m=0; m<MOVES; ++m) bound[m] = total += count(inv, m);
+        uint32_t x = (uint32_t)(((uint64_t)u * total) >> 32); // 乘法取高位代替取模
+        int m = 0;
+        for(int k=0; k<MOVES-1; ++k) m += x >= bound[k];
+        return m | -(int)(total == 0);
+    }
+};
+
+// 胜负表：在编译期由得分矩阵生成，按双方得分比较
+template <class Variant>
+struct OutcomeTable {
+    uint8_t v[Variant::MOVES][Variant::MOVES];
+
+    constexpr OutcomeTable() : v() {
+        for(int a=0; a<Variant::MOVES; ++a) {
+            for(int b=0; b<Variant::MOVES; ++b) {
+                int mine = Variant::PAYOFF[a][b], theirs = Variant::PAYOFF[b][a];
+                v[a][b] = mine > theirs ? OUTCOME_WIN : mine < theirs ? OUTCOME_LOSS : OUTCOME_DRAW;
+            }
+        }
+    }
+};
+
+// ==========================================
+// 模板: RuleSet (一个变体的全部规则)
+// 描述: outcome / points 都是一次查表
+// ==========================================
+template <class Variant>
+class RuleSet {
+public:
+    static constexpr int MOVES = Variant::MOVES;
+    typedef PackedLayout<MOVES> Layout;
+
+    // 我方出 my、对方出 other 时的结算结果 (OUTCOME_*)
+    static constexpr int outcome(int my, int other) { return TABLE.v[my][other]; }
+
+    // 我方出 my、对方出 other 时我方得几分
+    static constexpr int points(int my, int other) { return Variant::PAYOFF[my][other]; }
+
+    static constexpr const char* name(int m) { return Variant::NAMES[m]; }
+
+private:
+    static constexpr OutcomeTable<Variant> TABLE = OutcomeTable<Variant>();
+};
+
+typedef RuleSet<ClassicMoves> ClassicRules;
+typedef RuleSet<LizardSpockMoves> LizardSpockRules;
+
+// 编译期校验：经典规则的胜负表与原来的公式逐项相同，五招变体每招恰好克两招
+namespace rules_check {
+    constexpr bool classicMatchesFormula() {
+        for(int a=0; a<3; ++a)
+            for(int b=0; b<3; ++b)
+                if(ClassicRules::outcome(a, b) != (a - b + 3) % 3) return false;
+        return true;
+    }
+
+    template <class Rules>
+    constexpr bool balanced(int beats) {
+        for(int a=0; a<Rules::MOVES; ++a) {
+            int n = 0;
+            for(int b=0; b<Rules::MOVES; ++b) n += Rules::outcome(a, b) == OUTCOME_WIN;
+            if(n != beats || Rules::outcome(a, a) != OUTCOME_DRAW) return false;
+        }
+        return true;
+    }
+}
+
+static_assert(rules_check::classicMatchesFormula(), "经典规则的胜负表必须与 (a - b + 3) % 3 一致");
+static_assert(rules_check::balanced<LizardSpockRules>(2), "五招变体每招应克两招");
+static_assert(sizeof(ClassicRules::Layout::Packed) == 2, "三招库存应打包进 2 字节");
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ * 文件名: server.cpp
+ * 描述: 对战服务器入口 - 启动 GameServer，每隔几秒打印一次吞吐量和在线对局数。
+ * 用法: server [端口=7700] [工作线程数=CPU核心数] [监听地址=127.0.0.1] [--trace 追踪文件] [--seed 主种子] [--rated]
+ *       --trace: 记录请求处理耗时，随吞吐量报告一起打印耗时摘要，并定期写出 Chrome 追踪格式的文件
+ *       --seed: 固定随机数主种子 (排查问题时用)，默认每次启动取新种子
+ *       --rated: 开积分赛，玩家数据用当前目录下的 users.dat 等文件 (与界面相同)
+ *       界面以 "--server 127.0.0.1:7700" 启动即作为瘦客户端连接；压测用 loadtest。
+ */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include "game_server.h"
+
+int main(int argc, char* argv[]) {
+    vector<string> args;
+    string tracePath;
+    uint64_t seed = 0;
+    bool rated = false;
+    for(int i=1; i<argc; ++i) {
+        string a = argv[i];
+        if(a == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if(a == "--seed" && i + 1 < argc) seed = strtoull(argv[++i], nullptr, 10);
+        else if(a == "--rated") rated = true;
+        else args.push_back(a);
+    }
+    GameServer::Config cfg;
+    if(args.size() > 0) cfg.port = atoi(args[0].c_str());
+    if(args.size() > 1) cfg.threads = max(1, atoi(args[1].c_str()));
+    if(args.size() > 2) cfg.host = args[2];
+    cfg.seed = seed;
+    cfg.rated = rated;
+    if(!tracePath.empty()) Trace::start(tracePath, 0); // 摘要随下面的吞吐量报告打印
+
+    GameServer server;
+    if(!server.start(cfg)) {
+        cerr << "无法监听 " << cfg.host << ":" << cfg.port << endl;
+        return 1;
+    }
+    cout << "对战服务器已启动 " << cfg.host << ":" << server.port() << ", " << cfg.threads << " 个工作线程" << endl;
+    if(rated) cout << "积分赛已开启, " << server.players()->playerCount() << " 名玩家" << endl;
+
+    const int REPORT_SEC = 5;
+    long long lastRequests = 0, lastMatches = 0, lastRounds = 0;
+    cout << fixed << setprecision(0);
+    for(;;) {
+        this_thread::sleep_for(chrono::seconds(REPORT_SEC));
+        long long req = server.requests, started = server.matchesStarted;
+        StatsSnapshot stats = server.heroStats(); // 汇总各线程的统计分片，不打断工作线程
+        cout << "请求 " << (req - lastRequests) / (double)REPORT_SEC << "/秒, "
+             << "新对局 " << (started - lastMatches) / (double)REPORT_SEC << "/秒, "
+             << "回合 " << (stats.rounds - lastRounds) / (double)REPORT_SEC << "/秒, "
+             << "进行中 " << server.matchesActive << " 局, "
+             << "超时代出 " << server.turnTimeouts << " 回合, "
+             << "连接 " << server.connections << endl;
+        if(rated) {
+            cout << "积分赛: 排队 " << server.ratedQueued << " 人, 已配对 " << server.ratedStarted
+                 << " 局, 已结算 " << server.ratedFinished << " 局" << endl;
+        }
+        lastRequests = req;
+        lastMatches = started;
+        lastRounds = stats.rounds;
+        if(Trace::on()) {
+            cerr << Trace::summary();
+            Trace::instance().writeChromeJson(tracePath);
+        }
+    }
+}
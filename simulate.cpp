@@ -0,0 +1,139 @@
+/**
+ * 文件名: simulate.cpp
+ * 描述: 无界面对战模拟器 - 用全部 CPU 核心跑大量电脑对电脑的 9 回合比赛，
+ *       统计每秒对局数和每个英雄的胜率，用于衡量平衡性和回归。
+ * 用法: simulate [对局数=1000000] [线程数=CPU核心数] [随机种子=当前时间] [--history 文件]
+ *       指定 --history 时每局的完整记录都交给写线程追加到该文件 (多个模拟线程同时提交)
+ */
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <string>
+#include "battle_engine.h"
+#include "match_history.h"
+
+// 每个线程独立统计，结束后再汇总，避免线程间争用
+// (回合胜率、招数统计写在各线程的 HeroStats 分片里，英雄表所有线程共用且只读)
+struct SimStats {
+    long long games = 0;
+    long long myWins = 0, cpuWins = 0, draws = 0;
+    vector<long long> heroGames, heroGameWins; // 每个英雄参与的对局数 / 获胜的对局数
+};
+
+static void runWorker(SimStats& st, vector<Hero>& roster, HeroStats& rounds, long long games, uint64_t seed, int stream,
+                      HistoryWriter* history) {
+    BattleEngine engine(roster, seed, stream); // 各线程同一主种子、不同的流
+    engine.stats = rounds.addShard();
+    int n = roster.size();
+    vector<int> pool(n);
+    for(int i=0; i<n; ++i) pool[i] = i;
+
+    for(long long g=0; g<games; ++g) {
+        // 双方各自随机选 3 个不同的英雄 (两边之间可以重复，与界面中电脑选人一致)
+        shuffle(pool.begin(), pool.end(), engine.rng);
+        vector<int> mine(pool.begin(), pool.begin() + TEAM_SIZE);
+        shuffle(pool.begin(), pool.end(), engine.rng);
+        vector<int> cpu(pool.begin(), pool.begin() + TEAM_SIZE);
+
+        long long startMs = history ? epochMillis() : 0;
+        int res = engine.playAutoGame(mine, cpu);
+        if(history) history->submitWait(MatchRecord::fromEngine(engine, "sim", startMs));
+        st.games++;
+        if(res > 0) st.myWins++;
+        else if(res < 0) st.cpuWins++;
+        else st.draws++;
+
+        for(int idx : mine) { st.heroGames[idx]++; if(res > 0) st.heroGameWins[idx]++; }
+        for(int idx : cpu)  { st.heroGames[idx]++; if(res < 0) st.heroGameWins[idx]++; }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // 先取出 --history 选项，剩下的按位置解析
+    vector<string> args;
+    string historyPath;
+    for(int i=1; i<argc; ++i) {
+        string a = argv[i];
+        if(a == "--history" && i + 1 < argc) historyPath = argv[++i];
+        else args.push_back(a);
+    }
+    long long totalGames = args.size() > 0 ? atoll(args[0].c_str()) : 1000000;
+    int threads = args.size() > 1 ? atoi(args[1].c_str()) : (int)thread::hardware_concurrency();
+    unsigned seed = args.size() > 2 ? (unsigned)atoll(args[2].c_str()) : (unsigned)time(0);
+    if(threads <= 0) threads = 1;
+
+    unique_ptr<HistoryWriter> history;
+    if(!historyPath.empty()) {
+        HistoryWriter::Config cfg;
+        cfg.path = historyPath;
+        cfg.replayPath = ""; // 电脑对电脑的对局没有玩家输入，不写回放
+        cfg.columnarPath = historyPath + ".kpc";
+        history.reset(new HistoryWriter(cfg));
+    }
+
+    vector<Hero> roster = DataManager::loadHeroRoster();
+    HeroStats roundStats(roster.size());
+    vector<SimStats> stats(threads);
+    for(auto& st : stats) {
+        st.heroGames.assign(roster.size(), 0);
+        st.heroGameWins.assign(roster.size(), 0);
+    }
+
+    cout << "模拟 " << totalGames << " 局, " << threads << " 个线程, 种子 " << seed << endl;
+    auto t0 = chrono::steady_clock::now();
+
+    vector<thread> workers;
+    for(int t=0; t<threads; ++t) {
+        // 对局数平均分给各线程，余数给前几个线程
+        long long games = totalGames / threads + (t < totalGames % threads ? 1 : 0);
+        workers.emplace_back(runWorker, ref(stats[t]), ref(roster), ref(roundStats), games, (uint64_t)seed, t, history.get());
+    }
+    for(auto& w : workers) w.join();
+    if(history) history->stop(); // 剩余记录写完并落盘后再计时
+
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    // 汇总各线程的结果
+    SimStats total;
+    StatsSnapshot rounds = roundStats.snapshot();
+    total.heroGames.assign(roster.size(), 0);
+    total.heroGameWins.assign(roster.size(), 0);
+    for(auto& st : stats) {
+        total.games += st.games;
+        total.myWins += st.myWins; total.cpuWins += st.cpuWins; total.draws += st.draws;
+        for(size_t i=0; i<roster.size(); ++i) {
+            total.heroGames[i] += st.heroGames[i];
+            total.heroGameWins[i] += st.heroGameWins[i];
+        }
+    }
+
+    cout << fixed << setprecision(2);
+    cout << "耗时 " << secs << " 秒, " << (secs > 0 ? total.games / secs : 0.0) << " 局/秒" << endl;
+    if(history) {
+        cout << "对战记录: 写入 " << history->written << " 局, 丢弃 " << history->dropped
+             << " 局, 写文件 " << history->flushes << " 次 -> " << historyPath << endl;
+    }
+    cout << "先手方胜 " << total.myWins << ", 后手方胜 " << total.cpuWins << ", 平局 " << total.draws << endl;
+    cout << "共 " << rounds.rounds << " 回合, 各招数出招次数 / 赢下回合的比例:";
+    for(int m=SCISSORS; m<=PAPER; ++m) {
+        cout << " " << moveToString((MoveType)m) << " " << rounds.moveUsed[m] << " / "
+             << (rounds.moveUsed[m] ? rounds.moveWon[m] * 100.0 / rounds.moveUsed[m] : 0.0) << "%";
+    }
+    cout << endl;
+
+    // 按对局胜率从高到低输出英雄榜
+    vector<int> order(roster.size());
+    for(size_t i=0; i<order.size(); ++i) order[i] = i;
+    auto gameRate = [&](int i) {
+        return total.heroGames[i] ? (double)total.heroGameWins[i] / total.heroGames[i] * 100.0 : 0.0;
+    };
+    sort(order.begin(), order.end(), [&](int a, int b){ return gameRate(a) > gameRate(b); });
+
+    cout << "\n英雄\t对局胜率\t回合胜率\t出场局数" << endl;
+    for(int i : order) {
+        cout << roster[i].name << "\t" << gameRate(i) << "%\t\t"
+             << rounds.winRate(i) << "%\t\t" << total.heroGames[i] << endl;
+    }
+    return 0;
+}
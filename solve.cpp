@@ -0,0 +1,95 @@
+/**
+ * 文件名: solve.cpp
+ * 描述: 博弈求解命令行工具 - 求某对阵容开局时的博弈值和均衡策略，并报告求解耗时与置换表命中率。
+ * 用法: solve a1 a2 a3 b1 b2 b3    求解指定阵容 (英雄在 heroes.txt 名单中的索引，从 0 开始)
+ *       solve [对数=100] [种子]      随机抽若干对阵容，统计平均求解耗时
+ */
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include "battle_engine.h"
+
+// 用双方阵容的初始库存构造开局状态
+static MatchState openingState(const vector<Hero>& heroes, const vector<int>& mine, const vector<int>& cpu) {
+    MatchState s = {};
+    for(int i=0; i<TEAM_SIZE; ++i) {
+        const Hero& a = heroes[mine[i]];
+        const Hero& b = heroes[cpu[i]];
+        s.my[SCISSORS] += a.s; s.my[ROCK] += a.r; s.my[PAPER] += a.p;
+        s.cpu[SCISSORS] += b.s; s.cpu[ROCK] += b.r; s.cpu[PAPER] += b.p;
+    }
+    s.round = 1;
+    s.scoreDiff = 0;
+    return s;
+}
+
+static void printStrategy(const char* who, const double st[3]) {
+    cout << who << " 剪刀 " << st[SCISSORS] << "  石头 " << st[ROCK] << "  布 " << st[PAPER] << endl;
+}
+
+int main(int argc, char* argv[]) {
+    vector<Hero> heroes = DataManager::loadHeroRoster();
+    cout << fixed << setprecision(4);
+
+    if(argc == 7) {
+        vector<int> mine, cpu;
+        for(int i=1; i<=6; ++i) {
+            int idx = atoi(argv[i]);
+            if(idx < 0 || idx >= (int)heroes.size()) { cout << "英雄索引越界: " << argv[i] << endl; return 1; }
+            (i <= 3 ? mine : cpu).push_back(idx);
+        }
+        GameSolver solver;
+        auto t0 = chrono::steady_clock::now();
+        SolveResult r = solver.solve(openingState(heroes, mine, cpu));
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+        cout << "我方: ";
+        for(int i : mine) cout << heroes[i].name << " ";
+        cout << "\n电脑: ";
+        for(int i : cpu) cout << heroes[i].name << " ";
+        cout << "\n博弈值 (胜=1 平=0 负=-1): " << r.value << endl;
+        printStrategy("我方首回合策略:", r.myStrategy);
+        printStrategy("电脑首回合策略:", r.cpuStrategy);
+        cout << "耗时 " << ms << " ms, 展开局面 " << solver.nodes
+             << ", 置换表 " << solver.table.size() << " 项, 命中率 " << solver.table.hitRate() * 100 << "%" << endl;
+        return 0;
+    }
+
+    int pairs = argc > 1 ? atoi(argv[1]) : 100;
+    if(pairs <= 0) { cout << "阵容对数必须大于 0: " << argv[1] << endl; return 1; }
+    unsigned seed = argc > 2 ? (unsigned)atoll(argv[2]) : (unsigned)time(0);
+    mt19937 rng(seed);
+    vector<int> pool(heroes.size());
+    for(size_t i=0; i<pool.size(); ++i) pool[i] = i;
+
+    // 每对阵容用全新的置换表，测的是“整棵树从零求解”的耗时
+    double totalMs = 0, maxMs = 0, totalHitRate = 0;
+    long long totalNodes = 0;
+    // 所有阵容共用一张置换表，测的是跨对局复用的效果
+    GameSolver shared;
+    for(int i=0; i<pairs; ++i) {
+        shuffle(pool.begin(), pool.end(), rng);
+        vector<int> mine(pool.begin(), pool.begin() + TEAM_SIZE);
+        shuffle(pool.begin(), pool.end(), rng);
+        vector<int> cpu(pool.begin(), pool.begin() + TEAM_SIZE);
+        MatchState s = openingState(heroes, mine, cpu);
+
+        GameSolver solver;
+        auto t0 = chrono::steady_clock::now();
+        solver.solve(s);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        totalMs += ms;
+        maxMs = max(maxMs, ms);
+        totalNodes += solver.nodes;
+        totalHitRate += solver.table.hitRate();
+
+        shared.solve(s);
+    }
+
+    cout << "随机 " << pairs << " 对阵容, 种子 " << seed << endl;
+    cout << "单对求解: 平均 " << totalMs / pairs << " ms, 最长 " << maxMs << " ms, 平均展开局面 "
+         << totalNodes / pairs << ", 平均命中率 " << totalHitRate / pairs * 100 << "%" << endl;
+    cout << "共享置换表: " << shared.table.size() << " 项, 展开局面 " << shared.nodes
+         << ", 命中率 " << shared.table.hitRate() * 100 << "%" << endl;
+    return 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * 文件名: timer_wheel.h
+ * 描述: 分层时间轮 - 在一个线程里管理大量截止时间 (例如服务器上每局的出招时限)，按单调时钟精确到毫秒。
+ * 结构: 4 层，每层 256 个槽：第 0 层一个槽 1 毫秒 (覆盖 256 毫秒)，第 1 层一个槽 256 毫秒 (约 65 秒)，
+ *       依此类推，最远约 49 天。定时器按“离现在多远”放进对应层的槽 (双向链表)，
+ *       所以设置、取消都是 O(1)；第 0 层转完一圈时，把上一层下一个槽里的定时器分到下层 (级联)。
+ *       每层另有一张 256 位的占用位图，推进时钟时直接跳过空槽，空闲很久之后推进也不会逐毫秒空转。
+ * 注意: 不是线程安全的，只能在一个线程里使用 (服务器每个工作线程一个)；纯逻辑头文件，不依赖 Qt。
+ */
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstdint>
+#include <chrono>
+#include <vector>
+
+using namespace std;
+
+class TimerWheel {
+public:
+    typedef uint64_t Id;              // 定时器编号：高 32 位为代数，低 32 位为节点下标 + 1；0 表示无效
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 8;
+    static const int SLOTS = 1 << SLOT_BITS;
+
+    // 单调时钟 (毫秒)，不受系统改时间影响
+    static uint64_t clockMs() {
+        return (uint64_t)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    explicit TimerWheel(uint64_t nowMs = clockMs()) : current(nowMs) {
+        for(auto& level : heads) for(auto& h : level) h = NIL;
+        for(auto& level : occupied) for(auto& w : level) w = 0;
+    }
+
+    uint64_t now() const { return current; }
+    size_t size() const { return live; }
+
+    // 在 deadlineMs 时刻 (与 clockMs 同一时间轴) 触发，payload 原样交给回调；已经过去的时刻在下一毫秒触发
+    Id arm(uint64_t deadlineMs, uint64_t payload) {
+        uint32_t i;
+        if(!freeList.empty()) { i = freeList.back(); freeList.pop_back(); }
+        else { i = nodes.size(); nodes.push_back(Node()); }
+        Node& n = nodes[i];
+        n.deadline = deadlineMs;
+        n.payload = payload;
+        n.armed = true;
+        insert(i);
+        live++;
+        return (Id)n.gen << 32 | (i + 1);
+    }
+
+    // 取消定时器；已经触发或已经取消的返回 false
+    bool cancel(Id id) {
+        uint32_t i = (uint32_t)id - 1;
+        if(id == 0 || i >= nodes.size() || nodes[i].gen != (uint32_t)(id >> 32) || !nodes[i].armed) return false;
+        unlink(i);
+        release(i);
+        return true;
+    }
+
+    // 把时钟推进到 nowMs，按时间顺序对每个到期的定时器调用 fire(payload)，返回触发的个数。
+    // 回调里可以放心地设置、取消定时器
+    template <class Fire>
+    size_t advance(uint64_t nowMs, Fire fire) {
+        size_t fired = 0;
+        while(current < nowMs) {
+            uint64_t t = current + 1;
+            if((t & (SLOTS - 1)) == 0) cascade(t);
+            int s = nextOccupied(0, (int)(t & (SLOTS - 1)));
+            uint64_t target = s < 0 ? (t | (SLOTS - 1)) : (t & ~(uint64_t)(SLOTS - 1)) + s; // 跳过空槽
+            if(target > nowMs) { current = nowMs; break; }
+            current = target;
+            if(s >= 0) fired += fireSlot(s, fire);
+        }
+        return fired;
+    }
+
+    // 距离下一次需要调用 advance 还有多少毫秒 (给 poll 当超时用)；没有定时器时返回 -1。
+    // 第 0 层本圈内有定时器时是精确值，否则是到本圈结束 (下一次级联) 的时间
+    int64_t nextTimeoutMs() const {
+        if(live == 0) return -1;
+        uint64_t t = current + 1;
+        if((t & (SLOTS - 1)) == 0) return 1; // 下一毫秒就要级联，上层的定时器可能马上到期
+        int s = nextOccupied(0, (int)(t & (SLOTS - 1)));
+        uint64_t target = s < 0 ? (t | (SLOTS - 1)) + 1 : (t & ~(uint64_t)(SLOTS - 1)) + s;
+        return (int64_t)(target - current);
+    }
+
+private:
+    static const uint32_t NIL = 0xFFFFFFFFu;
+    static const uint64_t MAX_DELAY = ((uint64_t)1 << (SLOT_BITS * LEVELS)) - 1;
+    static const uint16_t FIRING = 0xFFFF; // where 取这个值表示在正在触发的链表里
+
+    struct Node {
+        uint64_t deadline = 0, payload = 0;
+        uint32_t prev = NIL, next = NIL;
+        uint32_t gen = 0;          // 每次释放加一，旧编号的 cancel 不会误伤复用了同一节点的新定时器
+        uint16_t where = 0;        // 所在的 层 * SLOTS + 槽
+        bool armed = false;
+    };
+
+    uint64_t current;              // 已经处理到的时刻 (毫秒)
+    size_t live = 0;
+    vector<Node> nodes;
+    vector<uint32_t> freeList;
+    uint32_t heads[LEVELS][SLOTS];
+    uint64_t occupied[LEVELS][SLOTS / 64];
+    uint32_t firing = NIL;         // 正在触发的槽，回调里取消其中还没触发的定时器时从这里摘
+
+    // 按离下一个要处理的时刻 (current + 1) 多远选层：相差不到 256^(k+1) 毫秒的放第 k 层，
+    // 槽号取截止时刻在该层的那几位；超出范围的放在最远处，到时再重新分配
+    void insert(uint32_t i) {
+        Node& n = nodes[i];
+        uint64_t base = current + 1;
+        uint64_t d = n.deadline < base ? base : n.deadline;
+        if(d - base > MAX_DELAY) d = base + MAX_DELAY;
+        int level = 0;
+        while(level < LEVELS - 1 && d - base >= (uint64_t)1 << (SLOT_BITS * (level + 1))) level++;
+        int slot = (int)(d >> (SLOT_BITS * level) & (SLOTS - 1));
+        n.where = (uint16_t)(level * SLOTS + slot);
+        n.prev = NIL;
+        n.next = heads[level][slot];
+        if(n.next != NIL) nodes[n.next].prev = i;
+        heads[level][slot] = i;
+        occupied[level][slot / 64] |= (uint64_t)1 << (slot % 64);
+    }
+
+    void unlink(uint32_t i) {
+        Node& n = nodes[i];
+        if(n.where == FIRING) {
+            if(n.prev != NIL) nodes[n.prev].next = n.next;
+            else firing = n.next;
+            if(n.next != NIL) nodes[n.next].prev = n.prev;
+            return;
+        }
+        int level = n.where / SLOTS, slot = n.where % SLOTS;
+        if(n.prev != NIL) nodes[n.prev].next = n.next;
+        else heads[level][slot] = n.next;
+        if(n.next != NIL) nodes[n.next].prev = n.prev;
+        if(heads[level][slot] == NIL) occupied[level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+    }
+
+    void release(uint32_t i) {
+        nodes[i].armed = false;
+        nodes[i].gen++;
+        freeList.push_back(i);
+        live--;
+    }
+
+    // 取下整个槽的链表
+    uint32_t detach(int level, int slot) {
+        uint32_t head = heads[level][slot];
+        heads[level][slot] = NIL;
+        occupied[level][slot / 64] &= ~((uint64_t)1 << (slot % 64));
+        return head;
+    }
+
+    // 时刻 t 是第 0 层新一圈的开始：从高层往低层，把 t 所在的槽里的定时器按 t 重新分配
+    // (此时 current = t - 1，重新分配后它们都落在更低的层)
+    void cascade(uint64_t t) {
+        for(int level=LEVELS-1; level>=1; --level) {
+            if(t & (((uint64_t)1 << (SLOT_BITS * level)) - 1)) continue; // t 不是这一层一个槽的起点
+            for(uint32_t i = detach(level, (int)(t >> (SLOT_BITS * level) & (SLOTS - 1))); i != NIL; ) {
+                uint32_t next = nodes[i].next;
+                insert(i);
+                i = next;
+            }
+        }
+    }
+
+    template <class Fire>
+    size_t fireSlot(int slot, Fire& fire) {
+        size_t fired = 0;
+        firing = detach(0, slot);
+        for(uint32_t i = firing; i != NIL; i = nodes[i].next) nodes[i].where = FIRING;
+        while(firing != NIL) {
+            uint32_t i = firing;
+            firing = nodes[i].next;
+            if(firing != NIL) nodes[firing].prev = NIL;
+            uint64_t payload = nodes[i].payload;
+            release(i);
+            fire(payload);
+            fired++;
+        }
+        return fired;
+    }
+
+    // 第 level 层从 from 起第一个非空槽，没有返回 -1
+    int nextOccupied(int level, int from) const {
+        for(int w = from / 64; w < SLOTS / 64; ++w) {
+            uint64_t bits = occupied[level][w];
+            if(w == from / 64) bits &= ~(uint64_t)0 << (from % 64);
+            if(bits) return w * 64 + lowestBit(bits);
+        }
+        return -1;
+    }
+
+    // 最低的 1 位的位置 (de Bruijn 序列查表，不依赖编译器内建函数)
+    static int lowestBit(uint64_t x) {
+        static const int TABLE[64] = {
+             0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+            62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+            63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+            46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+        };
+        return TABLE[((x & (0 - x)) * 0x03F79D71B4CB0A89ull) >> 58];
+    }
+};
+
+#endif
@@ -0,0 +1,282 @@
+/**
+ * 文件名: tournament.cpp
+ * 描述: 阵容循环赛 - 英雄名单中所有 3 人阵容两两对战 (默认 15 个英雄 455 套阵容，约 10 万对)，
+ *       每对打 N 局 (双方轮流先手)，输出阵容排名和每个英雄对阵容的贡献。
+ *       以阵容为行分配工作：第 a 行是阵容 a 对所有编号比它大的阵容，各行工作量不同，用工作窃取调度 (work_stealing.h)。
+ *       每对阵容用由 (种子, a, b) 决定的随机数打，结果与线程数、调度顺序无关，中断后续跑的结果和一口气跑完完全一样。
+ * 检查点: 定期把已完成的行写入检查点文件；再次运行时参数 (英雄名单、N、种子、策略) 一致就跳过这些行。
+ * 用法: tournament [每对局数=100] [线程数=CPU核心数] [--seed 种子=1] [--solver] [--top 行数=20]
+ *                  [--checkpoint 文件=tournament.ckpt] [--csv 文件]
+ *       --solver: 电脑一方按博弈求解器的均衡策略出招 (默认加权随机，快得多)；每对阵容轮流坐电脑的位置
+ *       --csv:    把全部阵容的排名写成 CSV
+ */
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include "battle_engine.h"
+#include "matchup_table.h"
+#include "work_stealing.h"
+
+const uint32_t CHECKPOINT_VERSION = 2; // 版本 2: 随机数改为 GameRng，结果与版本 1 不可混用
+
+struct CheckpointHeader {
+    char magic[4];          // "KOPT"
+    uint32_t version;       // CHECKPOINT_VERSION
+    uint64_t rosterHash;
+    uint32_t seed;
+    uint32_t matchesPerPair;
+    uint32_t lineupCount;
+    uint32_t solver;
+};
+
+// 循环赛的全部结果：wins[a * L + b] / draws[a * L + b] 为阵容 a 对阵容 b (a < b) 的胜局、平局数
+// 每一行只由处理它的那个线程写，写完才置 rowDone，检查点只读已完成的行
+struct Results {
+    int L;
+    vector<uint32_t> wins, draws;
+    unique_ptr<atomic<bool>[]> rowDone;
+
+    explicit Results(int lineups) : L(lineups), wins((size_t)lineups * lineups), draws((size_t)lineups * lineups),
+                                    rowDone(new atomic<bool>[lineups]) {
+        for(int a=0; a<L; ++a) rowDone[a] = false;
+    }
+
+    // 检查点：[文件头][每行是否完成 x L][已完成行的 wins x L, draws x L ...]，先写临时文件再替换
+    bool save(const string& path, const CheckpointHeader& h) const {
+        string tmp = path + ".tmp";
+        FILE* f = fopen(tmp.c_str(), "wb");
+        if(!f) return false;
+        vector<uint8_t> done(L);
+        for(int a=0; a<L; ++a) done[a] = rowDone[a].load(memory_order_acquire);
+        bool ok = fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(done.data(), 1, L, f) == (size_t)L;
+        for(int a=0; a<L && ok; ++a) {
+            if(!done[a]) continue;
+            ok = fwrite(&wins[(size_t)a * L], sizeof(uint32_t), L, f) == (size_t)L
+              && fwrite(&draws[(size_t)a * L], sizeof(uint32_t), L, f) == (size_t)L;
+        }
+        ok = fflush(f) == 0 && syncFile(f) && ok;
+        ok = fclose(f) == 0 && ok;
+        return ok && replaceFile(tmp, path);
+    }
+
+    // 读检查点，参数不一致或文件损坏返回 -1，否则返回恢复的行数
+    int load(const string& path, const CheckpointHeader& expect) {
+        FILE* f = fopen(path.c_str(), "rb");
+        if(!f) return 0;
+        CheckpointHeader h;
+        vector<uint8_t> done(L);
+        bool ok = fread(&h, sizeof(h), 1, f) == 1 && memcmp(&h, &expect, sizeof(h)) == 0
+                  && fread(done.data(), 1, L, f) == (size_t)L;
+        int restored = 0;
+        for(int a=0; a<L && ok; ++a) {
+            if(!done[a]) continue;
+            ok = fread(&wins[(size_t)a * L], sizeof(uint32_t), L, f) == (size_t)L
+              && fread(&draws[(size_t)a * L], sizeof(uint32_t), L, f) == (size_t)L;
+            if(ok) { rowDone[a] = true; restored++; }
+        }
+        fclose(f);
+        if(!ok) {
+            for(int a=0; a<L; ++a) rowDone[a] = false;
+            return -1;
+        }
+        return restored;
+    }
+};
+
+// 每个工作线程自己的对战引擎、求解器和计数，互不共享
+struct alignas(64) TournamentWorker {
+    unique_ptr<BattleEngine> engine;
+    GameSolver solver;
+    atomic<long long> games{0}; // 进度显示用
+};
+
+int main(int argc, char* argv[]) {
+    vector<string> args;
+    uint32_t seed = 1;
+    bool useSolver = false;
+    int top = 20;
+    string checkpoint = "tournament.ckpt", csvPath;
+    for(int i=1; i<argc; ++i) {
+        string a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if(a == "--seed" && hasValue) seed = (uint32_t)atoll(argv[++i]);
+        else if(a == "--solver") useSolver = true;
+        else if(a == "--top" && hasValue) top = atoi(argv[++i]);
+        else if(a == "--checkpoint" && hasValue) checkpoint = argv[++i];
+        else if(a == "--csv" && hasValue) csvPath = argv[++i];
+        else args.push_back(a);
+    }
+    int perPair = args.size() > 0 ? max(1, atoi(args[0].c_str())) : 100;
+    int threads = args.size() > 1 ? atoi(args[1].c_str()) : (int)thread::hardware_concurrency();
+    if(threads <= 0) threads = 1;
+
+    vector<Hero> roster = DataManager::loadHeroRoster();
+    int H = roster.size();
+    if(!MatchupTable::supports(H)) {
+        cerr << "英雄名单有 " << H << " 个英雄，阵容太多，不适合循环赛" << endl;
+        return 1;
+    }
+    int L = MatchupTable::lineupCount(H);
+    if(L < 2) { // 只有一套阵容时没有对手，得分和英雄贡献都无从算起
+        cerr << "英雄名单只有 " << H << " 个英雄，凑不出两套阵容，不能打循环赛" << endl;
+        return 1;
+    }
+    vector<vector<int>> lineups(L);
+    for(int id=0; id<L; ++id) lineups[id] = MatchupTable::lineupHeroes(id);
+
+    CheckpointHeader header = {};
+    memcpy(header.magic, "KOPT", 4);
+    header.version = CHECKPOINT_VERSION;
+    header.rosterHash = MatchupTable::rosterHash(roster);
+    header.seed = seed;
+    header.matchesPerPair = perPair;
+    header.lineupCount = L;
+    header.solver = useSolver;
+
+    Results results(L);
+    int restored = results.load(checkpoint, header);
+    if(restored < 0) cerr << "检查点 " << checkpoint << " 与本次参数不一致或已损坏，从头开始" << endl;
+    else if(restored > 0) cerr << "从检查点恢复: 已完成 " << restored << " / " << L << " 行" << endl;
+
+    vector<int> pending;
+    long long totalGames = 0, doneGames = 0;
+    for(int a=0; a<L; ++a) {
+        long long g = (long long)(L - 1 - a) * perPair;
+        totalGames += g;
+        if(results.rowDone[a]) doneGames += g;
+        else pending.push_back(a);
+    }
+    cerr << H << " 个英雄, " << L << " 套阵容, " << (long long)L * (L - 1) / 2 << " 对 x " << perPair << " 局, "
+         << threads << " 个线程" << (useSolver ? ", 电脑按均衡策略" : ", 加权随机") << endl;
+
+    HeroStats roundStats(H);
+    vector<unique_ptr<TournamentWorker>> workers;
+    for(int t=0; t<threads; ++t) {
+        workers.emplace_back(new TournamentWorker);
+        TournamentWorker& w = *workers.back();
+        w.engine.reset(new BattleEngine(roster));
+        w.engine->stats = roundStats.addShard(); // 多线程共用英雄表，回合统计写各自的分片
+        w.engine->solver = useSolver ? &w.solver : nullptr;
+    }
+
+    // 监视线程：每秒刷新进度，每 10 秒写一次检查点
+    mutex monitorMtx;
+    condition_variable monitorCv;
+    bool finished = false;
+    auto t0 = chrono::steady_clock::now();
+    thread monitor([&] {
+        unique_lock<mutex> lk(monitorMtx);
+        int ticks = 0;
+        while(!monitorCv.wait_for(lk, chrono::seconds(1), [&]{ return finished; })) {
+            long long played = 0;
+            for(auto& w : workers) played += w->games.load(memory_order_relaxed);
+            double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+            double rate = played / secs;
+            long long left = totalGames - doneGames - played;
+            cerr << fixed << setprecision(1) << "\r进度 " << 100.0 * (doneGames + played) / totalGames << "%, "
+                 << setprecision(0) << rate << " 局/秒, 预计还需 " << (rate > 0 ? left / rate : 0) << " 秒   " << flush;
+            if(++ticks % 10 == 0 && !checkpoint.empty()) results.save(checkpoint, header);
+        }
+    });
+
+    parallelForStealing(threads, pending.size(), [&](int self, uint32_t i) {
+        TournamentWorker& w = *workers[self];
+        BattleEngine& e = *w.engine;
+        int a = pending[i];
+        for(int b=a+1; b<L; ++b) {
+            e.rng.seed(seed, (uint64_t)a << 32 | b); // 每对阵容一条流，与由哪个线程、什么时候打无关
+            uint32_t win = 0, draw = 0;
+            for(int g=0; g<perPair; ++g) {
+                // 双方轮流坐“我方”位置，抵消先后手的差别
+                int r = g % 2 == 0 ? e.playAutoGame(lineups[a], lineups[b]) : -e.playAutoGame(lineups[b], lineups[a]);
+                win += r > 0;
+                draw += r == 0;
+                if(useSolver) w.solver.table.clear(); // 求解器的置换表按局清理，控制内存
+            }
+            results.wins[(size_t)a * L + b] = win;
+            results.draws[(size_t)a * L + b] = draw;
+            w.games.fetch_add(perPair, memory_order_relaxed);
+        }
+        results.rowDone[a].store(true, memory_order_release);
+    });
+
+    {
+        lock_guard<mutex> lk(monitorMtx);
+        finished = true;
+    }
+    monitorCv.notify_one();
+    monitor.join();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    long long played = totalGames - doneGames;
+    cerr << fixed << setprecision(2) << "\r完成: 本次打了 " << played << " 局, 耗时 " << secs << " 秒 ("
+         << setprecision(0) << (secs > 0 ? played / secs : 0.0) << " 局/秒)          " << endl;
+    if(!checkpoint.empty()) results.save(checkpoint, header);
+
+    // 汇总每套阵容的胜、平、负 (b 一方的结果由 a 一方推出)
+    vector<long long> W(L, 0), D(L, 0), Lo(L, 0);
+    for(int a=0; a<L; ++a) {
+        for(int b=a+1; b<L; ++b) {
+            long long w = results.wins[(size_t)a * L + b], d = results.draws[(size_t)a * L + b], l = perPair - w - d;
+            W[a] += w; D[a] += d; Lo[a] += l;
+            W[b] += l; D[b] += d; Lo[b] += w;
+        }
+    }
+    long long gamesPerLineup = (long long)(L - 1) * perPair;
+    vector<double> score(L);
+    for(int a=0; a<L; ++a) score[a] = (W[a] + 0.5 * D[a]) / gamesPerLineup;
+    vector<int> order(L);
+    for(int a=0; a<L; ++a) order[a] = a;
+    sort(order.begin(), order.end(), [&](int x, int y) { return score[x] > score[y]; });
+
+    auto names = [&](int id) {
+        string s;
+        for(int h : lineups[id]) s += (s.empty() ? "" : " ") + roster[h].name;
+        return s;
+    };
+    cout << "\n名次\t得分\t胜\t平\t负\t阵容" << endl;
+    cout << fixed << setprecision(2);
+    for(int r=0; r<min(top, L); ++r) {
+        int id = order[r];
+        cout << r + 1 << "\t" << 100 * score[id] << "%\t" << W[id] << "\t" << D[id] << "\t" << Lo[id] << "\t" << names(id) << endl;
+    }
+
+    // 英雄贡献：含该英雄的阵容平均得分 - 不含该英雄的阵容平均得分
+    vector<double> with(H, 0), without(H, 0);
+    vector<int> nWith(H, 0);
+    double all = 0;
+    for(int a=0; a<L; ++a) {
+        all += score[a];
+        for(int h : lineups[a]) { with[h] += score[a]; nWith[h]++; }
+    }
+    vector<double> contribution(H);
+    for(int h=0; h<H; ++h) {
+        double avgWith = with[h] / nWith[h];
+        double avgWithout = (all - with[h]) / (L - nWith[h]);
+        contribution[h] = avgWith - avgWithout;
+        without[h] = avgWithout;
+        with[h] = avgWith;
+    }
+    vector<int> heroOrder(H);
+    for(int h=0; h<H; ++h) heroOrder[h] = h;
+    sort(heroOrder.begin(), heroOrder.end(), [&](int x, int y) { return contribution[x] > contribution[y]; });
+    cout << "\n英雄\t贡献\t含该英雄\t不含该英雄\t(阵容平均得分)" << endl;
+    for(int h : heroOrder) {
+        cout << roster[h].name << "\t" << showpos << 100 * contribution[h] << noshowpos << "%\t"
+             << 100 * with[h] << "%\t\t" << 100 * without[h] << "%" << endl;
+    }
+
+    if(!csvPath.empty()) {
+        ofstream csv(csvPath);
+        csv << "rank,lineup,score,wins,draws,losses\n" << fixed << setprecision(4);
+        for(int r=0; r<L; ++r) {
+            int id = order[r];
+            csv << r + 1 << "," << names(id) << "," << score[id] << "," << W[id] << "," << D[id] << "," << Lo[id] << "\n";
+        }
+        cerr << "完整排名已写入 " << csvPath << endl;
+    }
+    return 0;
+}
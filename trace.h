@@ -0,0 +1,317 @@
+/**
+ * 文件名: trace.h
+ * 描述: 性能追踪 - 在热点函数里放 TRACE_SCOPE("名字") 记录一段耗时，TRACE_COUNTER("名字", 值) 记录一个计数，
+ *       结果可以导出成 Chrome / Perfetto 的 JSON 追踪文件 (chrome://tracing 或 ui.perfetto.dev 打开)，
+ *       同时按名字汇总耗时直方图，定期打印摘要 (次数、平均、p50/p90/p99、最大)。
+ * 开关: 默认关闭。Trace::start(路径) 之后才开始记录；关闭时每个埋点只是一次原子读和一次分支。
+ * 结构: 每个线程第一次记录时分到一个自己的环形缓冲区 (只有本线程写，不加锁)，满了覆盖最旧的事件；
+ *       每个埋点位置 (TraceSite) 有一份 2 的幂分桶的耗时直方图，跨线程用 relaxed 原子加累计。
+ *       导出在任意线程进行：先复制缓冲区，再丢掉复制期间可能被覆盖的那一段，不会读到写了一半的事件。
+ * 注意: 名字必须是字符串字面量 (只保存指针)。纯逻辑头文件，不依赖 Qt。
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+#include <iostream>
+#include "mapped_file.h"
+
+using namespace std;
+
+// 一个埋点位置：名字 + 耗时直方图 (计数器只记最近一次的值)
+class TraceSite {
+public:
+    static const int BUCKETS = 40; // 第 i 桶: 耗时 < 2^i 纳秒
+
+    const char* name;
+    bool counter;
+    atomic<uint64_t> count{0}, totalNs{0}, maxNs{0};
+    atomic<int64_t> lastValue{0};
+    atomic<uint64_t> buckets[BUCKETS] = {};
+
+    TraceSite(const char* n, bool isCounter = false);
+
+    void addDuration(uint64_t ns) {
+        int b = 0;
+        while(b < BUCKETS - 1 && (ns >> b) != 0) b++;
+        buckets[b].fetch_add(1, memory_order_relaxed);
+        count.fetch_add(1, memory_order_relaxed);
+        totalNs.fetch_add(ns, memory_order_relaxed);
+        uint64_t m = maxNs.load(memory_order_relaxed);
+        while(ns > m && !maxNs.compare_exchange_weak(m, ns, memory_order_relaxed)) {}
+    }
+
+    // 百分位 (纳秒，取所在桶的上界，但不超过最大值)
+    uint64_t percentile(double q) const {
+        uint64_t n = count.load(memory_order_relaxed), seen = 0, top = maxNs.load(memory_order_relaxed);
+        if(n == 0) return 0;
+        for(int b=0; b<BUCKETS; ++b) {
+            seen += buckets[b].load(memory_order_relaxed);
+            if(seen >= q * n) return b == 0 ? 0 : min<uint64_t>(1ull << b, top);
+        }
+        return top;
+    }
+};
+
+// ==========================================
+// 类: Trace (追踪器，全局唯一)
+// 描述: start 打开记录并启动摘要线程；stop 写出追踪文件。都可以在任意线程调用
+// ==========================================
+class Trace {
+public:
+    struct Event {
+        const char* name;
+        uint64_t start;  // 纳秒，从 start() 起算
+        uint64_t dur;    // 耗时 (纳秒)；计数器事件为 0
+        int64_t value;   // 计数器的值
+        bool counter;
+    };
+
+    static const size_t RING_SIZE = 1 << 16; // 每个线程保留最近的这么多个事件
+
+    static bool on() { return instance().enabled.load(memory_order_relaxed); }
+
+    // 开始记录：path 为追踪文件 (stop 时写出，摘要线程每次打印摘要时也会写一次)，
+    // summarySec > 0 时每隔这么多秒往 cerr 打印一次摘要
+    static void start(const string& path, int summarySec = 10) {
+        Trace& t = instance();
+        lock_guard<mutex> lk(t.mtx);
+        if(t.enabled) return;
+        t.path = path;
+        t.origin = chrono::steady_clock::now();
+        t.stopping = false;
+        t.enabled = true;
+        if(summarySec > 0) t.reporter = thread(&Trace::reportLoop, &t, summarySec);
+    }
+
+    // 停止记录，打印最后一次摘要并写出追踪文件 (程序退出前调用)
+    static void stop() {
+        Trace& t = instance();
+        {
+            lock_guard<mutex> lk(t.mtx);
+            if(!t.enabled) return;
+            t.enabled = false;
+        }
+        t.stopReporter();
+        cerr << summary();
+        t.writeChromeJson(t.path);
+    }
+
+    // 给当前线程起个名字，显示在追踪文件里 (在 start 之后调用才有效，关闭时不分配缓冲区)
+    static void nameThread(const char* name) { if(on()) instance().ring().name = name; }
+
+    static uint64_t now() {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - instance().origin).count();
+    }
+
+    // 记录一段已经结束的耗时 (跨越多次事件循环的过程用它，例如切换页面到重绘完成)
+    static void span(TraceSite& site, uint64_t startNs, uint64_t endNs) {
+        uint64_t dur = endNs > startNs ? endNs - startNs : 0;
+        site.addDuration(dur);
+        instance().ring().push({ site.name, startNs, dur, 0, false });
+    }
+
+    static void counter(TraceSite& site, int64_t value) {
+        site.lastValue.store(value, memory_order_relaxed);
+        site.count.fetch_add(1, memory_order_relaxed);
+        instance().ring().push({ site.name, now(), 0, value, true });
+    }
+
+    // 按名字汇总的摘要文本
+    static string summary() {
+        Trace& t = instance();
+        vector<TraceSite*> sites;
+        {
+            lock_guard<mutex> lk(t.mtx);
+            sites = t.sites;
+        }
+        ostringstream out;
+        out << fixed << setprecision(1);
+        out << "--- 追踪摘要 (微秒) ---\n";
+        for(TraceSite* s : sites) {
+            uint64_t n = s->count.load(memory_order_relaxed);
+            if(n == 0) continue;
+            if(s->counter) {
+                out << s->name << ": 最近值 " << s->lastValue.load(memory_order_relaxed) << " (" << n << " 次)\n";
+                continue;
+            }
+            out << s->name << ": " << n << " 次, 平均 " << s->totalNs.load(memory_order_relaxed) / 1000.0 / n
+                << ", p50 " << s->percentile(0.5) / 1000.0 << ", p90 " << s->percentile(0.9) / 1000.0
+                << ", p99 " << s->percentile(0.99) / 1000.0 << ", 最大 " << s->maxNs.load(memory_order_relaxed) / 1000.0 << "\n";
+        }
+        return out.str();
+    }
+
+    // 把所有线程缓冲区中的事件写成 Chrome 追踪格式 (JSON)
+    bool writeChromeJson(const string& file) {
+        if(file.empty()) return false;
+        vector<Ring*> list;
+        {
+            lock_guard<mutex> lk(mtx);
+            for(auto& r : rings) list.push_back(r.get());
+        }
+        string tmp = file + ".tmp";
+        FILE* f = fopen(tmp.c_str(), "wb");
+        if(!f) return false;
+        fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        bool first = true;
+        for(Ring* r : list) {
+            if(r->name) {
+                fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                        first ? "" : ",\n", r->tid, escape(r->name).c_str());
+                first = false;
+            }
+            for(const Event& e : r->copy()) {
+                if(e.counter) {
+                    fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%lld}}",
+                            first ? "" : ",\n", escape(e.name).c_str(), e.start / 1000.0, r->tid, (long long)e.value);
+                } else {
+                    fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                            first ? "" : ",\n", escape(e.name).c_str(), e.start / 1000.0, e.dur / 1000.0, r->tid);
+                }
+                first = false;
+            }
+        }
+        fprintf(f, "\n]}\n");
+        bool ok = fclose(f) == 0;
+        return ok && replaceFile(tmp, file);
+    }
+
+    static Trace& instance() {
+        static Trace t;
+        return t;
+    }
+
+    void addSite(TraceSite* s) {
+        lock_guard<mutex> lk(mtx);
+        sites.push_back(s);
+    }
+
+private:
+    // 单个线程的环形缓冲区：只有所属线程写 head 和事件，导出线程只读
+    struct Ring {
+        vector<Event> events = vector<Event>(RING_SIZE);
+        atomic<uint64_t> head{0}; // 已写入的事件总数
+        int tid = 0;
+        const char* name = nullptr;
+
+        void push(const Event& e) {
+            uint64_t h = head.load(memory_order_relaxed);
+            events[h % RING_SIZE] = e;
+            head.store(h + 1, memory_order_release);
+        }
+
+        // 复制出仍然有效的事件：复制完再看一次 head (与顺序锁相同的做法)，复制期间可能被覆盖的最旧一段丢掉。
+        // 再看 head 时写线程可能正在写第 after 个事件，它占的槽就是第 after - RING_SIZE 个的，所以那一个也不要
+        vector<Event> copy() const {
+            uint64_t end = head.load(memory_order_acquire);
+            uint64_t begin = end > RING_SIZE ? end - RING_SIZE : 0;
+            vector<Event> out;
+            out.reserve(end - begin);
+            for(uint64_t i=begin; i<end; ++i) out.push_back(events[i % RING_SIZE]);
+            atomic_thread_fence(memory_order_acquire); // 上面对事件的读不能挪到下面再读 head 之后
+            uint64_t after = head.load(memory_order_relaxed);
+            uint64_t overwritten = after + 1 > RING_SIZE ? after + 1 - RING_SIZE : 0;
+            if(overwritten > begin) out.erase(out.begin(), out.begin() + min<uint64_t>(overwritten - begin, out.size()));
+            return out;
+        }
+    };
+
+    atomic<bool> enabled{false};
+    chrono::steady_clock::time_point origin = chrono::steady_clock::now();
+    string path;
+    mutex mtx;                          // 保护 rings / sites 列表和启停状态
+    vector<unique_ptr<Ring>> rings;     // 线程退出后缓冲区仍然保留，导出时还能读到
+    vector<TraceSite*> sites;
+    thread reporter;
+    condition_variable cv;
+    bool stopping = false;
+
+    Trace() = default;
+    ~Trace() { stopReporter(); } // 埋点位置此时可能已经析构，不再打印摘要
+
+    void stopReporter() {
+        {
+            lock_guard<mutex> lk(mtx);
+            stopping = true;
+        }
+        cv.notify_one();
+        if(reporter.joinable()) reporter.join();
+    }
+
+    Ring& ring() {
+        thread_local Ring* mine = nullptr;
+        if(!mine) {
+            lock_guard<mutex> lk(mtx);
+            rings.emplace_back(new Ring);
+            mine = rings.back().get();
+            mine->tid = (int)rings.size();
+        }
+        return *mine;
+    }
+
+    void reportLoop(int sec) {
+        unique_lock<mutex> lk(mtx);
+        while(!cv.wait_for(lk, chrono::seconds(sec), [this]{ return stopping; })) {
+            lk.unlock();
+            cerr << summary();
+            writeChromeJson(path);
+            lk.lock();
+        }
+    }
+
+    static string escape(const char* s) {
+        string out;
+        for(; *s; ++s) {
+            if(*s == '"' || *s == '\\') out += '\\';
+            out += *s;
+        }
+        return out;
+    }
+};
+
+inline TraceSite::TraceSite(const char* n, bool isCounter) : name(n), counter(isCounter) {
+    Trace::instance().addSite(this);
+}
+
+// 作用域耗时：构造时记下开始时间，析构时记一段耗时 (追踪关闭时什么都不做)
+class TraceSpan {
+public:
+    explicit TraceSpan(TraceSite& s) : site(s), startNs(Trace::on() ? Trace::now() : NOT_TRACING) {}
+    ~TraceSpan() { if(startNs != NOT_TRACING) Trace::span(site, startNs, Trace::now()); }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    static const uint64_t NOT_TRACING = ~0ull;
+    TraceSite& site;
+    uint64_t startNs;
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+
+// 记录当前作用域的耗时
+#define TRACE_SCOPE(name) \
+    static TraceSite TRACE_CONCAT(traceSite_, __LINE__)(name); \
+    TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(TRACE_CONCAT(traceSite_, __LINE__))
+
+// 记录一个计数 (例如队列长度、缓冲字节数)
+#define TRACE_COUNTER(name, value) \
+    do { \
+        static TraceSite traceCounterSite_(name, true); \
+        if(Trace::on()) Trace::counter(traceCounterSite_, (int64_t)(value)); \
+    } while(0)
+
+#endif // TRACE_H
@@ -0,0 +1,92 @@
+/**
+ * 文件名: win_odds.h
+ * 描述: 出招胜率 - 对战中给玩家的每种招算出“现在出这一招，最终赢下这局的概率”，显示在出招按钮上。
+ * 模型: 电脑每回合按博弈求解器的均衡混合策略出招 (服务器和本地对战里电脑默认的策略)，玩家之后每回合都选胜率最高的招。
+ *       这样电脑的行为是已知的随机策略，对玩家来说就是一个马尔可夫决策过程，按双方剩余库存、回合、分差做动态规划：
+ *         出招 m 的胜率 = Σ_c 电脑出 c 的概率 × 结算后局面的胜率
+ *         局面的胜率   = max_m 出招 m 的胜率，终局时我方得分高为 1，否则为 0 (平局不算赢)
+ *       玩家只看总库存、不看电脑派出的英雄时，这就是准确的胜率。但电脑是先抽招再在有这一招的英雄里选人，
+ *       出招前亮出的英雄透露了本回合的招 (本地对战里电脑摸清玩家习惯后改按出招模型出招，也是这样选人)，
+ *       所以界面把以英雄为条件的本回合分布 (BattleEngine::revealedCpuMix) 代进上式。之后各回合仍按不看英雄的
+ *       均衡策略算 (模型的分布也事先算不出来)，而玩家到时还会看到英雄、可以出得更好，所以这时的结果是
+ *       按这种打法能达到的胜率，真正的最优胜率不低于它；界面上标成“约”。
+ * 增量: 结果按局面编码记在置换表里，跨回合、跨对局复用。算第一回合时已经展开了之后所有可能的局面，
+ *       所以此后每回合只是一次查表；界面每回合结束后刷新按钮，不会卡一帧。
+ * 注意: 纯逻辑头文件，不依赖 Qt；求解器与电脑共用 (同一线程)，均衡策略也只算一遍。
+ */
+#ifndef WIN_ODDS_H
+#define WIN_ODDS_H
+
+#include "game_solver.h"
+
+class WinOdds {
+public:
+    explicit WinOdds(GameSolver& s) : solver(s) {}
+
+    // 局面 s (电脑本回合的招还没扣掉) 下我方出每种招的胜率，没有库存的招为 -1
+    void moveOdds(const MatchState& s, double odds[3]) {
+        if(GameSolver::isTerminal(s)) {
+            for(int m=SCISSORS; m<=PAPER; ++m) odds[m] = -1;
+            return;
+        }
+        const SolveResult& r = expand(s);
+        for(int m=SCISSORS; m<=PAPER; ++m) odds[m] = s.my[m] > 0 ? r.myStrategy[m] : -1;
+    }
+
+    // 同上，但电脑本回合按已知分布 cpuMix 出招 (以派出的英雄为条件，或按模型出招)，之后各回合按均衡策略估计；
+    // 结果是近似值，不进置换表
+    void moveOdds(const MatchState& s, const double cpuMix[3], double odds[3]) {
+        for(int m=SCISSORS; m<=PAPER; ++m) {
+            odds[m] = GameSolver::isTerminal(s) || s.my[m] == 0 ? -1 : moveValue(s, m, cpuMix);
+        }
+    }
+
+    // 局面 s 的胜率 (之后每回合都按最优出招)
+    double winProbability(const MatchState& s) {
+        if(GameSolver::isTerminal(s)) return s.scoreDiff > 0 ? 1.0 : 0.0;
+        return expand(s).value;
+    }
+
+    size_t size() const { return table.size(); }
+
+    // 内存控制：表只是缓存，随时可以清空
+    void clear() { table.clear(); }
+
+private:
+    GameSolver& solver;
+    // 复用求解器的置换表结构：value 存局面的胜率，myStrategy[m] 存本回合出 m 的胜率 (cpuStrategy 不用)
+    TranspositionTable table;
+
+    SolveResult expand(const MatchState& s) {
+        uint64_t key = s.encode();
+        if(const SolveResult* cached = table.find(key)) return *cached;
+
+        SolveResult eq = solver.solve(s);
+        SolveResult r = {};
+        for(int m=SCISSORS; m<=PAPER; ++m) {
+            if(s.my[m] == 0) continue;
+            r.myStrategy[m] = moveValue(s, m, eq.cpuStrategy);
+            r.value = max(r.value, r.myStrategy[m]);
+        }
+        table.insert(key, r);
+        return r;
+    }
+
+    // 本回合我方出 m、电脑按分布 cpu 出招时的胜率
+    double moveValue(const MatchState& s, int m, const double cpu[3]) {
+        double p = 0;
+        for(int c=SCISSORS; c<=PAPER; ++c) {
+            if(cpu[c] <= 0) continue;
+            MatchState next = s;
+            next.my[m]--;
+            next.cpu[c]--;
+            next.round++;
+            int res = ClassicRules::outcome(m, c); // 与引擎相同的胜负判定
+            next.scoreDiff += (res == OUTCOME_WIN) - (res == OUTCOME_LOSS);
+            p += cpu[c] * winProbability(next);
+        }
+        return p;
+    }
+};
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * 文件名: work_stealing.h
+ * 描述: 工作窃取调度 - 把 [0, n) 个互相独立的工作项分给多个线程，每项耗时可以相差很大。
+ * 结构: 每个线程一个 Chase-Lev 双端队列，存放待处理的区间。线程从自己队列的底部取区间，
+ *       区间不止一项就对半切开，后一半压回自己的队列，继续切前一半，直到剩一项再处理；
+ *       自己的队列空了就随机挑一个线程，从它队列的顶部偷走一个区间 (顶部总是最大的区间，一次偷到的活最多)。
+ *       取和偷都不加锁：取只在与小偷争最后一个区间时用一次 CAS，偷用一次 CAS。
+ * 注意: 纯逻辑头文件，不依赖 Qt。
+ */
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// ==========================================
+// 类: StealingDeque (Chase-Lev 双端队列，定长)
+// 描述: 只有所属线程调用 push / pop (底部)，其他线程调用 steal (顶部)。
+//       区间 [lo, hi) 打包成一个 64 位整数存放，槽位本身也是原子的，偷的一方不会读到写了一半的值。
+// 注意: 每次切分都把区间减半，一个队列里同时存在的区间不超过 log2(n) + 1 个，定长 64 足够
+// ==========================================
+class alignas(64) StealingDeque {
+public:
+    static const int CAPACITY = 64;
+
+    void push(uint64_t x) {
+        int64_t b = bottom.load(memory_order_relaxed);
+        items[b & (CAPACITY - 1)].store(x, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        bottom.store(b + 1, memory_order_relaxed);
+    }
+
+    bool pop(uint64_t& x) {
+        int64_t b = bottom.load(memory_order_relaxed) - 1;
+        bottom.store(b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t t = top.load(memory_order_relaxed);
+        if(t > b) { // 空
+            bottom.store(b + 1, memory_order_relaxed);
+            return false;
+        }
+        x = items[b & (CAPACITY - 1)].load(memory_order_relaxed);
+        if(t == b) { // 最后一个：和小偷抢
+            bool won = top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+            bottom.store(b + 1, memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    bool steal(uint64_t& x) {
+        int64_t t = top.load(memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        int64_t b = bottom.load(memory_order_acquire);
+        if(t >= b) return false;
+        x = items[t & (CAPACITY - 1)].load(memory_order_relaxed);
+        return top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+    }
+
+private:
+    atomic<int64_t> top{0}, bottom{0};
+    atomic<uint64_t> items[CAPACITY] = {};
+};
+
+// ==========================================
+// 函数: parallelForStealing
+// 描述: 用 threads 个线程处理 [0, n) 的每一项，body(worker, i) 在第 worker 个线程上处理第 i 项
+//       (worker 从 0 起，可以用来索引每个线程自己的随机数引擎、结果缓冲区)。
+//       开始时每个线程分到连续的一段，之后靠窃取平衡负载；全部处理完才返回。
+// ==========================================
+template <class Body>
+void parallelForStealing(int threads, uint32_t n, Body body) {
+    if(n == 0) return;
+    if(threads < 1) threads = 1;
+    unique_ptr<StealingDeque[]> deques(new StealingDeque[threads]);
+    auto pack = [](uint32_t lo, uint32_t hi) { return (uint64_t)lo << 32 | hi; };
+    for(int t=0; t<threads; ++t) {
+        uint32_t lo = (uint64_t)n * t / threads, hi = (uint64_t)n * (t + 1) / threads;
+        if(lo < hi) deques[t].push(pack(lo, hi));
+    }
+    atomic<uint32_t> remaining(n);
+
+    auto worker = [&](int self) {
+        minstd_rand pickVictim(self + 1);
+        uint64_t range;
+        while(remaining.load(memory_order_acquire) > 0) {
+            bool got = deques[self].pop(range);
+            for(int tries=0; !got && tries<threads * 2; ++tries) {
+                int victim = pickVictim() % threads;
+                if(victim != self) got = deques[victim].steal(range);
+            }
+            if(!got) { this_thread::yield(); continue; }
+            uint32_t lo = (uint32_t)(range >> 32), hi = (uint32_t)range;
+            while(hi - lo > 1) { // 后一半留给自己稍后处理 (或者被别人偷走)
+                uint32_t mid = lo + (hi - lo) / 2;
+                deques[self].push(pack(mid, hi));
+                hi = mid;
+            }
+            body(self, lo);
+            remaining.fetch_sub(1, memory_order_release);
+        }
+    };
+    vector<thread> pool;
+    for(int t=1; t<threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for(auto& th : pool) th.join();
+}
+
+#endif // WORK_STEALING_H